@@ -74,6 +74,7 @@ namespace Evernus
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
         auto assets = populate(query.record());
+        query.finish();
 
         query = mItemRepository.prepare(QString{"SELECT * FROM %1 WHERE asset_list_id = ?"}.arg(mItemRepository.getTableName()));
         query.bindValue(0, assets->getId());
@@ -537,41 +537,45 @@ namespace Evernus
     void BasicStatisticsWidget::updateTransactionData()
     {
         const auto combineStats = mCombineStatsBtn->isChecked();
-        const auto entries = (combineStats) ?
-                             (mTransactionRepository.fetchInRange(QDateTime{mTransactionPlot->getFrom()},
-                                                                  QDateTime{mTransactionPlot->getTo().addDays(1)},
-                                                                  WalletTransactionRepository::EntryType::All)) :
-                             (mTransactionRepository.fetchForCharacterInRange(mCharacterId,
-                                                                              QDateTime{mTransactionPlot->getFrom()},
-                                                                              QDateTime{mTransactionPlot->getTo().addDays(1)},
-                                                                              WalletTransactionRepository::EntryType::All));
 
         auto totalIncome = 0., totalOutcome = 0.;
 
+        // transactions are streamed, since there can be a lot of them for long ranges
         QHash<QDate, std::pair<double, double>> values;
-        const auto valueAdder = [&values, &totalIncome, &totalOutcome](const auto &entries) {
-            for (const auto &entry : entries)
-            {
-                if (entry->isIgnored())
-                    continue;
+        const auto valueAdder = [&values, &totalIncome, &totalOutcome](const WalletTransaction &entry) {
+            if (entry.isIgnored())
+                return;
 
-                auto &value = values[entry->getTimestamp().toLocalTime().date()];
+            auto &value = values[entry.getTimestamp().toLocalTime().date()];
 
-                const auto amount = entry->getPrice() * entry->getQuantity();
-                if (entry->getType() == Evernus::WalletTransaction::Type::Buy)
-                {
-                    totalOutcome += amount;
-                    value.first += amount;
-                }
-                else
-                {
-                    totalIncome += amount;
-                    value.second += amount;
-                }
+            const auto amount = entry.getPrice() * entry.getQuantity();
+            if (entry.getType() == Evernus::WalletTransaction::Type::Buy)
+            {
+                totalOutcome += amount;
+                value.first += amount;
+            }
+            else
+            {
+                totalIncome += amount;
+                value.second += amount;
             }
         };
 
-        valueAdder(entries);
+        if (combineStats)
+        {
+            mTransactionRepository.forEachInRange(QDateTime{mTransactionPlot->getFrom()},
+                                                  QDateTime{mTransactionPlot->getTo().addDays(1)},
+                                                  WalletTransactionRepository::EntryType::All,
+                                                  valueAdder);
+        }
+        else
+        {
+            mTransactionRepository.forEachForCharacterInRange(mCharacterId,
+                                                              QDateTime{mTransactionPlot->getFrom()},
+                                                              QDateTime{mTransactionPlot->getTo().addDays(1)},
+                                                              WalletTransactionRepository::EntryType::All,
+                                                              valueAdder);
+        }
 
         QSettings settings;
         if (settings.value(StatisticsSettings::combineCorpAndCharPlotsKey, StatisticsSettings::combineCorpAndCharPlotsDefault).toBool())
@@ -579,16 +583,21 @@ namespace Evernus
             try
             {
                 const auto corpId = mCharacterRepository.getCorporationId(mCharacterId);
-                const auto entries = (combineStats) ?
-                                     (mCorpTransactionRepository.fetchInRange(QDateTime{mJournalPlot->getFrom()},
-                                                                              QDateTime{mJournalPlot->getTo().addDays(1)},
-                                                                              WalletTransactionRepository::EntryType::All)) :
-                                     (mCorpTransactionRepository.fetchForCorporationInRange(corpId,
-                                                                                            QDateTime{mJournalPlot->getFrom()},
-                                                                                            QDateTime{mJournalPlot->getTo().addDays(1)},
-                                                                                            WalletTransactionRepository::EntryType::All));
-
-                valueAdder(entries);
+                if (combineStats)
+                {
+                    mCorpTransactionRepository.forEachInRange(QDateTime{mJournalPlot->getFrom()},
+                                                              QDateTime{mJournalPlot->getTo().addDays(1)},
+                                                              WalletTransactionRepository::EntryType::All,
+                                                              valueAdder);
+                }
+                else
+                {
+                    mCorpTransactionRepository.forEachForCorporationInRange(corpId,
+                                                                            QDateTime{mJournalPlot->getFrom()},
+                                                                            QDateTime{mJournalPlot->getTo().addDays(1)},
+                                                                            WalletTransactionRepository::EntryType::All,
+                                                                            valueAdder);
+                }
             }
             catch (const CharacterRepository::NotFoundException &)
             {
@@ -0,0 +1,50 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/functional/hash.hpp>
+
+#include "JumpDistanceMatrix.h"
+
+#include "BuyOrderReachIndex.h"
+
+namespace Evernus
+{
+    const BuyOrderReachIndex::OrderIndexList BuyOrderReachIndex::emptyList;
+
+    BuyOrderReachIndex::BuyOrderReachIndex(const ExternalOrderBook::Side &orders, const JumpDistanceMatrix &distances)
+    {
+        // many orders share a source system and range - look up covered systems once for each
+        std::unordered_map<std::pair<uint, uint>, std::vector<uint>, boost::hash<std::pair<uint, uint>>> coveredSystems;
+
+        // going by price keeps every list sorted
+        for (auto i = 0u; i < orders.size(); ++i)
+        {
+            const auto solarSystemId = orders.mSolarSystemIds[i];
+            const uint range = (orders.mRanges[i] < 0) ? (0) : (orders.mRanges[i]);
+
+            auto it = coveredSystems.find(std::make_pair(solarSystemId, range));
+            if (it == std::end(coveredSystems))
+                it = coveredSystems.emplace(std::make_pair(solarSystemId, range), distances.getSystemsInRange(solarSystemId, range)).first;
+
+            for (const auto system : it->second)
+                mReach[system].emplace_back(i);
+        }
+    }
+
+    const BuyOrderReachIndex::OrderIndexList &BuyOrderReachIndex::getOrders(uint solarSystemId) const
+    {
+        const auto it = mReach.find(solarSystemId);
+        return (it != std::end(mReach)) ? (it->second) : (emptyList);
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "ExternalOrderBook.h"
+
+namespace Evernus
+{
+    class JumpDistanceMatrix;
+
+    // for each solar system, buy orders which can reach it with their own range
+    class BuyOrderReachIndex final
+    {
+    public:
+        // indices into ExternalOrderBook::Side, so by price descending
+        using OrderIndexList = std::vector<uint>;
+
+        BuyOrderReachIndex(const ExternalOrderBook::Side &orders, const JumpDistanceMatrix &distances);
+        BuyOrderReachIndex(const BuyOrderReachIndex &) = default;
+        BuyOrderReachIndex(BuyOrderReachIndex &&) = default;
+        ~BuyOrderReachIndex() = default;
+
+        // station range orders are included for their whole solar system
+        const OrderIndexList &getOrders(uint solarSystemId) const;
+
+        BuyOrderReachIndex &operator =(const BuyOrderReachIndex &) = default;
+        BuyOrderReachIndex &operator =(BuyOrderReachIndex &&) = default;
+
+    private:
+        static const OrderIndexList emptyList;
+
+        std::unordered_map<uint, OrderIndexList> mReach;
+    };
+}
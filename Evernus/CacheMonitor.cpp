@@ -0,0 +1,98 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <mutex>
+
+#include "CacheMonitor.h"
+
+namespace Evernus::CacheMonitor
+{
+    namespace
+    {
+        struct Registration
+        {
+            MonitoredCache *mCache;
+            uint mWeight;
+        };
+
+        std::mutex registryMutex;
+        std::vector<Registration> registry;
+        std::size_t totalBudget = 0;
+
+        // registry mutex must be held
+        void distributeBudget()
+        {
+            quint64 totalWeight = 0;
+            for (const auto &registration : registry)
+                totalWeight += registration.mWeight;
+
+            for (const auto &registration : registry)
+            {
+                registration.mCache->setBudget(
+                    (totalBudget == 0 || totalWeight == 0 || registration.mWeight == 0) ?
+                    (0) :
+                    (std::max<std::size_t>(totalBudget * registration.mWeight / totalWeight, 1)));
+            }
+        }
+    }
+
+    void registerCache(MonitoredCache &cache, uint weight)
+    {
+        std::lock_guard<std::mutex> lock{registryMutex};
+
+        registry.emplace_back(Registration{&cache, weight});
+        distributeBudget();
+    }
+
+    void unregisterCache(MonitoredCache &cache)
+    {
+        std::lock_guard<std::mutex> lock{registryMutex};
+
+        registry.erase(std::remove_if(std::begin(registry), std::end(registry), [&](const auto &registration) {
+            return registration.mCache == &cache;
+        }), std::end(registry));
+
+        distributeBudget();
+    }
+
+    void setTotalBudget(std::size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock{registryMutex};
+
+        totalBudget = bytes;
+        distributeBudget();
+    }
+
+    std::vector<CacheStats> getStats()
+    {
+        std::lock_guard<std::mutex> lock{registryMutex};
+
+        std::vector<CacheStats> result;
+        result.reserve(registry.size());
+
+        for (const auto &registration : registry)
+            result.emplace_back(registration.mCache->getStats());
+
+        return result;
+    }
+
+    void resetStats()
+    {
+        std::lock_guard<std::mutex> lock{registryMutex};
+
+        for (const auto &registration : registry)
+            registration.mCache->resetStats();
+    }
+}
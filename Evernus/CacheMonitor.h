@@ -0,0 +1,57 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+#include <QString>
+
+namespace Evernus::CacheMonitor
+{
+    struct CacheStats
+    {
+        QString mName;
+        quint64 mEntries = 0;
+        quint64 mBytes = 0;
+        quint64 mBudget = 0;
+        quint64 mHits = 0;
+        quint64 mMisses = 0;
+        quint64 mEvictions = 0;
+    };
+
+    // implemented by caches which should be listed in diagnostics and share the memory budget
+    class MonitoredCache
+    {
+    public:
+        virtual ~MonitoredCache() = default;
+
+        virtual CacheStats getStats() const = 0;
+        virtual void resetStats() = 0;
+
+        // 0 - unbounded
+        virtual void setBudget(std::size_t bytes) = 0;
+    };
+
+    // caches get a share of the total budget proportional to their weight
+    // weight 0 - only listed in stats, always unbounded
+    void registerCache(MonitoredCache &cache, uint weight);
+    void unregisterCache(MonitoredCache &cache);
+
+    // 0 - unbounded
+    void setTotalBudget(std::size_t bytes);
+
+    std::vector<CacheStats> getStats();
+    void resetStats();
+}
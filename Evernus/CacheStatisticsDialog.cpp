@@ -0,0 +1,119 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QDialogButtonBox>
+#include <QTableWidgetItem>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QPushButton>
+#include <QLabel>
+
+#include "CacheMonitor.h"
+
+#include "CacheStatisticsDialog.h"
+
+namespace Evernus
+{
+    CacheStatisticsDialog::CacheStatisticsDialog(QWidget *parent)
+        : QDialog{parent}
+    {
+        auto mainLayout = new QVBoxLayout{this};
+
+        mTotalLabel = new QLabel{this};
+        mainLayout->addWidget(mTotalLabel);
+
+        mStatsView = new QTableWidget{this};
+        mainLayout->addWidget(mStatsView, 1);
+        mStatsView->setColumnCount(8);
+        mStatsView->setHorizontalHeaderLabels({
+            tr("Cache"), tr("Entries"), tr("Memory [KiB]"), tr("Limit [KiB]"), tr("Hits"), tr("Misses"), tr("Hit rate [%]"), tr("Evictions")
+        });
+        mStatsView->setSelectionMode(QAbstractItemView::SingleSelection);
+        mStatsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+        mStatsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        mStatsView->setWordWrap(false);
+        mStatsView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+        auto buttons = new QDialogButtonBox{QDialogButtonBox::Close, this};
+        mainLayout->addWidget(buttons);
+        connect(buttons, &QDialogButtonBox::rejected, this, &CacheStatisticsDialog::reject);
+
+        auto refreshBtn = buttons->addButton(tr("Refresh"), QDialogButtonBox::ActionRole);
+        connect(refreshBtn, &QPushButton::clicked, this, &CacheStatisticsDialog::refresh);
+
+        auto resetBtn = buttons->addButton(tr("Reset"), QDialogButtonBox::ResetRole);
+        connect(resetBtn, &QPushButton::clicked, this, &CacheStatisticsDialog::reset);
+
+        setWindowTitle(tr("Cache statistics"));
+        resize(800, 500);
+
+        refresh();
+    }
+
+    void CacheStatisticsDialog::refresh()
+    {
+        const auto stats = CacheMonitor::getStats();
+
+        mStatsView->setSortingEnabled(false);
+        mStatsView->clearContents();
+        mStatsView->setRowCount(static_cast<int>(stats.size()));
+
+        const auto setNumber = [=](int row, int column, auto value) {
+            auto item = new QTableWidgetItem{};
+            item->setData(Qt::DisplayRole, value);
+            mStatsView->setItem(row, column, item);
+        };
+
+        quint64 totalBytes = 0, totalBudget = 0;
+
+        auto row = 0;
+        for (const auto &cache : stats)
+        {
+            mStatsView->setItem(row, 0, new QTableWidgetItem{cache.mName});
+
+            const auto lookups = cache.mHits + cache.mMisses;
+
+            setNumber(row, 1, cache.mEntries);
+            setNumber(row, 2, cache.mBytes / 1024);
+            setNumber(row, 4, cache.mHits);
+            setNumber(row, 5, cache.mMisses);
+            setNumber(row, 6, (lookups == 0) ? (0.) : (100. * cache.mHits / lookups));
+            setNumber(row, 7, cache.mEvictions);
+
+            if (cache.mBudget == 0)
+                mStatsView->setItem(row, 3, new QTableWidgetItem{tr("unlimited")});
+            else
+                setNumber(row, 3, cache.mBudget / 1024);
+
+            totalBytes += cache.mBytes;
+            totalBudget += cache.mBudget;
+
+            ++row;
+        }
+
+        mStatsView->setSortingEnabled(true);
+        mStatsView->sortByColumn(2, Qt::DescendingOrder);
+
+        mTotalLabel->setText((totalBudget == 0) ?
+                             (tr("Total memory: %1 KiB, unlimited").arg(totalBytes / 1024)) :
+                             (tr("Total memory: %1 KiB of %2 KiB").arg(totalBytes / 1024).arg(totalBudget / 1024)));
+    }
+
+    void CacheStatisticsDialog::reset()
+    {
+        CacheMonitor::resetStats();
+        refresh();
+    }
+}
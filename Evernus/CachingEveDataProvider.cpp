@@ -12,11 +12,13 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <queue>
+
+#include <boost/throw_exception.hpp>
 
 #include <QtDebug>
 
 #include <QStandardPaths>
+#include <QtConcurrent>
 #include <QSqlDatabase>
 #include <QDataStream>
 #include <QSqlQuery>
@@ -34,11 +36,14 @@
 namespace Evernus
 {
     const QString CachingEveDataProvider::nameCacheFileName = "generic_names";
+    const QString CachingEveDataProvider::nameJournalFileName = "generic_name_journal";
     const QString CachingEveDataProvider::raceCacheFileName = "race_names";
     const QString CachingEveDataProvider::bloodlineCacheFileName = "bloodline_names";
    
 
     const QString CachingEveDataProvider::systemDistanceCacheFileName = "system_distances";
+    const QString CachingEveDataProvider::jumpDistanceCacheFileName = "jump_distances";
+    const QString CachingEveDataProvider::staticDataCacheFileName = "static_data";
 
     const QStringList CachingEveDataProvider::oreGroupNames = {
         QStringLiteral("Veldspar"),
@@ -80,23 +85,73 @@ namespace Evernus
         , mCitadelRepository{citadelRepository}
         , mDataManagerProvider{dataManagerProvider}
         , mConnectionProvider{connectionProvider}
-    {
-        readCache(nameCacheFileName, mGenericNameCache);
+        , mTypeMetaGroupCache{QStringLiteral("Type meta groups")}
+        , mTypeCache{QStringLiteral("Types"), 4}
+        , mStationSellPrices{QStringLiteral("Station sell prices"), 4}
+        , mRegionSellPrices{QStringLiteral("Region sell prices"), 4}
+        , mBuyPrices{QStringLiteral("Buy prices"), 4}
+        , mOrderBookMonitor{QStringLiteral("Order book")}
+        , mLocationNameCache{QStringLiteral("Location names"), 2}
+        , mTypeMarketGroupParentCache{QStringLiteral("Market group parents")}
+        , mTypeMarketGroupCache{QStringLiteral("Market groups")}
+        , mNameResolver{dataManagerProvider, getCacheDir().filePath(nameJournalFileName)}
+        , mSolarSystemRegionCache{QStringLiteral("Solar system regions")}
+        , mSolarSystemConstellationCache{QStringLiteral("Solar system constellations")}
+        , mLocationSolarSystemCache{QStringLiteral("Location solar systems")}
+        , mSecurityStatuses{QStringLiteral("Security statuses")}
+        , mRegionNameCache{QStringLiteral("Region names")}
+        , mSolarSystemNameCache{QStringLiteral("Solar system names")}
+        , mStationRegionCache{QStringLiteral("Station regions")}
+        , mBlueprintOutputCache{QStringLiteral("Blueprint outputs")}
+    {
+        getCacheDir().mkpath(QStringLiteral("."));
+
+        // names used to be written in one go on exit - move them to the journal
+        NameMap legacyNames;
+        readCache(nameCacheFileName, legacyNames);
+
+        if (!legacyNames.isEmpty())
+        {
+            // failed lookups deserve another try
+            auto name = std::begin(legacyNames);
+            while (name != std::end(legacyNames))
+            {
+                if (name.value() == tr("(unknown)"))
+                    name = legacyNames.erase(name);
+                else
+                    ++name;
+            }
+
+            mNameResolver.writeCache(legacyNames);
+            QFile::remove(getCacheDir().filePath(nameCacheFileName));
+        }
+
+        mGenericNameCache = mNameResolver.readCache();
+
+        mOrderBookLoader.setMaxThreadCount(1);
+
         findManufaturingActivity();
         handleNewPreferences();
 
         connect(this, &CachingEveDataProvider::genericNameRequested, this, &CachingEveDataProvider::fetchGenericName);
+        connect(&mNameResolver, &GenericNameResolver::namesResolved, this, &CachingEveDataProvider::updateGenericNames);
+        connect(&mNameResolver, &GenericNameResolver::namesFailed, this, &CachingEveDataProvider::setUnknownGenericNames);
     }
 
     CachingEveDataProvider::~CachingEveDataProvider()
     {
+        {
+            std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+            discardPendingOrderBook();
+        }
+
+        mOrderBookLoader.waitForDone();
+
         try
         {
             const auto dataCacheDir = getCacheDir();
             if (dataCacheDir.mkpath(QStringLiteral(".")))
             {
-                cacheWrite(nameCacheFileName, mGenericNameCache);
-                cacheWrite(systemDistanceCacheFileName, mSystemDistances);
                 cacheWrite(raceCacheFileName, mRaceNameCache);
                 cacheWrite(bloodlineCacheFileName, mBloodlineNameCache);
                 
@@ -135,6 +190,8 @@ namespace Evernus
 
     const std::unordered_map<EveType::IdType, QString> &CachingEveDataProvider::getAllTradeableTypeNames() const
     {
+        std::lock_guard<std::mutex> lock{mTypeInfoCacheMutex};
+
         if (!mTradeableTypeNameCache.empty())
             return mTradeableTypeNameCache;
 
@@ -144,6 +201,8 @@ namespace Evernus
 
     const CachingEveDataProvider::TypeList &CachingEveDataProvider::getAllTradeableTypeIds() const
     {
+        std::lock_guard<std::mutex> lock{mTypeInfoCacheMutex};
+
         if (!mTradeableTypeCache.empty())
             return mTradeableTypeCache;
 
@@ -153,6 +212,8 @@ namespace Evernus
 
     const CachingEveDataProvider::TypeList &CachingEveDataProvider::getCitadelTypeIds() const
     {
+        std::lock_guard<std::mutex> lock{mTypeInfoCacheMutex};
+
         if (!mCitadelTypeCache.empty())
             return mCitadelTypeCache;
 
@@ -162,23 +223,20 @@ namespace Evernus
 
     QString CachingEveDataProvider::getTypeMetaGroupName(EveType::IdType id) const
     {
-        const auto it = mTypeMetaGroupCache.find(id);
-        if (it != std::end(mTypeMetaGroupCache))
-            return it->second->getName();
-
-        MetaGroupRepository::EntityPtr result;
+        const auto type = mStaticData.findType(id);
+        if (type != nullptr)
+            return mStaticData.getString(type->mMetaGroupName);
 
-        try
-        {
-            result = mMetaGroupRepository.fetchForType(id);
-        }
-        catch (const MetaGroupRepository::NotFoundException &)
-        {
-            result = std::make_shared<MetaGroup>();
-        }
-
-        mTypeMetaGroupCache.emplace(id, result);
-        return result->getName();
+        return mTypeMetaGroupCache.get(id, [=]() -> MetaGroupRepository::EntityPtr {
+            try
+            {
+                return mMetaGroupRepository.fetchForType(id);
+            }
+            catch (const MetaGroupRepository::NotFoundException &)
+            {
+                return std::make_shared<MetaGroup>();
+            }
+        })->getName();
     }
 
     QString CachingEveDataProvider::getGenericName(quint64 id) const
@@ -210,25 +268,8 @@ namespace Evernus
 
     double CachingEveDataProvider::getTypeVolume(EveType::IdType id) const
     {
-        std::lock_guard<std::mutex> lock{mTypeCacheMutex};
-
-        const auto it = mTypeCache.find(id);
-        if (it != std::end(mTypeCache))
-            return (mUsePackagedVolume) ? (getPackagedVolume(*it->second)) : (it->second->getVolume());
-
-        EveTypeRepository::EntityPtr result;
-
-        try
-        {
-            result = mEveTypeRepository.find(id);
-        }
-        catch (const EveTypeRepository::NotFoundException &)
-        {
-            result = std::make_shared<EveType>();
-        }
-
-        mTypeCache.emplace(id, result);
-        return (mUsePackagedVolume) ? (getPackagedVolume(*result)) : (result->getVolume());
+        const auto type = getEveType(id);
+        return (mUsePackagedVolume) ? (getPackagedVolume(*type)) : (type->getVolume());
     }
 
     std::shared_ptr<ExternalOrder> CachingEveDataProvider::getTypeStationSellPrice(EveType::IdType id, quint64 stationId) const
@@ -239,74 +280,94 @@ namespace Evernus
     std::shared_ptr<ExternalOrder> CachingEveDataProvider::getTypeRegionSellPrice(EveType::IdType id, uint regionId) const
     {
         const auto key = std::make_pair(id, regionId);
-        const auto it = mRegionSellPrices.find(key);
-        if (it != std::end(mRegionSellPrices))
-            return it->second;
 
         std::shared_ptr<ExternalOrder> result;
+        if (mRegionSellPrices.find(key, result))
+            return result;
 
-        try
+        // inserting under the lock ensures a concurrent update doesn't get overwritten with a stale price
+        std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+
+        const auto &orders = getOrderBook().getSellOrders(id, regionId);
+        for (auto i = 0u; i < orders.size(); ++i)
         {
-            result = mExternalOrderRepository.findSellByTypeAndRegion(id, regionId, mMarketOrderRepository, mCorpMarketOrderRepository);
+            if (!isOwnActiveOrder(orders.mIds[i]))
+            {
+                result = std::make_shared<ExternalOrder>(orders.getOrder(i));
+                break;
+            }
         }
-        catch (const ExternalOrderRepository::NotFoundException &)
-        {
+
+        if (!result)
             result = std::make_shared<ExternalOrder>();
-        }
 
-        mRegionSellPrices.emplace(key, result);
+        mRegionSellPrices.insert(key, result);
         return result;
     }
 
     std::shared_ptr<ExternalOrder> CachingEveDataProvider::getTypeBuyPrice(EveType::IdType id, quint64 stationId, int range) const
     {
-        std::lock_guard<std::recursive_mutex> lock{mExternalOrderCacheMutex};
-
         const auto key = std::make_pair(id, stationId);
-        const auto it = mBuyPrices.find(key);
-        if (it != std::end(mBuyPrices))
-            return it->second;
 
-        auto result = std::make_shared<ExternalOrder>();
-        mBuyPrices.emplace(key, result);
+        std::shared_ptr<ExternalOrder> result;
+        if (mBuyPrices.find(key, result))
+            return result;
+
+        std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+
+        result = std::make_shared<ExternalOrder>();
 
         const auto solarSystemId = getStationSolarSystemId(stationId);
-        if (solarSystemId == 0)
-            return result;
+        const auto regionId = (solarSystemId == 0) ? (0u) : (getSolarSystemRegionId(solarSystemId));
 
-        const auto regionId = getSolarSystemRegionId(solarSystemId);
         if (regionId == 0)
+        {
+            mBuyPrices.insert(key, result);
             return result;
+        }
 
-        const uint realRange = (range < 0) ? (0) : (range);
-        const auto &orders = getExternalOrders(id, regionId);
-        for (const auto &order : orders)
-        {
-            if (order->getPrice() <= result->getPrice())
-                continue;
+        const auto &orders = getOrderBook().getBuyOrders(id, regionId);
+        const auto setResult = [&](auto index) {
+            if (orders.mPrices[index] > result->getPrice())
+                result = std::make_shared<ExternalOrder>(orders.getOrder(index));
+        };
 
-            if (order->getRange() == -1)
+        // orders are sorted by price descending, so the first one in range is the best
+        if (range <= 0)
+        {
+            // our order doesn't extend the reach, so the index has exactly the candidates
+            for (const auto i : getBuyOrderReach(id, regionId).getOrders(solarSystemId))
             {
-                if (range == -1)
-                {
-                    if (order->getStationId() != stationId)
-                        continue;
-                }
-                else
-                {
-                    if (getDistance(solarSystemId, order->getSolarSystemId()) > realRange)
-                        continue;
-                }
+                if (isOwnActiveOrder(orders.mIds[i]))
+                    continue;
+                if (range == -1 && orders.mRanges[i] == -1 && orders.mStationIds[i] != stationId)
+                    continue;
+
+                setResult(i);
+                break;
             }
-            else if (getDistance(solarSystemId, order->getSolarSystemId()) > order->getRange() + realRange)
+        }
+        else
+        {
+            const uint realRange = range;
+
+            for (auto i = 0u; i < orders.size(); ++i)
             {
-                continue;
-            }
+                if (isOwnActiveOrder(orders.mIds[i]))
+                    continue;
+
+                const auto orderRange = orders.mRanges[i];
+                const auto distance = getDistance(solarSystemId, orders.mSolarSystemIds[i]);
 
-            result = order;
+                if ((orderRange == -1 && distance > realRange) || (orderRange != -1 && distance > orderRange + realRange))
+                    continue;
+
+                setResult(i);
+                break;
+            }
         }
 
-        mBuyPrices[key] = result;
+        mBuyPrices.insert(key, result);
         return result;
     }
 
@@ -321,31 +382,64 @@ namespace Evernus
             affectedOrders.emplace(std::make_pair(order.getTypeId(), order.getRegionId()));
         }
 
-        clearExternalOrderCaches();
-
         mExternalOrderRepository.removeObsolete(affectedOrders);
         mExternalOrderRepository.batchStore(toStore, true);
+
+        std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+
+        discardPendingOrderBook();
+
+        if (mOrderBookLoaded)
+        {
+            mOrderBook.replace(affectedOrders, orders);
+            mOrderBookMonitor.update(mOrderBook);
+        }
+
+        resetExternalOrderCaches(affectedOrders);
     }
 
     void CachingEveDataProvider::clearExternalOrders()
     {
-        clearExternalOrderCaches();
         mExternalOrderRepository.removeAll();
+
+        std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+
+        mOrderBook.clear();
+        mOrderBookMonitor.update(mOrderBook);
+        mOrderBookLoaded = true;
+
+        discardPendingOrderBook();
+
+        resetExternalOrderCaches();
     }
 
     void CachingEveDataProvider::clearExternalOrdersForType(EveType::IdType id)
     {
-        clearExternalOrderCaches();
         mExternalOrderRepository.removeForType(id);
+
+        std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+
+        mOrderBook.removeType(id);
+        mOrderBookMonitor.update(mOrderBook);
+
+        discardPendingOrderBook();
+
+        resetExternalOrderCaches();
     }
 
     QString CachingEveDataProvider::getLocationName(quint64 id) const
     {
-        const auto it = mLocationNameCache.find(id);
-        if (it != std::end(mLocationNameCache))
-            return it->second;
-
         QString result;
+        if (mLocationNameCache.find(id, result))
+            return result;
+
+        result = mStaticData.getLocationName(id);
+        if (!result.isEmpty())
+        {
+            mLocationNameCache.insert(id, result);
+            return result;
+        }
+
         if (id >= 66000000 && id <= 66014933)
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -384,45 +478,48 @@ namespace Evernus
                 result = tr("- unknown location -");
         }
 
-        mLocationNameCache.emplace(id, result);
+        mLocationNameCache.insert(id, result);
         return result;
     }
 
     QString CachingEveDataProvider::getRegionName(uint id) const
     {
-        const auto it = mRegionNameCache.find(id);
-        if (it != std::end(mRegionNameCache))
-            return it->second;
+        return mRegionNameCache.get(id, [=] {
+            const auto region = mStaticData.findRegion(id);
+            if (region != nullptr)
+                return mStaticData.getString(region->mName);
 
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT regionName FROM mapRegions WHERE regionID = ?"));
-        query.bindValue(0, id);
+            QSqlQuery query{mConnectionProvider.getConnection()};
+            query.prepare(QStringLiteral("SELECT regionName FROM mapRegions WHERE regionID = ?"));
+            query.bindValue(0, id);
 
-        DatabaseUtils::execQuery(query);
-        query.next();
+            DatabaseUtils::execQuery(query);
+            query.next();
 
-        return mRegionNameCache.emplace(id, query.value(0).toString()).first->second;
+            return query.value(0).toString();
+        });
     }
 
     QString CachingEveDataProvider::getSolarSystemName(uint id) const
     {
-        const auto it = mSolarSystemNameCache.find(id);
-        if (it != std::end(mSolarSystemNameCache))
-            return it->second;
-
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT solarSystemName FROM mapSolarSystems WHERE solarSystemID = ?"));
-        query.bindValue(0, id);
+        return mSolarSystemNameCache.get(id, [=] {
+            const auto solarSystem = mStaticData.findSolarSystem(id);
+            if (solarSystem != nullptr)
+                return mStaticData.getString(solarSystem->mName);
 
-        DatabaseUtils::execQuery(query);
-        if (!query.next())
-            return mSolarSystemNameCache.emplace(id, QString{}).first->second;
+            QSqlQuery query{mConnectionProvider.getConnection()};
+            query.prepare(QStringLiteral("SELECT solarSystemName FROM mapSolarSystems WHERE solarSystemID = ?"));
+            query.bindValue(0, id);
 
-        return mSolarSystemNameCache.emplace(id, query.value(0).toString()).first->second;
+            DatabaseUtils::execQuery(query);
+            return (query.next()) ? (query.value(0).toString()) : (QString{});
+        });
     }
 
     const std::vector<EveDataProvider::MapLocation> &CachingEveDataProvider::getRegions() const
     {
+        std::lock_guard<std::mutex> lock{mMapCacheMutex};
+
         if (mRegionCache.empty())
         {
             auto query = mConnectionProvider.getConnection().exec(QStringLiteral("SELECT regionID, regionName FROM mapRegions WHERE regionID <= 11000000 ORDER BY regionName"));
@@ -441,6 +538,8 @@ namespace Evernus
 
     const std::vector<EveDataProvider::MapLocation> &CachingEveDataProvider::getConstellations(uint regionId) const
     {
+        std::lock_guard<std::mutex> lock{mMapCacheMutex};
+
         if (mConstellationCache.find(regionId) == std::end(mConstellationCache))
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -464,6 +563,8 @@ namespace Evernus
 
     const std::vector<EveDataProvider::MapTreeLocation> &CachingEveDataProvider::getConstellations() const
     {
+        std::lock_guard<std::mutex> lock{mMapCacheMutex};
+
         if (BOOST_UNLIKELY(mAllConstellationsCache.empty()))
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -475,15 +576,19 @@ namespace Evernus
             if (size > 0)
                 mAllConstellationsCache.reserve(size);
 
-            mConstellationCache.clear();
+            std::unordered_map<uint, std::vector<MapLocation>> constellations;
 
             while (query.next())
             {
                 MapTreeLocation location{query.value(2).toUInt(), query.value(0).toUInt(), query.value(1).toString()};
 
                 mAllConstellationsCache.emplace_back(location);
-                mConstellationCache[location.mParent].emplace_back(std::make_pair(location.mId, location.mName));
+                constellations[location.mParent].emplace_back(std::make_pair(location.mId, location.mName));
             }
+
+            // existing lists might be referenced by other threads and have the same contents anyway
+            for (auto &regionConstellations : constellations)
+                mConstellationCache.emplace(regionConstellations.first, std::move(regionConstellations.second));
         }
 
         return mAllConstellationsCache;
@@ -491,6 +596,8 @@ namespace Evernus
 
     const std::vector<EveDataProvider::MapLocation> &CachingEveDataProvider::getSolarSystemsForConstellation(uint constellationId) const
     {
+        std::lock_guard<std::mutex> lock{mMapCacheMutex};
+
         if (mConstellationSolarSystemCache.find(constellationId) == std::end(mConstellationSolarSystemCache))
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -514,6 +621,8 @@ namespace Evernus
 
     const std::vector<EveDataProvider::MapLocation> &CachingEveDataProvider::getSolarSystemsForRegion(uint regionId) const
     {
+        std::lock_guard<std::mutex> lock{mMapCacheMutex};
+
         if (mRegionSolarSystemCache.find(regionId) == std::end(mRegionSolarSystemCache))
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -537,6 +646,8 @@ namespace Evernus
 
     const std::vector<EveDataProvider::MapTreeLocation> &CachingEveDataProvider::getSolarSystems() const
     {
+        std::lock_guard<std::mutex> lock{mMapCacheMutex};
+
         if (BOOST_UNLIKELY(mAllSolarSystemsCache.empty()))
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -548,15 +659,19 @@ namespace Evernus
             if (size > 0)
                 mAllSolarSystemsCache.reserve(size);
 
-            mConstellationSolarSystemCache.clear();
+            std::unordered_map<uint, std::vector<MapLocation>> systems;
 
             while (query.next())
             {
                 MapTreeLocation location{query.value(2).toUInt(), query.value(0).toUInt(), query.value(1).toString()};
 
                 mAllSolarSystemsCache.emplace_back(location);
-                mConstellationSolarSystemCache[location.mParent].emplace_back(std::make_pair(location.mId, location.mName));
+                systems[location.mParent].emplace_back(std::make_pair(location.mId, location.mName));
             }
+
+            // existing lists might be referenced by other threads and have the same contents anyway
+            for (auto &constellationSystems : systems)
+                mConstellationSolarSystemCache.emplace(constellationSystems.first, std::move(constellationSystems.second));
         }
 
         return mAllSolarSystemsCache;
@@ -564,6 +679,8 @@ namespace Evernus
 
     const std::vector<EveDataProvider::Station> &CachingEveDataProvider::getStations(uint solarSystemId) const
     {
+        std::lock_guard<std::mutex> lock{mMapCacheMutex};
+
         if (mStationCache.find(solarSystemId) == std::end(mStationCache))
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -599,49 +716,48 @@ namespace Evernus
 
     double CachingEveDataProvider::getSolarSystemSecurityStatus(uint solarSystemId) const
     {
-        const auto it = mSecurityStatuses.find(solarSystemId);
-        if (it != std::end(mSecurityStatuses))
-            return it->second;
-
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT security FROM mapSolarSystems WHERE solarSystemID = ?"));
-        query.bindValue(0, solarSystemId);
+        return mSecurityStatuses.get(solarSystemId, [=] {
+            const auto solarSystem = mStaticData.findSolarSystem(solarSystemId);
+            if (solarSystem != nullptr)
+                return solarSystem->mSecurity;
 
-        DatabaseUtils::execQuery(query);
-
-        if (!query.next())
-            return mSecurityStatuses.emplace(solarSystemId, 0.).first->second;
+            QSqlQuery query{mConnectionProvider.getConnection()};
+            query.prepare(QStringLiteral("SELECT security FROM mapSolarSystems WHERE solarSystemID = ?"));
+            query.bindValue(0, solarSystemId);
 
-        return mSecurityStatuses.emplace(solarSystemId, query.value(0).toDouble()).first->second;
+            DatabaseUtils::execQuery(query);
+            return (query.next()) ? (query.value(0).toDouble()) : (0.);
+        });
     }
 
     uint CachingEveDataProvider::getSolarSystemConstellationId(uint solarSystemId) const
     {
-        const auto it = mSolarSystemConstellationCache.find(solarSystemId);
-        if (it != std::end(mSolarSystemConstellationCache))
-            return it->second;
+        return mSolarSystemConstellationCache.get(solarSystemId, [=] {
+            const auto solarSystem = mStaticData.findSolarSystem(solarSystemId);
+            if (solarSystem != nullptr)
+                return solarSystem->mConstellationId;
 
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT constellationID FROM mapSolarSystems WHERE solarSystemID = ?"));
-        query.bindValue(0, solarSystemId);
-
-        DatabaseUtils::execQuery(query);
-        query.next();
+            QSqlQuery query{mConnectionProvider.getConnection()};
+            query.prepare(QStringLiteral("SELECT constellationID FROM mapSolarSystems WHERE solarSystemID = ?"));
+            query.bindValue(0, solarSystemId);
 
-        const auto constellationId = query.value(0).toUInt();
+            DatabaseUtils::execQuery(query);
+            query.next();
 
-        mSolarSystemConstellationCache.emplace(solarSystemId, constellationId);
-        return constellationId;
+            return query.value(0).toUInt();
+        });
     }
 
     uint CachingEveDataProvider::getStationRegionId(quint64 stationId) const
     {
-        const auto it = mStationRegionCache.find(stationId);
-        if (it != std::end(mStationRegionCache))
-            return it->second;
-
         uint result = 0;
-        if (stationId >= 66000000 && stationId <= 66014933)
+        if (mStationRegionCache.find(stationId, result))
+            return result;
+
+        const auto station = mStaticData.findStation(stationId);
+        if (station != nullptr)
+            result = station->mRegionId;
+        else if (stationId >= 66000000 && stationId <= 66014933)
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
             query.prepare(QStringLiteral("SELECT regionID FROM staStations WHERE stationID = ?"));
@@ -683,20 +799,20 @@ namespace Evernus
         if (result == 0)   // citadel?
             result = getCitadelRegionId(stationId);
 
-        mStationRegionCache.emplace(stationId, result);
+        mStationRegionCache.insert(stationId, result);
         return result;
     }
 
     uint CachingEveDataProvider::getStationSolarSystemId(quint64 stationId) const
     {
-        std::lock_guard<std::mutex> lock{mLocationSolarSystemCacheMutex};
-
-        const auto it = mLocationSolarSystemCache.find(stationId);
-        if (it != std::end(mLocationSolarSystemCache))
-            return it->second;
-
         uint systemId = 0;
-        if (stationId >= 66000000 && stationId <= 66014933)
+        if (mLocationSolarSystemCache.find(stationId, systemId))
+            return systemId;
+
+        const auto station = mStaticData.findStation(stationId);
+        if (station != nullptr)
+            systemId = station->mSolarSystemId;
+        else if (stationId >= 66000000 && stationId <= 66014933)
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
             query.prepare(QStringLiteral("SELECT solarSystemID FROM staStations WHERE stationID = ?"));
@@ -730,12 +846,14 @@ namespace Evernus
         if (systemId == 0)  // citadel?
             systemId = getCitadelSolarSystemId(stationId);
 
-        mLocationSolarSystemCache.emplace(stationId, systemId);
+        mLocationSolarSystemCache.insert(stationId, systemId);
         return systemId;
     }
 
     const CitadelRepository::EntityList CachingEveDataProvider::getCitadelsForRegion(uint regionId) const
     {
+        std::lock_guard<std::mutex> lock{mCitadelCacheMutex};
+
         const auto citadels = mRegionCitadelCache.find(regionId);
         if (citadels != std::end(mRegionCitadelCache))
             return citadels->second;
@@ -745,6 +863,8 @@ namespace Evernus
 
     const CitadelRepository::EntityList &CachingEveDataProvider::getCitadels() const
     {
+        std::lock_guard<std::mutex> lock{mCitadelCacheMutex};
+
         if (BOOST_UNLIKELY(mAllCitadelsCache.empty()))
         {
             mAllCitadelsCache = mCitadelRepository.fetchAll();
@@ -760,6 +880,8 @@ namespace Evernus
 
     const CachingEveDataProvider::ReprocessingMap &CachingEveDataProvider::getOreReprocessingInfo() const
     {
+        std::lock_guard<std::mutex> lock{mTypeInfoCacheMutex};
+
         if (mOreReprocessingInfo.empty())
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -790,6 +912,8 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
 
     const CachingEveDataProvider::ReprocessingMap &CachingEveDataProvider::getTypeReprocessingInfo(const TypeList &requestedTypes) const
     {
+        std::lock_guard<std::mutex> lock{mTypeInfoCacheMutex};
+
         auto reducedTypes = requestedTypes;
         for (const auto &info : mTypeReprocessingInfo)
             reducedTypes.erase(info.first);
@@ -828,6 +952,8 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
 
     uint CachingEveDataProvider::getGroupId(const QString &name) const
     {
+        std::lock_guard<std::mutex> lock{mTypeInfoCacheMutex};
+
         if (mGroupIdCache.contains(name))
             return mGroupIdCache[name];
 
@@ -849,6 +975,14 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
         return 0;
     }
 
+    void CachingEveDataProvider::precacheStaticData()
+    {
+        const auto dataCacheDir = getCacheDir();
+        dataCacheDir.mkpath(QStringLiteral("."));
+
+        mStaticData.load(dataCacheDir.filePath(staticDataCacheFileName), mConnectionProvider.getConnection());
+    }
+
     void CachingEveDataProvider::precacheNames()
     {
         readCache(raceCacheFileName, mRaceNameCache);
@@ -864,36 +998,102 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
 
     void CachingEveDataProvider::precacheJumpMap()
     {
-        auto query = mConnectionProvider.getConnection().exec(QStringLiteral("SELECT fromRegionID, fromSolarSystemID, toSolarSystemID FROM mapSolarSystemJumps WHERE fromRegionID = toRegionID"));
+        JumpDistanceMatrix::JumpMap jumpMap;
+        RouteFinder::JumpList jumps;
+
+        const auto db = mConnectionProvider.getConnection();
+
+        auto query = db.exec(QStringLiteral("SELECT fromRegionID, toRegionID, fromSolarSystemID, toSolarSystemID FROM mapSolarSystemJumps"));
         while (query.next())
-            mSystemJumpMap[query.value(0).toUInt()].emplace(query.value(1).toUInt(), query.value(2).toUInt());
+        {
+            const auto fromRegionId = query.value(0).toUInt();
+            const auto fromSystemId = query.value(2).toUInt();
+            const auto toSystemId = query.value(3).toUInt();
 
-        const auto dataCacheDir = getCacheDir();
+            if (fromRegionId == query.value(1).toUInt())
+                jumpMap[fromRegionId].emplace(fromSystemId, toSystemId);
+
+            jumps.emplace_back(fromSystemId, toSystemId);
+        }
 
-        QFile distanceCache{dataCacheDir.filePath(systemDistanceCacheFileName)};
-        if (distanceCache.open(QIODevice::ReadOnly))
+        RouteFinder::SecurityMap securityStatuses;
+
+        query = db.exec(QStringLiteral("SELECT solarSystemID, security FROM mapSolarSystems"));
+        while (query.next())
         {
-            QDataStream cacheStream{&distanceCache};
-            cacheStream >> mSystemDistances;
+            const auto solarSystemId = query.value(0).toUInt();
+            const auto security = query.value(1).toDouble();
+
+            securityStatuses.emplace(solarSystemId, security);
+            mSecurityStatuses.insert(solarSystemId, security);
         }
+
+        mRouteFinder.setGraph(jumps, securityStatuses);
+
+        const auto dataCacheDir = getCacheDir();
+        dataCacheDir.mkpath(QStringLiteral("."));
+
+        // superseded by the precomputed matrices
+        QFile::remove(dataCacheDir.filePath(systemDistanceCacheFileName));
+
+        mJumpDistances.load(dataCacheDir.filePath(jumpDistanceCacheFileName), jumpMap);
     }
 
     void CachingEveDataProvider::clearExternalOrderCaches()
     {
-        std::lock_guard<std::recursive_mutex> lock{mExternalOrderCacheMutex};
+        std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+        resetExternalOrderCaches();
+    }
 
-        mStationSellPrices.clear();
-        mBuyPrices.clear();
-        mTypeRegionOrderCache.clear();
+    void CachingEveDataProvider::reloadOrderBook()
+    {
+        std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+
+        mOrderBook.clear();
+        mOrderBookMonitor.update(mOrderBook);
+        mOrderBookLoaded = false;
+
+        resetExternalOrderCaches();
+        discardPendingOrderBook();
+
+        const auto discarded = std::make_shared<std::atomic_bool>(false);
+        mPendingOrderBookDiscarded = discarded;
+
+        // read without holding the lock, so lookups don't wait for the whole table
+        mPendingOrderBook = QtConcurrent::run(&mOrderBookLoader, [=] {
+            auto book = std::make_shared<ExternalOrderBook>();
+
+            try
+            {
+                mExternalOrderRepository.forEachChunk(4096, [&](const auto &orders) {
+                    if (!*discarded)
+                        book->add(orders);
+                });
+
+                if (*discarded)
+                    return std::shared_ptr<ExternalOrderBook>{};
+
+                book->sort();
+            }
+            catch (const std::exception &e)
+            {
+                qWarning() << "Error loading order book:" << e.what();
+                book.reset();
+            }
+
+            return book;
+        });
     }
 
     void CachingEveDataProvider::clearStationCache()
     {
+        std::lock_guard<std::mutex> lock{mMapCacheMutex};
         mStationCache.clear();
     }
 
     void CachingEveDataProvider::clearCitadelCache()
     {
+        std::lock_guard<std::mutex> lock{mCitadelCacheMutex};
         mCitadelCache.clear();
         mRegionCitadelCache.clear();
         mAllCitadelsCache.clear();
@@ -902,216 +1102,296 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
     void CachingEveDataProvider::handleNewPreferences()
     {
         QSettings settings;
-
-        std::lock_guard<std::mutex> lock{mTypeCacheMutex};
         mUsePackagedVolume = settings.value(UISettings::usePackagedVolumeKey, UISettings::usePackagedVolumeDefault).toBool();
     }
 
-    std::shared_ptr<ExternalOrder> CachingEveDataProvider::getTypeSellPrice(EveType::IdType id, quint64 stationId, bool dontThrow) const
+    void CachingEveDataProvider::resetExternalOrderCaches()
     {
-        std::lock_guard<std::recursive_mutex> lock{mExternalOrderCacheMutex};
+        mStationSellPrices.clear();
+        mRegionSellPrices.clear();
+        mBuyPrices.clear();
+        mBuyOrderReachCache.clear();
+
+        // own orders might have changed
+        mOwnActiveOrderIds.clear();
+        mOwnActiveOrderIdsLoaded = false;
+    }
+
+    void CachingEveDataProvider::resetExternalOrderCaches(const TypeLocationPairs &typeRegions)
+    {
+        const auto isAffected = [&](const auto &key) {
+            return typeRegions.find(key) != std::end(typeRegions);
+        };
+        const auto isAffectedStation = [&](const auto &key, const auto &) {
+            return isAffected(std::make_pair(key.first, getStationRegionId(key.second)));
+        };
+
+        mStationSellPrices.eraseIf(isAffectedStation);
+        mBuyPrices.eraseIf(isAffectedStation);
+        mRegionSellPrices.eraseIf([&](const auto &key, const auto &) {
+            return isAffected(key);
+        });
+
+        for (const auto &typeRegion : typeRegions)
+            mBuyOrderReachCache.erase(typeRegion);
+    }
 
+    std::shared_ptr<ExternalOrder> CachingEveDataProvider::getTypeSellPrice(EveType::IdType id, quint64 stationId, bool dontThrow) const
+    {
         const auto key = std::make_pair(id, stationId);
-        const auto it = mStationSellPrices.find(key);
-        if (it != std::end(mStationSellPrices))
-            return it->second;
 
         std::shared_ptr<ExternalOrder> result;
+        if (mStationSellPrices.find(key, result))
+            return result;
 
-        try
+        std::lock_guard<std::mutex> lock{mExternalOrderCacheMutex};
+
+        const auto regionId = getStationRegionId(stationId);
+        if (regionId != 0)
         {
-            result = mExternalOrderRepository.findSellByTypeAndStation(id, stationId, mMarketOrderRepository, mCorpMarketOrderRepository);
+            const auto &orders = getOrderBook().getSellOrders(id, regionId);
+            for (auto i = 0u; i < orders.size(); ++i)
+            {
+                if (orders.mStationIds[i] == stationId && !isOwnActiveOrder(orders.mIds[i]))
+                {
+                    result = std::make_shared<ExternalOrder>(orders.getOrder(i));
+                    break;
+                }
+            }
         }
-        catch (const ExternalOrderRepository::NotFoundException &)
+
+        if (!result)
         {
             if (!dontThrow)
-                throw;
+                BOOST_THROW_EXCEPTION(ExternalOrderRepository::NotFoundException{});
 
             result = std::make_shared<ExternalOrder>();
         }
 
-        mStationSellPrices.emplace(key, result);
+        mStationSellPrices.insert(key, result);
         return result;
     }
 
     void CachingEveDataProvider::fetchGenericName(quint64 id)
     {
-        qDebug() << "Fetching generic name:" << id;
-
-        // potential recursive lock if sync invokation
         std::lock_guard<std::recursive_mutex> lock{mGenericNameCacheMutex};
 
-        mPendingNameRequests.emplace(id);
+        // requests are queued, so this might have been resolved in the meantime
+        if (mGenericNameCache.contains(id))
+            return;
 
-        mDataManagerProvider.getESIManager().fetchGenericName(id, [=](auto &&data, const auto &error) {
-            qDebug() << "Got generic name:" << id << data << " (" << error << ")";
+        mPendingNameRequests.emplace(id);
+        mNameResolver.resolve(id);
+    }
 
-            std::lock_guard<std::recursive_mutex> lock{mGenericNameCacheMutex};
+    void CachingEveDataProvider::updateGenericNames(const GenericNameResolver::NameMap &names)
+    {
+        qDebug() << "Got" << names.size() << "generic names.";
 
-            mPendingNameRequests.erase(id);
+        std::lock_guard<std::recursive_mutex> lock{mGenericNameCacheMutex};
 
-            if (error.isEmpty())
-                mGenericNameCache[id] = std::move(data);
-            else
-                mGenericNameCache[id] = tr("(unknown)");
+        for (auto name = std::begin(names); name != std::end(names); ++name)
+        {
+            mGenericNameCache[name.key()] = name.value();
+            mPendingNameRequests.erase(name.key());
+        }
 
-            if (mPendingNameRequests.empty())
-                emit namesChanged();
-        });
+        emit namesChanged();
     }
 
-    EveTypeRepository::EntityPtr CachingEveDataProvider::getEveType(EveType::IdType id) const
+    void CachingEveDataProvider::setUnknownGenericNames(const std::vector<quint64> &ids)
     {
-        const auto it = mTypeCache.find(id);
-        if (it != std::end(mTypeCache))
-            return it->second;
-
-        EveTypeRepository::EntityPtr type;
+        std::lock_guard<std::recursive_mutex> lock{mGenericNameCacheMutex};
 
-        try
-        {
-            type = mEveTypeRepository.find(id);
-        }
-        catch (const EveTypeRepository::NotFoundException &)
+        // not persisted, so they get another chance next time
+        for (const auto id : ids)
         {
-            type = std::make_shared<EveType>();
+            mGenericNameCache[id] = tr("(unknown)");
+            mPendingNameRequests.erase(id);
         }
 
-        return mTypeCache.emplace(id, type).first->second;
+        emit namesChanged();
     }
 
-    MarketGroupRepository::EntityPtr CachingEveDataProvider::getMarketGroupParent(MarketGroup::IdType id) const
+    EveTypeRepository::EntityPtr CachingEveDataProvider::getEveType(EveType::IdType id) const
     {
-        const auto it = mTypeMarketGroupParentCache.find(id);
-        if (it != std::end(mTypeMarketGroupParentCache))
-            return it->second;
+        return mTypeCache.get(id, [=]() -> EveTypeRepository::EntityPtr {
+            const auto packedType = mStaticData.findType(id);
+            if (packedType != nullptr)
+            {
+                auto type = std::make_shared<EveType>(id);
+                type->setGroupId(packedType->mGroupId);
+                type->setName(mStaticData.getString(packedType->mName));
+                type->setVolume(packedType->mVolume);
+                type->setMarketGroupId((packedType->mMarketGroupId == 0) ? (EveType::MarketGroupIdType{}) : (packedType->mMarketGroupId));
+                type->setNew(false);
+
+                return type;
+            }
 
-        MarketGroupRepository::EntityPtr result;
+            try
+            {
+                return mEveTypeRepository.find(id);
+            }
+            catch (const EveTypeRepository::NotFoundException &)
+            {
+                return std::make_shared<EveType>();
+            }
+        });
+    }
 
-        try
-        {
-            result = mMarketGroupRepository.findParent(id);
-        }
-        catch (const MarketGroupRepository::NotFoundException &)
-        {
-            result = std::make_shared<MarketGroup>();
-        }
+    MarketGroupRepository::EntityPtr CachingEveDataProvider::getMarketGroupParent(MarketGroup::IdType id) const
+    {
+        return mTypeMarketGroupParentCache.get(id, [=]() -> MarketGroupRepository::EntityPtr {
+            const auto group = mStaticData.findMarketGroup(id);
+            if (group != nullptr)
+            {
+                const auto parent = mStaticData.findMarketGroup(group->mParentId);
+                return (parent != nullptr) ? (getPackedMarketGroup(*parent)) : (std::make_shared<MarketGroup>());
+            }
 
-        return mTypeMarketGroupParentCache.emplace(id, result).first->second;
+            try
+            {
+                return mMarketGroupRepository.findParent(id);
+            }
+            catch (const MarketGroupRepository::NotFoundException &)
+            {
+                return std::make_shared<MarketGroup>();
+            }
+        });
     }
 
     MarketGroupRepository::EntityPtr CachingEveDataProvider::getMarketGroup(MarketGroup::IdType id) const
     {
-        const auto it = mTypeMarketGroupCache.find(id);
-        if (it != std::end(mTypeMarketGroupCache))
-            return it->second;
+        return mTypeMarketGroupCache.get(id, [=]() -> MarketGroupRepository::EntityPtr {
+            const auto group = mStaticData.findMarketGroup(id);
+            if (group != nullptr)
+                return getPackedMarketGroup(*group);
 
-        MarketGroupRepository::EntityPtr result;
+            try
+            {
+                return mMarketGroupRepository.find(id);
+            }
+            catch (const MarketGroupRepository::NotFoundException &)
+            {
+                return std::make_shared<MarketGroup>();
+            }
+        });
+    }
 
-        try
-        {
-            result = mMarketGroupRepository.find(id);
-        }
-        catch (const MarketGroupRepository::NotFoundException &)
-        {
-            result = std::make_shared<MarketGroup>();
-        }
+    MarketGroupRepository::EntityPtr CachingEveDataProvider::getPackedMarketGroup(const StaticDataPack::MarketGroupEntry &group) const
+    {
+        auto result = std::make_shared<MarketGroup>(group.mId);
+        result->setParentId((group.mParentId == 0) ? (MarketGroup::ParentIdType{}) : (group.mParentId));
+        result->setName(mStaticData.getString(group.mName));
+        result->setNew(false);
 
-        return mTypeMarketGroupCache.emplace(id, result).first->second;
+        return result;
     }
 
     uint CachingEveDataProvider::getSolarSystemRegionId(uint systemId) const
     {
-        std::lock_guard<std::mutex> lock{mSolarSystemRegionCacheMutex};
+        return mSolarSystemRegionCache.get(systemId, [=] {
+            const auto solarSystem = mStaticData.findSolarSystem(systemId);
+            if (solarSystem != nullptr)
+                return solarSystem->mRegionId;
 
-        const auto it = mSolarSystemRegionCache.find(systemId);
-        if (it != std::end(mSolarSystemRegionCache))
-            return it->second;
-
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT regionID FROM mapSolarSystems WHERE solarSystemID = ?"));
-        query.bindValue(0, systemId);
-
-        DatabaseUtils::execQuery(query);
-        query.next();
+            QSqlQuery query{mConnectionProvider.getConnection()};
+            query.prepare(QStringLiteral("SELECT regionID FROM mapSolarSystems WHERE solarSystemID = ?"));
+            query.bindValue(0, systemId);
 
-        const auto regionId = query.value(0).toUInt();
+            DatabaseUtils::execQuery(query);
+            query.next();
 
-        mSolarSystemRegionCache.emplace(systemId, regionId);
-        return regionId;
+            return query.value(0).toUInt();
+        });
     }
 
-    const ExternalOrderRepository::EntityList &CachingEveDataProvider::getExternalOrders(EveType::IdType typeId, uint regionId) const
+    const ExternalOrderBook &CachingEveDataProvider::getOrderBook() const
     {
-        std::lock_guard<std::recursive_mutex> lock{mExternalOrderCacheMutex};
+        if (!mOrderBookLoaded)
+        {
+            // wait for the background load, if it's still up to date
+            auto book = (mPendingOrderBook.isCanceled()) ? (nullptr) : (mPendingOrderBook.result());
 
-        const auto key = std::make_pair(typeId, regionId);
-        const auto it = mTypeRegionOrderCache.find(key);
-        if (it != std::end(mTypeRegionOrderCache))
-            return it->second;
+            // the future keeps its result alive
+            mPendingOrderBook = {};
+            mPendingOrderBookDiscarded.reset();
 
-        return mTypeRegionOrderCache.emplace(
-            key, mExternalOrderRepository.findBuyByTypeAndRegion(typeId, regionId, mMarketOrderRepository, mCorpMarketOrderRepository))
-                .first->second;
+            if (book)
+            {
+                mOrderBook = std::move(*book);
+                book.reset();
+            }
+            else
+            {
+                mExternalOrderRepository.forEachChunk(4096, [=](const auto &orders) {
+                    mOrderBook.add(orders);
+                });
+                mOrderBook.sort();
+            }
+
+            mOrderBookMonitor.update(mOrderBook);
+            mOrderBookLoaded = true;
+
+            qDebug() << "Loaded" << mOrderBook.size() << "orders into order book.";
+        }
+
+        return mOrderBook;
     }
 
-    uint CachingEveDataProvider::getDistance(uint startSystem, uint endSystem) const
+    void CachingEveDataProvider::discardPendingOrderBook() const
     {
-        const auto key = qMakePair(startSystem, endSystem);
-        const auto it = mSystemDistances.find(key);
-        if (it != std::end(mSystemDistances))
-            return it.value();
-
-        const auto makeUnreachable = [=] {
-            const auto value = std::numeric_limits<uint>::max();
-            mSystemDistances[key] = value;
-            mSystemDistances[qMakePair(endSystem, startSystem)] = value;
+        if (mPendingOrderBookDiscarded)
+            *mPendingOrderBookDiscarded = true;
 
-            return value;
-        };
+        mPendingOrderBook = {};
+        mPendingOrderBookDiscarded.reset();
+    }
 
-        const auto regionId = getSolarSystemRegionId(startSystem);
-        if (regionId == 0)
-            return makeUnreachable();
+    const BuyOrderReachIndex &CachingEveDataProvider::getBuyOrderReach(EveType::IdType typeId, uint regionId) const
+    {
+        const auto key = std::make_pair(typeId, regionId);
+        const auto it = mBuyOrderReachCache.find(key);
+        if (it != std::end(mBuyOrderReachCache))
+            return it->second;
 
-        const auto jIt = mSystemJumpMap.find(regionId);
-        if (jIt == std::end(mSystemJumpMap))
-            return makeUnreachable();
+        return mBuyOrderReachCache.emplace(key, BuyOrderReachIndex{getOrderBook().getBuyOrders(typeId, regionId), mJumpDistances}).first->second;
+    }
 
-        const auto &jumpMap = jIt->second;
+    bool CachingEveDataProvider::isOwnActiveOrder(ExternalOrder::IdType id) const
+    {
+        if (!mOwnActiveOrderIdsLoaded)
+        {
+            mOwnActiveOrderIds = mMarketOrderRepository.fetchActiveIds();
 
-        std::unordered_set<uint> visited;
-        std::queue<std::pair<uint, uint>> candidates;
+            const auto corpIds = mCorpMarketOrderRepository.fetchActiveIds();
+            mOwnActiveOrderIds.insert(std::begin(corpIds), std::end(corpIds));
 
-        visited.emplace(startSystem);
-        candidates.emplace(std::make_pair(startSystem, 0u));
+            mOwnActiveOrderIdsLoaded = true;
+        }
 
-        while (!candidates.empty())
-        {
-            const auto current = candidates.front();
-            candidates.pop();
+        return mOwnActiveOrderIds.find(id) != std::end(mOwnActiveOrderIds);
+    }
 
-            const auto depth = current.second;
-            if (current.first == endSystem)
-            {
-                mSystemDistances[key] = depth;
-                mSystemDistances[qMakePair(endSystem, startSystem)] = depth;
+    uint CachingEveDataProvider::getDistance(uint startSystem, uint endSystem) const
+    {
+        return mJumpDistances.getDistance(startSystem, endSystem);
+    }
 
-                return depth;
-            }
+    uint CachingEveDataProvider::getRouteLength(uint startSystem, uint endSystem, RouteType type) const
+    {
+        return mRouteFinder.getDistance(startSystem, endSystem, type);
+    }
 
-            const auto children = jumpMap.equal_range(current.first);
-            for (auto it = children.first; it != children.second; ++it)
-            {
-                if (visited.find(it->second) == std::end(visited))
-                {
-                    visited.emplace(it->second);
-                    candidates.emplace(std::make_pair(it->second, depth + 1));
-                }
-            }
-        }
+    std::vector<uint> CachingEveDataProvider::getRouteLengths(uint startSystem, const std::vector<uint> &endSystems, RouteType type) const
+    {
+        return mRouteFinder.getDistances(startSystem, endSystems, type);
+    }
 
-        return makeUnreachable();
+    std::vector<uint> CachingEveDataProvider::getRoute(uint startSystem, uint endSystem, RouteType type) const
+    {
+        return mRouteFinder.getRoute(startSystem, endSystem, type);
     }
 
     QString CachingEveDataProvider::getRaceName(uint raceId) const
@@ -1128,7 +1408,12 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
 
     const CachingEveDataProvider::ManufacturingInfo &CachingEveDataProvider::getTypeManufacturingInfo(EveType::IdType typeId) const
     {
+        std::lock_guard<std::mutex> lock{mTypeInfoCacheMutex};
+
         auto it = mTypeManufacturingInfoCache.find(typeId);
+        if (it == std::end(mTypeManufacturingInfoCache) && mStaticData.isLoaded())
+            it = mTypeManufacturingInfoCache.emplace(typeId, getPackedManufacturingInfo(typeId)).first;
+
         if (it == std::end(mTypeManufacturingInfoCache))
         {
             QSqlQuery query{mConnectionProvider.getConnection()};
@@ -1178,23 +1463,48 @@ SELECT m.materialTypeID, m.quantity, p.quantity, a.time, s.skillID FROM industry
 
     EveType::IdType CachingEveDataProvider::getBlueprintOutputType(EveType::IdType blueprintId) const
     {
-        auto type = mBlueprintOutputCache.find(blueprintId);
-        if (type == std::end(mBlueprintOutputCache))
-        {
+        return mBlueprintOutputCache.get(blueprintId, [=] {
+            if (mStaticData.isLoaded())
+            {
+                const auto blueprint = mStaticData.findBlueprint(blueprintId);
+                return (blueprint != nullptr) ? (blueprint->mProductId) : (EveType::invalidId);
+            }
+
             QSqlQuery query{mConnectionProvider.getConnection()};
             query.prepare(QStringLiteral("SELECT productTypeID FROM industryActivityProducts WHERE typeID = ? AND activityID = ?"));
             query.addBindValue(blueprintId);
             query.addBindValue(mManufacturingActivityId);
 
             DatabaseUtils::execQuery(query);
+            return (query.next()) ? (query.value(0).value<EveType::IdType>()) : (EveType::invalidId);
+        });
+    }
 
-            if (query.next())
-                type = mBlueprintOutputCache.emplace(blueprintId, query.value(0).value<EveType::IdType>()).first;
-            else
-                type = mBlueprintOutputCache.emplace(blueprintId, EveType::invalidId).first;
+    CachingEveDataProvider::ManufacturingInfo CachingEveDataProvider::getPackedManufacturingInfo(EveType::IdType typeId) const
+    {
+        ManufacturingInfo info{0};
+
+        const auto entry = mStaticData.findManufacturing(typeId);
+        if (entry == nullptr)
+            return info;
+
+        info.mQuantity = entry->mQuantity;
+        info.mTime = std::chrono::seconds{entry->mTime};
+
+        const auto materials = mStaticData.getMaterials(*entry);
+        info.mMaterials.reserve(entry->mMaterialCount);
+
+        for (auto i = 0u; i < entry->mMaterialCount; ++i)
+            info.mMaterials.emplace_back(MaterialInfo{materials[i].mTypeId, materials[i].mQuantity});
+
+        const auto skills = mStaticData.getSkills(*entry);
+        for (auto i = 0u; i < entry->mSkillCount; ++i)
+        {
+            if (skills[i] != industrySkillId && skills[i] != advancedIndustrySkillId)
+                info.mAdditionalsSkills.insert(skills[i]);
         }
 
-        return type->second;
+        return info;
     }
 
     QString CachingEveDataProvider::getCitadelName(Citadel::IdType id) const
@@ -1214,6 +1524,8 @@ SELECT m.materialTypeID, m.quantity, p.quantity, a.time, s.skillID FROM industry
 
     const Citadel &CachingEveDataProvider::getCitadel(Citadel::IdType id) const
     {
+        std::lock_guard<std::mutex> lock{mCitadelCacheMutex};
+
         auto citadel = mCitadelCache.find(id);
         if (citadel == std::end(mCitadelCache))
         {
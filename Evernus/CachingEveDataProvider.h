@@ -15,18 +15,28 @@
 #pragma once
 
 #include <unordered_set>
+#include <atomic>
 #include <mutex>
 
+#include <QThreadPool>
+#include <QFuture>
 #include <QStringList>
 #include <QHash>
 
 #include <boost/functional/hash.hpp>
 
 #include "ExternalOrderRepository.h"
+#include "GenericNameResolver.h"
 #include "MarketGroupRepository.h"
 #include "MetaGroupRepository.h"
+#include "JumpDistanceMatrix.h"
+#include "BuyOrderReachIndex.h"
 #include "EveTypeRepository.h"
+#include "ExternalOrderBook.h"
 #include "EveDataProvider.h"
+#include "ConcurrentCache.h"
+#include "StaticDataPack.h"
+#include "RouteFinder.h"
 #include "ESIManager.h"
 #include "Citadel.h"
 
@@ -45,6 +55,7 @@ namespace Evernus
 
     public:
         static const QString systemDistanceCacheFileName;
+        static const QString staticDataCacheFileName;
 
         CachingEveDataProvider(const EveTypeRepository &eveTypeRepository,
                                const MetaGroupRepository &metaGroupRepository,
@@ -106,6 +117,9 @@ namespace Evernus
         virtual uint getGroupId(const QString &name) const override;
 
         virtual uint getDistance(uint startSystem, uint endSystem) const override;
+        virtual uint getRouteLength(uint startSystem, uint endSystem, RouteType type = RouteType::Shortest) const override;
+        virtual std::vector<uint> getRouteLengths(uint startSystem, const std::vector<uint> &endSystems, RouteType type = RouteType::Shortest) const override;
+        virtual std::vector<uint> getRoute(uint startSystem, uint endSystem, RouteType type = RouteType::Shortest) const override;
 
         virtual QString getRaceName(uint raceId) const override;
         virtual QString getBloodlineName(uint bloodlineId) const override;
@@ -114,11 +128,14 @@ namespace Evernus
         virtual const ManufacturingInfo &getTypeManufacturingInfo(EveType::IdType typeId) const override;
         virtual EveType::IdType getBlueprintOutputType(EveType::IdType blueprintId) const override;
 
+        void precacheStaticData();
         void precacheNames();
         void precacheJumpMap();
         void precacheRefTypes();
 
         void clearExternalOrderCaches();
+        // drops the order book and loads it again in the background; for orders changed directly in the DB
+        void reloadOrderBook();
         void clearStationCache();
         void clearCitadelCache();
 
@@ -133,16 +150,19 @@ namespace Evernus
 
     private slots:
         void fetchGenericName(quint64 id);
+        void updateGenericNames(const GenericNameResolver::NameMap &names);
+        void setUnknownGenericNames(const std::vector<quint64> &ids);
 
     private:
         using TypeLocationPair = std::pair<EveType::IdType, quint64>;
-        using TypeRegionPair = std::pair<EveType::IdType, uint>;
 
         using NameMap = QHash<quint64, QString>;
 
         static const QString nameCacheFileName;
+        static const QString nameJournalFileName;
         static const QString raceCacheFileName;
         static const QString bloodlineCacheFileName;
+        static const QString jumpDistanceCacheFileName;
 
 
         static const QStringList oreGroupNames;
@@ -161,40 +181,59 @@ namespace Evernus
         mutable std::unordered_map<EveType::IdType, QString> mTradeableTypeNameCache;
         mutable TypeList mTradeableTypeCache;
         mutable TypeList mCitadelTypeCache;
-        mutable std::unordered_map<EveType::IdType, MetaGroupRepository::EntityPtr> mTypeMetaGroupCache;
-        mutable std::unordered_map<EveType::IdType, EveTypeRepository::EntityPtr> mTypeCache;
+        mutable ConcurrentCache<EveType::IdType, MetaGroupRepository::EntityPtr> mTypeMetaGroupCache;
+        mutable ConcurrentCache<EveType::IdType, EveTypeRepository::EntityPtr> mTypeCache;
 
-        mutable std::unordered_map<TypeLocationPair, ExternalOrderRepository::EntityPtr, boost::hash<TypeLocationPair>>
-        mStationSellPrices;
-        mutable std::unordered_map<TypeLocationPair, ExternalOrderRepository::EntityPtr, boost::hash<TypeLocationPair>>
-        mRegionSellPrices;
-        mutable std::unordered_map<TypeLocationPair, ExternalOrderRepository::EntityPtr, boost::hash<TypeLocationPair>>
-        mBuyPrices;
+        // lookups don't need mExternalOrderCacheMutex, but filling them does
+        mutable ConcurrentCache<TypeLocationPair, ExternalOrderRepository::EntityPtr, boost::hash<TypeLocationPair>> mStationSellPrices;
+        mutable ConcurrentCache<TypeLocationPair, ExternalOrderRepository::EntityPtr, boost::hash<TypeLocationPair>> mRegionSellPrices;
+        mutable ConcurrentCache<TypeLocationPair, ExternalOrderRepository::EntityPtr, boost::hash<TypeLocationPair>> mBuyPrices;
 
-        mutable std::unordered_map<TypeRegionPair, ExternalOrderRepository::EntityList, boost::hash<TypeRegionPair>>
-        mTypeRegionOrderCache;
+        mutable ExternalOrderBook mOrderBook;
+        mutable ExternalOrderBookMonitor mOrderBookMonitor;
+        mutable bool mOrderBookLoaded = false;
+        // loaded in the background and picked up on first use; empty (canceled) when there's none or it missed a change
+        mutable QFuture<std::shared_ptr<ExternalOrderBook>> mPendingOrderBook;
+        // set when the pending load gets discarded, so it stops collecting orders
+        mutable std::shared_ptr<std::atomic_bool> mPendingOrderBookDiscarded;
+        // single thread, so the destructor can wait for loads still reading the repository
+        QThreadPool mOrderBookLoader;
 
-        mutable std::unordered_map<quint64, QString> mLocationNameCache;
+        mutable std::unordered_map<TypeLocationPair, BuyOrderReachIndex, boost::hash<TypeLocationPair>> mBuyOrderReachCache;
 
-        mutable std::unordered_map<EveType::IdType, MarketGroupRepository::EntityPtr> mTypeMarketGroupParentCache;
-        mutable std::unordered_map<EveType::IdType, MarketGroupRepository::EntityPtr> mTypeMarketGroupCache;
+        mutable std::unordered_set<ExternalOrder::IdType> mOwnActiveOrderIds;
+        mutable bool mOwnActiveOrderIdsLoaded = false;
+
+        mutable ConcurrentCache<quint64, QString> mLocationNameCache;
+
+        mutable ConcurrentCache<EveType::IdType, MarketGroupRepository::EntityPtr> mTypeMarketGroupParentCache;
+        mutable ConcurrentCache<EveType::IdType, MarketGroupRepository::EntityPtr> mTypeMarketGroupCache;
 
         mutable NameMap mGenericNameCache;
         mutable std::unordered_set<quint64> mPendingNameRequests;
 
-        std::unordered_map<uint, std::unordered_multimap<uint, uint>> mSystemJumpMap;
+        GenericNameResolver mNameResolver;
+
+        StaticDataPack mStaticData;
+
+        JumpDistanceMatrix mJumpDistances;
+        RouteFinder mRouteFinder;
 
-        mutable std::unordered_map<uint, uint> mSolarSystemRegionCache;
-        mutable std::unordered_map<uint, uint> mSolarSystemConstellationCache;
-        mutable std::unordered_map<quint64, uint> mLocationSolarSystemCache;
+        mutable ConcurrentCache<uint, uint> mSolarSystemRegionCache;
+        mutable ConcurrentCache<uint, uint> mSolarSystemConstellationCache;
+        mutable ConcurrentCache<quint64, uint> mLocationSolarSystemCache;
 
-        mutable std::mutex mLocationSolarSystemCacheMutex;
-        mutable std::mutex mTypeCacheMutex;
-        mutable std::recursive_mutex mExternalOrderCacheMutex;
-        mutable std::mutex mSolarSystemRegionCacheMutex;
+        // guards the order book and everything derived from it
+        mutable std::mutex mExternalOrderCacheMutex;
         mutable std::recursive_mutex mGenericNameCacheMutex;
 
-        mutable std::unordered_map<uint, double> mSecurityStatuses;
+        // the following are filled lazily, also from worker threads
+        // entries are only added outside of clear*(), so references handed out stay valid
+        mutable std::mutex mMapCacheMutex;          // regions, constellations, solar systems and stations
+        mutable std::mutex mCitadelCacheMutex;
+        mutable std::mutex mTypeInfoCacheMutex;     // tradeable types, groups, reprocessing and manufacturing
+
+        mutable ConcurrentCache<uint, double> mSecurityStatuses;
 
         mutable std::vector<MapLocation> mRegionCache;
         mutable std::unordered_map<uint, std::vector<MapLocation>> mConstellationCache, mConstellationSolarSystemCache, mRegionSolarSystemCache;
@@ -206,22 +245,20 @@ namespace Evernus
         mutable std::vector<MapTreeLocation> mAllSolarSystemsCache;
         mutable CitadelRepository::EntityList mAllCitadelsCache;
 
-        mutable std::unordered_map<uint, QString> mRegionNameCache;
-        mutable std::unordered_map<uint, QString> mSolarSystemNameCache;
+        mutable ConcurrentCache<uint, QString> mRegionNameCache;
+        mutable ConcurrentCache<uint, QString> mSolarSystemNameCache;
 
-        mutable std::unordered_map<quint64, uint> mStationRegionCache;
+        mutable ConcurrentCache<quint64, uint> mStationRegionCache;
 
         mutable QHash<QString, uint> mGroupIdCache;
 
-        bool mUsePackagedVolume = false;
-
-        mutable QHash<QPair<uint, uint>, uint> mSystemDistances;
+        std::atomic_bool mUsePackagedVolume{false};
 
         mutable ReprocessingMap mOreReprocessingInfo;
         mutable ReprocessingMap mTypeReprocessingInfo;
 
         mutable std::unordered_map<EveType::IdType, ManufacturingInfo> mTypeManufacturingInfoCache;
-        mutable std::unordered_map<EveType::IdType, EveType::IdType> mBlueprintOutputCache;
+        mutable ConcurrentCache<EveType::IdType, EveType::IdType> mBlueprintOutputCache;
 
         NameMap mRaceNameCache;
         NameMap mBloodlineNameCache;
@@ -233,8 +270,17 @@ namespace Evernus
 
         MarketGroupRepository::EntityPtr getMarketGroupParent(MarketGroup::IdType id) const;
         MarketGroupRepository::EntityPtr getMarketGroup(MarketGroup::IdType id) const;
-
-        const ExternalOrderRepository::EntityList &getExternalOrders(EveType::IdType typeId, uint regionId) const;
+        MarketGroupRepository::EntityPtr getPackedMarketGroup(const StaticDataPack::MarketGroupEntry &group) const;
+        ManufacturingInfo getPackedManufacturingInfo(EveType::IdType typeId) const;
+
+        // all require mExternalOrderCacheMutex to be held
+        const ExternalOrderBook &getOrderBook() const;
+        const BuyOrderReachIndex &getBuyOrderReach(EveType::IdType typeId, uint regionId) const;
+        bool isOwnActiveOrder(ExternalOrder::IdType id) const;
+        void resetExternalOrderCaches();
+        // only entries depending on given types in given regions
+        void resetExternalOrderCaches(const TypeLocationPairs &typeRegions);
+        void discardPendingOrderBook() const;
 
         QString getCitadelName(Citadel::IdType id) const;
         uint getCitadelRegionId(Citadel::IdType id) const;
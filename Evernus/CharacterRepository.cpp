@@ -239,7 +239,10 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return query.value(0).toULongLong();
+        const auto corpId = query.value(0).toULongLong();
+        query.finish();
+
+        return corpId;
     }
 
     QString CharacterRepository::getName(Character::IdType id) const
@@ -252,7 +255,10 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return query.value(0).toString();
+        const auto name = query.value(0).toString();
+        query.finish();
+
+        return name;
     }
 
     QSqlQuery CharacterRepository::getEnabledQuery() const
@@ -0,0 +1,85 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <tuple>
+
+#include <QStringList>
+
+class QSqlRecord;
+class QSqlQuery;
+class QVariant;
+
+namespace Evernus
+{
+    // maps an entity field to a table column
+    template<class Getter, class Setter>
+    struct Column
+    {
+        const char *mName;
+        Getter mGetter;
+        Setter mSetter;
+        bool mIsId;
+    };
+
+    template<class Getter, class Setter>
+    constexpr Column<Getter, Setter> makeColumn(const char *name, Getter getter, Setter setter) noexcept;
+    template<class Entity>
+    constexpr auto makeIdColumn(const char *name) noexcept;
+
+    // generates binding and row decoding code for a list of column descriptors
+    // rows are decoded by ordinal, so resolve ordinals once per query and reuse them for every row
+    template<class Entity, class... Columns>
+    class ColumnSet final
+    {
+    public:
+        using Ordinals = std::vector<int>;
+
+        explicit ColumnSet(Columns... columns);
+        ColumnSet(const ColumnSet &) = default;
+        ColumnSet(ColumnSet &&) = default;
+        ~ColumnSet() = default;
+
+        QStringList getNames() const;
+
+        void bindValues(const Entity &entity, QSqlQuery &query) const;
+        void bindPositionalValues(const Entity &entity, QSqlQuery &query) const;
+
+        Ordinals resolveOrdinals(const QSqlRecord &record) const;
+
+        // Row can be anything with value(int), i.e. QSqlQuery or QSqlRecord
+        template<class Row>
+        void decode(const Row &row, const Ordinals &ordinals, Entity &entity) const;
+
+        ColumnSet &operator =(const ColumnSet &) = default;
+        ColumnSet &operator =(ColumnSet &&) = default;
+
+    private:
+        std::tuple<Columns...> mColumns;
+        QStringList mNames, mPlaceholders;
+
+        template<class Func>
+        void forEachColumn(Func &&func) const;
+        template<class Func, std::size_t... Indexes>
+        void forEachColumn(Func &&func, std::index_sequence<Indexes...>) const;
+    };
+
+    template<class Entity, class... Columns>
+    ColumnSet<Entity, Columns...> makeColumnSet(Columns... columns);
+}
+
+#include "ColumnSet.inl"
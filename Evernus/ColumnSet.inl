@@ -0,0 +1,130 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QSqlRecord>
+#include <QSqlQuery>
+#include <QVariant>
+
+namespace Evernus
+{
+    template<class Getter, class Setter>
+    constexpr Column<Getter, Setter> makeColumn(const char *name, Getter getter, Setter setter) noexcept
+    {
+        return { name, getter, setter, false };
+    }
+
+    template<class Entity>
+    constexpr auto makeIdColumn(const char *name) noexcept
+    {
+        const auto getter = [](const Entity &entity) {
+            return entity.getId();
+        };
+        const auto setter = [](Entity &entity, const QVariant &value) {
+            entity.setId(value.template value<typename Entity::IdType>());
+            // decoded rows are persisted, so they must not look new
+            entity.updateOriginalId();
+        };
+
+        return Column<decltype(getter), decltype(setter)>{ name, getter, setter, true };
+    }
+
+    template<class Entity, class... Columns>
+    ColumnSet<Entity, Columns...>::ColumnSet(Columns... columns)
+        : mColumns{columns...}
+    {
+        forEachColumn([&](const auto &column, auto index) {
+            Q_UNUSED(index);
+
+            const auto name = QString::fromLatin1(column.mName);
+
+            mNames << name;
+            mPlaceholders << QStringLiteral(":") + name;
+        });
+    }
+
+    template<class Entity, class... Columns>
+    QStringList ColumnSet<Entity, Columns...>::getNames() const
+    {
+        return mNames;
+    }
+
+    template<class Entity, class... Columns>
+    void ColumnSet<Entity, Columns...>::bindValues(const Entity &entity, QSqlQuery &query) const
+    {
+        forEachColumn([&](const auto &column, auto index) {
+            if (column.mIsId && entity.getId() == Entity::invalidId)
+                return;
+
+            query.bindValue(mPlaceholders[index], column.mGetter(entity));
+        });
+    }
+
+    template<class Entity, class... Columns>
+    void ColumnSet<Entity, Columns...>::bindPositionalValues(const Entity &entity, QSqlQuery &query) const
+    {
+        forEachColumn([&](const auto &column, auto index) {
+            Q_UNUSED(index);
+
+            if (column.mIsId && entity.getId() == Entity::invalidId)
+                return;
+
+            query.addBindValue(column.mGetter(entity));
+        });
+    }
+
+    template<class Entity, class... Columns>
+    typename ColumnSet<Entity, Columns...>::Ordinals ColumnSet<Entity, Columns...>::resolveOrdinals(const QSqlRecord &record) const
+    {
+        Ordinals ordinals;
+        ordinals.reserve(mNames.size());
+
+        for (const auto &name : mNames)
+            ordinals.emplace_back(record.indexOf(name));
+
+        return ordinals;
+    }
+
+    template<class Entity, class... Columns>
+    template<class Row>
+    void ColumnSet<Entity, Columns...>::decode(const Row &row, const Ordinals &ordinals, Entity &entity) const
+    {
+        Q_ASSERT(ordinals.size() == sizeof...(Columns));
+
+        forEachColumn([&](const auto &column, auto index) {
+            const auto ordinal = ordinals[index];
+            if (ordinal >= 0)
+                column.mSetter(entity, row.value(ordinal));
+        });
+    }
+
+    template<class Entity, class... Columns>
+    template<class Func>
+    void ColumnSet<Entity, Columns...>::forEachColumn(Func &&func) const
+    {
+        forEachColumn(std::forward<Func>(func), std::index_sequence_for<Columns...>{});
+    }
+
+    template<class Entity, class... Columns>
+    template<class Func, std::size_t... Indexes>
+    void ColumnSet<Entity, Columns...>::forEachColumn(Func &&func, std::index_sequence<Indexes...>) const
+    {
+        (func(std::get<Indexes>(mColumns), Indexes), ...);
+    }
+
+    template<class Entity, class... Columns>
+    ColumnSet<Entity, Columns...> makeColumnSet(Columns... columns)
+    {
+        return ColumnSet<Entity, Columns...>{columns...};
+    }
+}
@@ -25,4 +25,13 @@ namespace Evernus::CommandLineOptions
     const auto maxLogFileSizeArg = QStringLiteral("max-log-file-size");
     const auto maxLogFilesArg = QStringLiteral("max-log-files");
     const auto forceSDEUpdateArg = QStringLiteral("force-sde-update");
+    const auto esiUrlArg = QStringLiteral("esi-url");
+    const auto esiRecordArg = QStringLiteral("esi-record");
+    const auto esiReplayArg = QStringLiteral("esi-replay");
+    const auto esiReplayPortArg = QStringLiteral("esi-replay-port");
+    const auto esiReplayLatencyArg = QStringLiteral("esi-replay-latency");
+    const auto esiReplayMaxPagesArg = QStringLiteral("esi-replay-max-pages");
+    const auto esiReplayServerErrorRateArg = QStringLiteral("esi-replay-server-error-rate");
+    const auto esiReplayErrorLimitRateArg = QStringLiteral("esi-replay-error-limit-rate");
+    const auto esiReplayErrorLimitArg = QStringLiteral("esi-replay-error-limit");
 }
@@ -0,0 +1,120 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <shared_mutex>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <array>
+
+#include <QString>
+
+#include "CacheMonitor.h"
+
+namespace Evernus
+{
+    // approximate heap memory owned by a cached key or value, on top of its own size
+    template<class T>
+    std::size_t getCacheMemoryUsage(const T &value) noexcept;
+    inline std::size_t getCacheMemoryUsage(const QString &value) noexcept;
+    template<class T>
+    std::size_t getCacheMemoryUsage(const std::vector<T> &value) noexcept;
+    template<class T>
+    std::size_t getCacheMemoryUsage(const std::shared_ptr<T> &value) noexcept;
+
+    // hash map split into independently locked shards, for caches filled from many threads
+    // named caches are registered in CacheMonitor and, once given a budget, evict entries using the CLOCK policy
+    template<class Key, class T, class Hash = std::hash<Key>, std::size_t ShardCount = 16>
+    class ConcurrentCache final
+        : public CacheMonitor::MonitoredCache
+    {
+    public:
+        explicit ConcurrentCache(QString name = QString{}, uint weight = 1);
+        ConcurrentCache(const ConcurrentCache &) = delete;
+        ConcurrentCache(ConcurrentCache &&) = delete;
+        virtual ~ConcurrentCache();
+
+        // returns the cached value or stores the computed one
+        // computation runs without any lock held, so it may use other caches; when threads race, the first value stored wins
+        template<class Func>
+        T get(const Key &key, Func &&compute);
+
+        bool find(const Key &key, T &value) const;
+        void insert(const Key &key, T value);
+        void erase(const Key &key);
+        void clear();
+
+        // pred(key, value) is called with the shard locked, so it must not use this cache
+        template<class Pred>
+        void eraseIf(Pred pred);
+
+        std::size_t size() const;
+
+        virtual CacheMonitor::CacheStats getStats() const override;
+        virtual void resetStats() override;
+        virtual void setBudget(std::size_t bytes) override;
+
+        ConcurrentCache &operator =(const ConcurrentCache &) = delete;
+        ConcurrentCache &operator =(ConcurrentCache &&) = delete;
+
+    private:
+        struct Entry
+        {
+            T mValue;
+            std::size_t mSize;
+            std::size_t mClockIndex;
+            // set on access, cleared by the clock hand - entries not referenced since the last sweep get evicted
+            mutable std::atomic_bool mReferenced{true};
+
+            Entry(T value, std::size_t size, std::size_t clockIndex);
+        };
+
+        using ValueMap = std::unordered_map<Key, Entry, Hash>;
+
+        // separate cache lines, so shards don't contend through false sharing
+        struct alignas(64) Shard
+        {
+            mutable std::shared_mutex mMutex;
+            ValueMap mValues;
+            std::vector<Key> mClock;
+            std::size_t mClockHand = 0;
+            std::size_t mBytes = 0;
+
+            mutable std::atomic<quint64> mHits{0};
+            mutable std::atomic<quint64> mMisses{0};
+            std::atomic<quint64> mEvictions{0};
+        };
+
+        QString mName;
+        std::array<Shard, ShardCount> mShards;
+        std::atomic<std::size_t> mShardBudget{0};
+
+        // shard mutex must be held exclusively for the following
+        void store(Shard &shard, const Key &key, T value);
+        void remove(Shard &shard, typename ValueMap::iterator it);
+        void evict(Shard &shard);
+
+        Shard &getShard(const Key &key);
+        const Shard &getShard(const Key &key) const;
+
+        static std::size_t getShardIndex(const Key &key);
+        static std::size_t getEntrySize(const Key &key, const T &value) noexcept;
+    };
+}
+
+#include "ConcurrentCache.inl"
@@ -0,0 +1,329 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <utility>
+#include <tuple>
+#include <mutex>
+
+#include <boost/functional/hash.hpp>
+
+namespace Evernus
+{
+    template<class T>
+    std::size_t getCacheMemoryUsage(const T &value) noexcept
+    {
+        Q_UNUSED(value);
+        return 0;
+    }
+
+    inline std::size_t getCacheMemoryUsage(const QString &value) noexcept
+    {
+        return static_cast<std::size_t>(value.capacity()) * sizeof(QChar);
+    }
+
+    template<class T>
+    std::size_t getCacheMemoryUsage(const std::vector<T> &value) noexcept
+    {
+        return value.capacity() * sizeof(T);
+    }
+
+    template<class T>
+    std::size_t getCacheMemoryUsage(const std::shared_ptr<T> &value) noexcept
+    {
+        return (value) ? (sizeof(T) + getCacheMemoryUsage(*value)) : (0);
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    ConcurrentCache<Key, T, Hash, ShardCount>::Entry::Entry(T value, std::size_t size, std::size_t clockIndex)
+        : mValue{std::move(value)}
+        , mSize{size}
+        , mClockIndex{clockIndex}
+    {
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    ConcurrentCache<Key, T, Hash, ShardCount>::ConcurrentCache(QString name, uint weight)
+        : mName{std::move(name)}
+    {
+        if (!mName.isEmpty())
+            CacheMonitor::registerCache(*this, weight);
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    ConcurrentCache<Key, T, Hash, ShardCount>::~ConcurrentCache()
+    {
+        if (!mName.isEmpty())
+            CacheMonitor::unregisterCache(*this);
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    template<class Func>
+    T ConcurrentCache<Key, T, Hash, ShardCount>::get(const Key &key, Func &&compute)
+    {
+        auto &shard = getShard(key);
+
+        {
+            std::shared_lock<std::shared_mutex> lock{shard.mMutex};
+
+            const auto it = shard.mValues.find(key);
+            if (it != std::end(shard.mValues))
+            {
+                ++shard.mHits;
+                it->second.mReferenced = true;
+                return it->second.mValue;
+            }
+        }
+
+        ++shard.mMisses;
+
+        auto value = std::forward<Func>(compute)();
+
+        std::lock_guard<std::shared_mutex> lock{shard.mMutex};
+
+        const auto it = shard.mValues.find(key);
+        if (it != std::end(shard.mValues))
+            return it->second.mValue;
+
+        // the new entry itself may get evicted, when it doesn't fit the budget
+        T result = value;
+        store(shard, key, std::move(value));
+
+        return result;
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    bool ConcurrentCache<Key, T, Hash, ShardCount>::find(const Key &key, T &value) const
+    {
+        const auto &shard = getShard(key);
+        std::shared_lock<std::shared_mutex> lock{shard.mMutex};
+
+        const auto it = shard.mValues.find(key);
+        if (it == std::end(shard.mValues))
+        {
+            ++shard.mMisses;
+            return false;
+        }
+
+        ++shard.mHits;
+        it->second.mReferenced = true;
+
+        value = it->second.mValue;
+        return true;
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::insert(const Key &key, T value)
+    {
+        auto &shard = getShard(key);
+        std::lock_guard<std::shared_mutex> lock{shard.mMutex};
+
+        const auto it = shard.mValues.find(key);
+        if (it != std::end(shard.mValues))
+            remove(shard, it);
+
+        store(shard, key, std::move(value));
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::erase(const Key &key)
+    {
+        auto &shard = getShard(key);
+        std::lock_guard<std::shared_mutex> lock{shard.mMutex};
+
+        const auto it = shard.mValues.find(key);
+        if (it != std::end(shard.mValues))
+            remove(shard, it);
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::clear()
+    {
+        for (auto &shard : mShards)
+        {
+            std::lock_guard<std::shared_mutex> lock{shard.mMutex};
+
+            shard.mValues.clear();
+            shard.mClock.clear();
+            shard.mClockHand = 0;
+            shard.mBytes = 0;
+        }
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    template<class Pred>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::eraseIf(Pred pred)
+    {
+        for (auto &shard : mShards)
+        {
+            std::lock_guard<std::shared_mutex> lock{shard.mMutex};
+
+            for (auto it = std::begin(shard.mValues); it != std::end(shard.mValues);)
+            {
+                if (pred(it->first, it->second.mValue))
+                {
+                    const auto next = std::next(it);
+                    remove(shard, it);
+                    it = next;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    std::size_t ConcurrentCache<Key, T, Hash, ShardCount>::size() const
+    {
+        std::size_t result = 0;
+        for (const auto &shard : mShards)
+        {
+            std::shared_lock<std::shared_mutex> lock{shard.mMutex};
+            result += shard.mValues.size();
+        }
+
+        return result;
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    CacheMonitor::CacheStats ConcurrentCache<Key, T, Hash, ShardCount>::getStats() const
+    {
+        CacheMonitor::CacheStats stats;
+        stats.mName = mName;
+        stats.mBudget = mShardBudget * ShardCount;
+
+        for (const auto &shard : mShards)
+        {
+            std::shared_lock<std::shared_mutex> lock{shard.mMutex};
+
+            stats.mEntries += shard.mValues.size();
+            stats.mBytes += shard.mBytes;
+            stats.mHits += shard.mHits;
+            stats.mMisses += shard.mMisses;
+            stats.mEvictions += shard.mEvictions;
+        }
+
+        return stats;
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::resetStats()
+    {
+        for (auto &shard : mShards)
+        {
+            shard.mHits = 0;
+            shard.mMisses = 0;
+            shard.mEvictions = 0;
+        }
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::setBudget(std::size_t bytes)
+    {
+        mShardBudget = (bytes == 0) ? (0) : (std::max<std::size_t>(bytes / ShardCount, 1));
+
+        for (auto &shard : mShards)
+        {
+            std::lock_guard<std::shared_mutex> lock{shard.mMutex};
+            evict(shard);
+        }
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::store(Shard &shard, const Key &key, T value)
+    {
+        const auto size = getEntrySize(key, value);
+
+        shard.mValues.emplace(std::piecewise_construct,
+                              std::forward_as_tuple(key),
+                              std::forward_as_tuple(std::move(value), size, shard.mClock.size()));
+        shard.mClock.emplace_back(key);
+        shard.mBytes += size;
+
+        evict(shard);
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::remove(Shard &shard, typename ValueMap::iterator it)
+    {
+        // swap with the last clock slot, so removal doesn't shift the whole ring
+        const auto index = it->second.mClockIndex;
+        if (index != shard.mClock.size() - 1)
+        {
+            shard.mClock[index] = std::move(shard.mClock.back());
+            shard.mValues.find(shard.mClock[index])->second.mClockIndex = index;
+        }
+
+        shard.mClock.pop_back();
+        if (shard.mClockHand >= shard.mClock.size())
+            shard.mClockHand = 0;
+
+        shard.mBytes -= it->second.mSize;
+        shard.mValues.erase(it);
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    void ConcurrentCache<Key, T, Hash, ShardCount>::evict(Shard &shard)
+    {
+        const std::size_t budget = mShardBudget;
+        if (budget == 0)
+            return;
+
+        while (shard.mBytes > budget && !shard.mClock.empty())
+        {
+            const auto it = shard.mValues.find(shard.mClock[shard.mClockHand]);
+            if (it->second.mReferenced.exchange(false))
+            {
+                shard.mClockHand = (shard.mClockHand + 1) % shard.mClock.size();
+            }
+            else
+            {
+                remove(shard, it);
+                ++shard.mEvictions;
+            }
+        }
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    typename ConcurrentCache<Key, T, Hash, ShardCount>::Shard &ConcurrentCache<Key, T, Hash, ShardCount>::getShard(const Key &key)
+    {
+        return mShards[getShardIndex(key)];
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    const typename ConcurrentCache<Key, T, Hash, ShardCount>::Shard &ConcurrentCache<Key, T, Hash, ShardCount>::getShard(const Key &key) const
+    {
+        return mShards[getShardIndex(key)];
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    std::size_t ConcurrentCache<Key, T, Hash, ShardCount>::getShardIndex(const Key &key)
+    {
+        // identity hashes of ids sharing a stride would pile into few shards - mix them first
+        std::size_t seed = 0;
+        boost::hash_combine(seed, Hash{}(key));
+
+        return seed % ShardCount;
+    }
+
+    template<class Key, class T, class Hash, std::size_t ShardCount>
+    std::size_t ConcurrentCache<Key, T, Hash, ShardCount>::getEntrySize(const Key &key, const T &value) noexcept
+    {
+        // map node with its hash chain link and cached hash, plus the clock slot
+        return sizeof(typename ValueMap::value_type) + 2 * sizeof(void *) + sizeof(Key) +
+               getCacheMemoryUsage(key) + getCacheMemoryUsage(value);
+    }
+}
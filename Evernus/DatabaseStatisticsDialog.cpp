@@ -0,0 +1,165 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QDialogButtonBox>
+#include <QTableWidgetItem>
+#include <QPlainTextEdit>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QPushButton>
+#include <QMessageBox>
+#include <QFileDialog>
+#include <QLabel>
+#include <QFile>
+
+#include "PreparedStatementCache.h"
+#include "QueryProfiler.h"
+
+#include "DatabaseStatisticsDialog.h"
+
+namespace Evernus
+{
+    DatabaseStatisticsDialog::DatabaseStatisticsDialog(QWidget *parent)
+        : QDialog{parent}
+    {
+        auto mainLayout = new QVBoxLayout{this};
+
+        if (!QueryProfiler::isEnabled())
+        {
+            auto disabledLabel = new QLabel{tr("Query statistics collection is disabled. You can enable it in preferences."), this};
+            mainLayout->addWidget(disabledLabel);
+            disabledLabel->setWordWrap(true);
+        }
+
+        auto logLabel = new QLabel{tr("Slow queries are logged to: %1").arg(QueryProfiler::getSlowQueryLogPath()), this};
+        mainLayout->addWidget(logLabel);
+        logLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        mCacheStatsLabel = new QLabel{this};
+        mainLayout->addWidget(mCacheStatsLabel);
+
+        mStatsView = new QTableWidget{this};
+        mainLayout->addWidget(mStatsView, 1);
+        mStatsView->setColumnCount(8);
+        mStatsView->setHorizontalHeaderLabels({
+            tr("Query"), tr("Count"), tr("Rows"), tr("Total [ms]"), tr("Median [ms]"), tr("95% [ms]"), tr("99% [ms]"), tr("Max [ms]")
+        });
+        mStatsView->setSelectionMode(QAbstractItemView::SingleSelection);
+        mStatsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+        mStatsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        mStatsView->setWordWrap(false);
+        mStatsView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+        connect(mStatsView, &QTableWidget::itemSelectionChanged, this, &DatabaseStatisticsDialog::showQueryPlan);
+
+        mainLayout->addWidget(new QLabel{tr("Query plan:"), this});
+
+        mQueryPlanView = new QPlainTextEdit{this};
+        mainLayout->addWidget(mQueryPlanView);
+        mQueryPlanView->setReadOnly(true);
+        mQueryPlanView->setPlaceholderText(tr("Query plans are captured for slow queries."));
+
+        auto buttons = new QDialogButtonBox{QDialogButtonBox::Close, this};
+        mainLayout->addWidget(buttons);
+        connect(buttons, &QDialogButtonBox::rejected, this, &DatabaseStatisticsDialog::reject);
+
+        auto refreshBtn = buttons->addButton(tr("Refresh"), QDialogButtonBox::ActionRole);
+        connect(refreshBtn, &QPushButton::clicked, this, &DatabaseStatisticsDialog::refresh);
+
+        auto resetBtn = buttons->addButton(tr("Reset"), QDialogButtonBox::ResetRole);
+        connect(resetBtn, &QPushButton::clicked, this, &DatabaseStatisticsDialog::reset);
+
+        auto exportBtn = buttons->addButton(tr("Export..."), QDialogButtonBox::ActionRole);
+        connect(exportBtn, &QPushButton::clicked, this, &DatabaseStatisticsDialog::exportJson);
+
+        setWindowTitle(tr("Database statistics"));
+        resize(1000, 600);
+
+        refresh();
+    }
+
+    void DatabaseStatisticsDialog::refresh()
+    {
+        const auto cacheStats = PreparedStatementCache::getStats();
+        mCacheStatsLabel->setText(tr("Prepared statements: %1 cached, %2 hits, %3 misses, %4 evictions")
+            .arg(cacheStats.mStatements)
+            .arg(cacheStats.mHits)
+            .arg(cacheStats.mMisses)
+            .arg(cacheStats.mEvictions));
+
+        const auto stats = QueryProfiler::getStats();
+
+        mStatsView->setSortingEnabled(false);
+        mStatsView->clearContents();
+        mStatsView->setRowCount(static_cast<int>(stats.size()));
+
+        const auto setNumber = [=](int row, int column, auto value) {
+            auto item = new QTableWidgetItem{};
+            item->setData(Qt::DisplayRole, value);
+            mStatsView->setItem(row, column, item);
+        };
+
+        auto row = 0;
+        for (const auto &statement : stats)
+        {
+            auto queryItem = new QTableWidgetItem{statement.mQuery};
+            queryItem->setData(Qt::ToolTipRole, statement.mQuery);
+            queryItem->setData(Qt::UserRole, statement.mQueryPlan);
+            mStatsView->setItem(row, 0, queryItem);
+
+            setNumber(row, 1, statement.mCount);
+            setNumber(row, 2, statement.mRows);
+            setNumber(row, 3, statement.mTotalTime);
+            setNumber(row, 4, statement.mMedianTime);
+            setNumber(row, 5, statement.mP95Time);
+            setNumber(row, 6, statement.mP99Time);
+            setNumber(row, 7, statement.mMaxTime);
+
+            ++row;
+        }
+
+        mStatsView->setSortingEnabled(true);
+        mStatsView->sortByColumn(3, Qt::DescendingOrder);
+    }
+
+    void DatabaseStatisticsDialog::reset()
+    {
+        QueryProfiler::reset();
+        refresh();
+    }
+
+    void DatabaseStatisticsDialog::exportJson()
+    {
+        const auto fileName = QFileDialog::getSaveFileName(this, tr("Export statistics"), QString{}, tr("JSON (*.json)"));
+        if (fileName.isEmpty())
+            return;
+
+        QFile file{fileName};
+        if (!file.open(QIODevice::WriteOnly) || file.write(QueryProfiler::exportJson()) == -1)
+            QMessageBox::warning(this, tr("Error"), tr("Error saving statistics."));
+    }
+
+    void DatabaseStatisticsDialog::showQueryPlan()
+    {
+        const auto row = mStatsView->currentRow();
+        if (row < 0)
+        {
+            mQueryPlanView->clear();
+            return;
+        }
+
+        const auto item = mStatsView->item(row, 0);
+        mQueryPlanView->setPlainText((item != nullptr) ? (item->data(Qt::UserRole).toString()) : (QString{}));
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QDialog>
+
+class QPlainTextEdit;
+class QTableWidget;
+class QLabel;
+
+namespace Evernus
+{
+    class DatabaseStatisticsDialog
+        : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        explicit DatabaseStatisticsDialog(QWidget *parent = nullptr);
+        virtual ~DatabaseStatisticsDialog() = default;
+
+    private slots:
+        void refresh();
+        void reset();
+        void exportJson();
+
+        void showQueryPlan();
+
+    private:
+        QLabel *mCacheStatsLabel = nullptr;
+        QTableWidget *mStatsView = nullptr;
+        QPlainTextEdit *mQueryPlanView = nullptr;
+    };
+}
@@ -13,6 +13,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdexcept>
+#include <chrono>
 
 #include <boost/throw_exception.hpp>
 
@@ -24,6 +25,8 @@
 #include <QtDebug>
 #include <QFile>
 
+#include "QueryProfiler.h"
+
 #include "DatabaseUtils.h"
 
 namespace Evernus::DatabaseUtils
@@ -41,7 +44,13 @@ namespace Evernus::DatabaseUtils
     void execQuery(QSqlQuery &query)
     {
         qDebug() << "SQL:" << query.lastQuery();
-        if (!query.exec())
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto success = query.exec();
+
+        QueryProfiler::recordExecution(query, std::chrono::steady_clock::now() - start);
+
+        if (!success)
         {
             auto error = query.lastError();
             qCritical() << error;
@@ -50,8 +59,40 @@ namespace Evernus::DatabaseUtils
         }
     }
 
+    void beginTransaction(QSqlDatabase &db)
+    {
+        if (!db.transaction())
+        {
+            auto error = db.lastError();
+            qCritical() << error;
+
+            BOOST_THROW_EXCEPTION(std::runtime_error{error.text().toStdString()});
+        }
+    }
+
+    void commitTransaction(QSqlDatabase &db)
+    {
+        if (!db.commit())
+        {
+            auto error = db.lastError();
+            qCritical() << error;
+
+            BOOST_THROW_EXCEPTION(std::runtime_error{error.text().toStdString()});
+        }
+    }
+
+    void checkpointDatabase(const QSqlDatabase &db)
+    {
+        // moves write-ahead log contents to the main db file, so it can be safely copied
+        // no-op when not in WAL mode
+        auto query = db.exec(QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)"));
+        if (query.lastError().isValid())
+            qWarning() << "Error checkpointing DB:" << query.lastError();
+    }
+
     QString backupDatabase(const QSqlDatabase &db)
     {
+        checkpointDatabase(db);
         return backupDatabase(db.databaseName());
     }
 
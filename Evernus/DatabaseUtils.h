@@ -27,6 +27,9 @@ namespace Evernus::DatabaseUtils
     QString getDbPath();
     QString getDbFilePath(const QString &dbName);
     void execQuery(QSqlQuery &query);
+    void beginTransaction(QSqlDatabase &db);
+    void commitTransaction(QSqlDatabase &db);
+    void checkpointDatabase(const QSqlDatabase &db);
     QString backupDatabase(const QSqlDatabase &db);
     QString backupDatabase(const QString &dbPath);
 
@@ -0,0 +1,229 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <exception>
+
+#include <QSqlDatabase>
+#include <QtConcurrent>
+#include <QSqlQuery>
+#include <QtDebug>
+
+#include "StandardExceptionQtWrapperException.h"
+#include "DatabaseConnectionProvider.h"
+#include "DatabaseUtils.h"
+
+#include "DatabaseWriteQueue.h"
+
+namespace Evernus
+{
+    DatabaseWriteQueue::DatabaseWriteQueue(const DatabaseConnectionProvider &connectionProvider)
+        : mConnectionProvider{connectionProvider}
+    {
+        mWriterThread.setMaxThreadCount(1);
+        mWriterThread.setExpiryTimeout(-1);
+    }
+
+    DatabaseWriteQueue::~DatabaseWriteQueue()
+    {
+        waitForDone();
+    }
+
+    QFuture<void> DatabaseWriteQueue::enqueue(Job job, TransactionMode mode)
+    {
+        PendingJob pending{std::move(job), mode, {}};
+        pending.mInterface.reportStarted();
+
+        auto future = pending.mInterface.future();
+
+        std::lock_guard<std::mutex> lock{mQueueMutex};
+        mQueue.emplace_back(std::move(pending));
+
+        if (!mDrainScheduled)
+        {
+            mDrainScheduled = true;
+            QtConcurrent::run(&mWriterThread, [=] {
+                drain();
+            });
+        }
+
+        return future;
+    }
+
+    void DatabaseWriteQueue::waitForDone()
+    {
+        mWriterThread.waitForDone();
+    }
+
+    void DatabaseWriteQueue::drain()
+    {
+        while (true)
+        {
+            std::vector<PendingJob> jobs;
+
+            {
+                std::lock_guard<std::mutex> lock{mQueueMutex};
+                if (mQueue.empty())
+                {
+                    mDrainScheduled = false;
+                    return;
+                }
+
+                jobs.swap(mQueue);
+            }
+
+            qDebug() << "Processing" << jobs.size() << "queued DB writes...";
+
+            std::vector<PendingJob> batch;
+            for (auto &job : jobs)
+            {
+                if (job.mMode == TransactionMode::Standalone)
+                {
+                    runBatch(batch);
+                    batch.clear();
+
+                    runStandalone(job);
+                }
+                else
+                {
+                    batch.emplace_back(std::move(job));
+                    if (batch.size() >= maxJobsPerTransaction)
+                    {
+                        runBatch(batch);
+                        batch.clear();
+                    }
+                }
+            }
+
+            runBatch(batch);
+        }
+    }
+
+    void DatabaseWriteQueue::runBatch(std::vector<PendingJob> &jobs) const
+    {
+        if (jobs.empty())
+            return;
+
+        auto db = mConnectionProvider.getConnection();
+
+        try
+        {
+            DatabaseUtils::beginTransaction(db);
+        }
+        catch (...)
+        {
+            // nothing has run yet, so every job fails the same way
+            const auto error = std::current_exception();
+            for (auto &job : jobs)
+            {
+                job.mInterface.reportException(StandardExceptionQtWrapperException{error});
+                job.mInterface.reportFinished();
+            }
+
+            return;
+        }
+
+        const auto execSavepoint = [&](const QString &sql) {
+            QSqlQuery query{db};
+            query.prepare(sql);
+
+            DatabaseUtils::execQuery(query);
+        };
+
+        std::vector<std::exception_ptr> errors(jobs.size());
+        std::exception_ptr batchError;
+
+        for (auto i = 0u; i < jobs.size(); ++i)
+        {
+            // savepoints let a single failing job roll back without losing the rest of the batch
+            try
+            {
+                execSavepoint(QStringLiteral("SAVEPOINT queued_write"));
+            }
+            catch (...)
+            {
+                // no savepoint means nothing to roll back to - rolling back would undo the whole batch
+                errors[i] = std::current_exception();
+                continue;
+            }
+
+            try
+            {
+                jobs[i].mJob();
+                execSavepoint(QStringLiteral("RELEASE queued_write"));
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+
+                try
+                {
+                    execSavepoint(QStringLiteral("ROLLBACK TO queued_write"));
+                    execSavepoint(QStringLiteral("RELEASE queued_write"));
+                }
+                catch (...)
+                {
+                    // partial changes of the failed job can't be undone alone
+                    batchError = std::current_exception();
+                    break;
+                }
+            }
+        }
+
+        // report only after commit, so finished callbacks see the data
+        if (!batchError)
+        {
+            try
+            {
+                DatabaseUtils::commitTransaction(db);
+            }
+            catch (...)
+            {
+                batchError = std::current_exception();
+            }
+        }
+
+        if (batchError)
+        {
+            db.rollback();
+
+            for (auto &error : errors)
+            {
+                if (!error)
+                    error = batchError;
+            }
+        }
+
+        for (auto i = 0u; i < jobs.size(); ++i)
+        {
+            if (errors[i])
+                jobs[i].mInterface.reportException(StandardExceptionQtWrapperException{errors[i]});
+
+            jobs[i].mInterface.reportFinished();
+        }
+    }
+
+    void DatabaseWriteQueue::runStandalone(PendingJob &job) const
+    {
+        try
+        {
+            job.mJob();
+        }
+        catch (...)
+        {
+            job.mInterface.reportException(StandardExceptionQtWrapperException{std::current_exception()});
+        }
+
+        job.mInterface.reportFinished();
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <mutex>
+
+#include <QFutureInterface>
+#include <QThreadPool>
+#include <QFuture>
+
+namespace Evernus
+{
+    class DatabaseConnectionProvider;
+
+    // serializes all background writes on a single thread with its own connection
+    // consecutive batched jobs are merged into one transaction
+    class DatabaseWriteQueue final
+    {
+    public:
+        enum class TransactionMode
+        {
+            // job runs inside a transaction managed by the queue and must not begin/commit its own
+            Batched,
+            // job runs on its own and may manage transactions itself
+            Standalone
+        };
+
+        using Job = std::function<void ()>;
+
+        explicit DatabaseWriteQueue(const DatabaseConnectionProvider &connectionProvider);
+        DatabaseWriteQueue(const DatabaseWriteQueue &) = delete;
+        DatabaseWriteQueue(DatabaseWriteQueue &&) = delete;
+        ~DatabaseWriteQueue();
+
+        QFuture<void> enqueue(Job job, TransactionMode mode = TransactionMode::Batched);
+
+        void waitForDone();
+
+        DatabaseWriteQueue &operator =(const DatabaseWriteQueue &) = delete;
+        DatabaseWriteQueue &operator =(DatabaseWriteQueue &&) = delete;
+
+    private:
+        struct PendingJob
+        {
+            Job mJob;
+            TransactionMode mMode;
+            QFutureInterface<void> mInterface;
+        };
+
+        static const auto maxJobsPerTransaction = 64u;
+
+        const DatabaseConnectionProvider &mConnectionProvider;
+
+        QThreadPool mWriterThread;
+
+        std::mutex mQueueMutex;
+        std::vector<PendingJob> mQueue;
+        bool mDrainScheduled = false;
+
+        void drain();
+        void runBatch(std::vector<PendingJob> &jobs) const;
+        void runStandalone(PendingJob &job) const;
+    };
+}
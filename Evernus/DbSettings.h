@@ -21,7 +21,13 @@ namespace Evernus
     namespace DbSettings
     {
         const auto synchronousDefault = 0;
+        const auto walModeDefault = true;
+        const auto profileQueriesDefault = false;
+        const auto slowQueryThresholdDefault = 200;
 
         const auto synchronousKey = QStringLiteral("db/synchronous");
+        const auto walModeKey = QStringLiteral("db/walMode");
+        const auto profileQueriesKey = QStringLiteral("db/profileQueries");
+        const auto slowQueryThresholdKey = QStringLiteral("db/slowQueryThreshold");
     }
 }
@@ -18,9 +18,10 @@ namespace Evernus
 {
     ESIExternalOrderImporter::ESIExternalOrderImporter(const EveDataProvider &dataProvider,
                                                        ESIInterfaceManager &interfaceManager,
+                                                       ESIRequestPriority priority,
                                                        QObject *parent)
         : CallbackExternalOrderImporter{parent}
-        , mManager{dataProvider, interfaceManager}
+        , mManager{dataProvider, interfaceManager, priority}
     {
     }
 }
@@ -32,6 +32,7 @@ namespace Evernus
     public:
         ESIExternalOrderImporter(const EveDataProvider &dataProvider,
                                  ESIInterfaceManager &interfaceManager,
+                                 ESIRequestPriority priority,
                                  QObject *parent = nullptr);
         ESIExternalOrderImporter(const ESIExternalOrderImporter &) = default;
         ESIExternalOrderImporter(ESIExternalOrderImporter &&) = default;
@@ -0,0 +1,101 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QStringList>
+#include <QSaveFile>
+#include <QUrlQuery>
+#include <QtDebug>
+#include <QFile>
+#include <QUrl>
+
+#include "ESIFixtureStore.h"
+
+namespace Evernus
+{
+    const quint32 ESIFixtureStore::formatVersion;
+
+    ESIFixtureStore::ESIFixtureStore(const QString &path)
+        : mDirectory{path}
+    {
+        if (!mDirectory.mkpath(QStringLiteral(".")))
+            qWarning() << "Cannot create ESI fixture directory:" << path;
+    }
+
+    bool ESIFixtureStore::find(const QUrl &url, Fixture &fixture) const
+    {
+        const auto key = getKey(url);
+
+        QFile file{getFilePath(key)};
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        QDataStream stream{&file};
+
+        quint32 version = 0;
+        QString storedKey;
+        QByteArray data;
+
+        stream >> version >> storedKey >> fixture.mPages >> fixture.mETag >> data;
+        if (stream.status() != QDataStream::Ok || version != formatVersion || storedKey != key)
+        {
+            qWarning() << "Invalid ESI fixture:" << file.fileName();
+            return false;
+        }
+
+        fixture.mData = qUncompress(data);
+        return true;
+    }
+
+    void ESIFixtureStore::store(const QUrl &url, const Fixture &fixture) const
+    {
+        const auto key = getKey(url);
+
+        QSaveFile file{getFilePath(key)};
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qWarning() << "Cannot write ESI fixture:" << file.fileName();
+            return;
+        }
+
+        QDataStream stream{&file};
+        stream << formatVersion << key << fixture.mPages << fixture.mETag << qCompress(fixture.mData);
+
+        if (stream.status() != QDataStream::Ok || !file.commit())
+            qWarning() << "Cannot write ESI fixture:" << file.fileName();
+        else
+            qDebug() << "Recorded ESI fixture:" << key;
+    }
+
+    QString ESIFixtureStore::getKey(const QUrl &url)
+    {
+        QStringList query;
+
+        const auto items = QUrlQuery{url}.queryItems(QUrl::FullyDecoded);
+        for (const auto &item : items)
+            query << QStringLiteral("%1=%2").arg(item.first).arg(item.second);
+
+        std::sort(std::begin(query), std::end(query));
+
+        return QStringLiteral("%1?%2").arg(url.path()).arg(query.join('&'));
+    }
+
+    QString ESIFixtureStore::getFilePath(const QString &key) const
+    {
+        return mDirectory.filePath(QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex()));
+    }
+}
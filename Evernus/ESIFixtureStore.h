@@ -0,0 +1,57 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QDir>
+
+class QUrl;
+
+namespace Evernus
+{
+    // recorded ESI replies, for serving them later without the live API
+    // fixtures are keyed by request path and sorted query, so they don't depend on the host
+    class ESIFixtureStore final
+    {
+    public:
+        struct Fixture
+        {
+            QByteArray mData;
+            QByteArray mETag;
+            uint mPages = 0;
+        };
+
+        explicit ESIFixtureStore(const QString &path);
+        ESIFixtureStore(const ESIFixtureStore &) = default;
+        ESIFixtureStore(ESIFixtureStore &&) = default;
+        ~ESIFixtureStore() = default;
+
+        bool find(const QUrl &url, Fixture &fixture) const;
+        void store(const QUrl &url, const Fixture &fixture) const;
+
+        ESIFixtureStore &operator =(const ESIFixtureStore &) = default;
+        ESIFixtureStore &operator =(ESIFixtureStore &&) = default;
+
+        static QString getKey(const QUrl &url);
+
+    private:
+        static const quint32 formatVersion = 1;
+
+        QDir mDirectory;
+
+        QString getFilePath(const QString &key) const;
+    };
+}
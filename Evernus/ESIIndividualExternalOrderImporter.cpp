@@ -30,7 +30,7 @@ namespace Evernus
     ::ESIIndividualExternalOrderImporter(const EveDataProvider &dataProvider,
                                          ESIInterfaceManager &interfaceManager,
                                          QObject *parent)
-        : ESIExternalOrderImporter{dataProvider, interfaceManager, parent}
+        : ESIExternalOrderImporter{dataProvider, interfaceManager, ESIRequestPriority::ForegroundImport, parent}
         , mDataProvider{dataProvider}
     {
     }
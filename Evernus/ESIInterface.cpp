@@ -12,11 +12,14 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <type_traits>
 #include <algorithm>
+#include <deque>
 
 #include <QtDebug>
 
 #include <QCoreApplication>
+#include <QtConcurrent>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonDocument>
@@ -30,6 +33,7 @@
 #include "ESIInterfaceErrorLimiter.h"
 #include "CitadelAccessCache.h"
 #include "NetworkSettings.h"
+#include "ESIFixtureStore.h"
 #include "CallbackEvent.h"
 #include "ReplyTimeout.h"
 #include "ESIOAuth.h"
@@ -44,6 +48,87 @@ namespace Evernus
         uint mFetchedPages = 0;
     };
 
+    // feeds reply data to a page decoder on the thread pool, keeping the order of chunks
+    class ESIInterface::StreamingDecoder final
+        : public std::enable_shared_from_this<StreamingDecoder>
+    {
+    public:
+        explicit StreamingDecoder(std::shared_ptr<PageDecoder> decoder)
+            : mDecoder{std::move(decoder)}
+        {
+            Q_ASSERT(mDecoder);
+        }
+
+        StreamingDecoder(const StreamingDecoder &) = delete;
+        StreamingDecoder(StreamingDecoder &&) = delete;
+        ~StreamingDecoder() = default;
+
+        void feed(QByteArray chunk)
+        {
+            if (!chunk.isEmpty())
+                enqueue([=, chunk = std::move(chunk)] { mDecoder->feed(chunk); });
+        }
+
+        // callback gets called on a worker thread
+        template<class T>
+        void finish(T callback)
+        {
+            enqueue([=] { callback(mDecoder->finish()); });
+        }
+
+        std::shared_ptr<PageDecoder> getDecoder() const
+        {
+            return mDecoder;
+        }
+
+        StreamingDecoder &operator =(const StreamingDecoder &) = delete;
+        StreamingDecoder &operator =(StreamingDecoder &&) = delete;
+
+    private:
+        std::shared_ptr<PageDecoder> mDecoder;
+
+        std::mutex mTaskMutex;
+        std::deque<std::function<void ()>> mTasks;
+        bool mRunning = false;
+
+        void enqueue(std::function<void ()> task)
+        {
+            std::lock_guard<std::mutex> lock{mTaskMutex};
+            mTasks.emplace_back(std::move(task));
+
+            // only one drain at a time, so the decoder sees chunks in order
+            if (!mRunning)
+            {
+                mRunning = true;
+                QtConcurrent::run([self = shared_from_this()] {
+                    self->drain();
+                });
+            }
+        }
+
+        void drain()
+        {
+            while (true)
+            {
+                std::function<void ()> task;
+
+                {
+                    std::lock_guard<std::mutex> lock{mTaskMutex};
+                    if (mTasks.empty())
+                    {
+                        mRunning = false;
+                        return;
+                    }
+
+                    task = std::move(mTasks.front());
+                    mTasks.pop_front();
+                }
+
+                task();
+            }
+        }
+    };
+
     ESIInterface::ErrorInfo::operator QString() const
     {
         return QStringLiteral("%1 (SSO: %2)").arg(mMessage).arg(mSSOStatus);
@@ -58,6 +143,12 @@ namespace Evernus
             callback(QJsonDocument::fromJson(data), QString{}, getExpireTime(reply));
         }
 
+        template<class T>
+        static inline void invoke(const ESIResponseCache::Response &response, const T &callback)
+        {
+            callback(QJsonDocument::fromJson(response.mData), QString{}, response.mExpires);
+        }
+
         template<class T>
         static inline void invoke(const QString &error, const QNetworkReply &reply, const T &callback)
         {
@@ -80,6 +171,12 @@ namespace Evernus
             callback(QJsonDocument::fromJson(data), QString{}, getExpireTime(reply), getPageCount(reply));
         }
 
+        template<class T>
+        static inline void invoke(const ESIResponseCache::Response &response, const T &callback)
+        {
+            callback(QJsonDocument::fromJson(response.mData), QString{}, response.mExpires, response.mPages);
+        }
+
         template<class T>
         static inline void invoke(const QString &error, const QNetworkReply &reply, const T &callback)
         {
@@ -93,6 +190,44 @@ namespace Evernus
         }
     };
 
+    template<>
+    struct ESIInterface::TaggedInvoke<ESIInterface::ConditionalPaginatedJsonTag>
+    {
+        // the reply is gone by the time decoding is done, so grab what's needed now
+        template<class T>
+        static inline auto bind(const QNetworkReply &reply, const T &callback)
+        {
+            return bind(reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == notModifiedCode,
+                        reply.rawHeader(QByteArrayLiteral("ETag")),
+                        getExpireTime(reply),
+                        getPageCount(reply),
+                        callback);
+        }
+
+        template<class T>
+        static inline auto bind(bool notModified, const QByteArray &eTag, const QDateTime &expires, uint pages, const T &callback)
+        {
+            return [=](std::shared_ptr<PageDecoder> decoder, const QString &error) {
+                if (Q_UNLIKELY(!error.isEmpty()))
+                    callback(std::shared_ptr<PageDecoder>{}, false, QByteArray{}, error, expires, pages);
+                else
+                    callback(std::move(decoder), notModified, eTag, QString{}, expires, pages);
+            };
+        }
+
+        template<class T>
+        static inline void invoke(const QString &error, const QNetworkReply &reply, const T &callback)
+        {
+            callback(std::shared_ptr<PageDecoder>{}, false, QByteArray{}, error, getExpireTime(reply), getPageCount(reply));
+        }
+
+        template<class T>
+        static inline void invoke(const QString &error, const T &callback)
+        {
+            callback(std::shared_ptr<PageDecoder>{}, false, QByteArray{}, error, QDateTime{}, 1u);
+        }
+    };
+
     template<>
     struct ESIInterface::TaggedInvoke<ESIInterface::StringTag>
     {
@@ -102,6 +237,12 @@ namespace Evernus
             callback(QString::fromUtf8(data), QString{}, getExpireTime(reply));
         }
 
+        template<class T>
+        static inline void invoke(const ESIResponseCache::Response &response, const T &callback)
+        {
+            callback(QString::fromUtf8(response.mData), QString{}, response.mExpires);
+        }
+
         template<class T>
         static inline void invoke(const QString &error, const QNetworkReply &reply, const T &callback)
         {
@@ -117,27 +258,57 @@ namespace Evernus
 
     ESIInterface::ESIInterface(CitadelAccessCache &citadelAccessCache,
                                ESIInterfaceErrorLimiter &errorLimiter,
+                               ESIResponseCache &responseCache,
+                               ExternalOrderPageValidatorCache &pageValidators,
                                ESIOAuth &oauth,
+                               ESIRequestPriority priority,
                                QObject *parent)
         : QObject{parent}
         , mCitadelAccessCache{citadelAccessCache}
         , mErrorLimiter{errorLimiter}
+        , mResponseCache{responseCache}
+        , mPageValidators{pageValidators}
         , mOAuth{oauth}
+        , mPriority{priority}
     {
         QSettings settings;
         mLogReplies = settings.value(NetworkSettings::logESIRepliesKey, mLogReplies).toBool();
     }
 
-    void ESIInterface::fetchMarketOrders(uint regionId, EveType::IdType typeId, const PaginatedCallback &callback) const
+    void ESIInterface::setFixtureRecorder(const ESIFixtureStore *recorder) noexcept
+    {
+        mFixtureRecorder = recorder;
+    }
+
+    void ESIInterface::fetchMarketOrders(uint regionId,
+                                         EveType::IdType typeId,
+                                         const PageCachedCallback &isPageCached,
+                                         const PageDecoderFactory &decoderFactory,
+                                         const ConditionalPaginatedCallback &callback) const
     {
         qDebug() << "Fetching market orders for" << regionId << "and" << typeId;
-        fetchPaginatedData(QStringLiteral("/v1/markets/%1/orders/").arg(regionId), { { QStringLiteral("type_id"), typeId } }, 1, callback, std::make_shared<PaginatedContext>());
+        fetchConditionalPaginatedData(QStringLiteral("/v1/markets/%1/orders/").arg(regionId),
+                                      { { QStringLiteral("type_id"), typeId } },
+                                      1,
+                                      isPageCached,
+                                      decoderFactory,
+                                      callback,
+                                      std::make_shared<PaginatedContext>());
     }
 
-    void ESIInterface::fetchMarketOrders(uint regionId, const PaginatedCallback &callback) const
+    void ESIInterface::fetchMarketOrders(uint regionId,
+                                         const PageCachedCallback &isPageCached,
+                                         const PageDecoderFactory &decoderFactory,
+                                         const ConditionalPaginatedCallback &callback) const
     {
         qDebug() << "Fetching whole market for" << regionId;
-        fetchPaginatedData(QStringLiteral("/v1/markets/%1/orders/").arg(regionId), {}, 1, callback, std::make_shared<PaginatedContext>());
+        fetchConditionalPaginatedData(QStringLiteral("/v1/markets/%1/orders/").arg(regionId),
+                                      {},
+                                      1,
+                                      isPageCached,
+                                      decoderFactory,
+                                      callback,
+                                      std::make_shared<PaginatedContext>());
     }
 
     void ESIInterface::fetchMarketHistory(uint regionId, EveType::IdType typeId, const JsonCallback &callback) const
@@ -591,8 +762,7 @@ namespace Evernus
             }
             else
             {
-                const auto array = response.array();
-                if (array.isEmpty())
+                if (isEmptyPage(response))
                 {
                     continuation(std::move(response), true, QString{}, expires);
                 }
@@ -621,6 +791,59 @@ namespace Evernus
         get<decltype(callback), PaginatedJsonTag>(url, parameters, callback, getNumRetries());
     }
 
+    template<class T>
+    void ESIInterface::fetchConditionalPaginatedData(const QString &url,
+                                                     QVariantMap parameters,
+                                                     uint page,
+                                                     const PageCachedCallback &isPageCached,
+                                                     const PageDecoderFactory &decoderFactory,
+                                                     T &&continuation,
+                                                     const std::shared_ptr<PaginatedContext> &context) const
+    {
+        runNowOrLater([=, parameters = std::move(parameters)]() mutable {
+            const auto callback = createPaginatedCallback(
+                page,
+                continuation,
+                [=](auto nextPage) {
+                    fetchConditionalPaginatedData(url, parameters, nextPage, isPageCached, decoderFactory, continuation, context);
+                },
+                context
+            );
+
+            parameters[QStringLiteral("page")] = page;
+
+            const auto key = getPageKey(url, parameters);
+
+            QByteArray eTag;
+            ExternalOrderPageValidator validator;
+            if (mPageValidators.find(key, validator) && validator.mPages > 0 && isPageCached(key))
+                eTag = validator.mETag;
+
+            const auto validatingCallback = [=](auto &&decoder, auto notModified, const auto &newETag, const auto &error, const auto &expires, auto pages) {
+                if (Q_UNLIKELY(!error.isEmpty()))
+                {
+                    callback(ConditionalPage{}, error, expires, pages);
+                    return;
+                }
+
+                if (notModified)
+                {
+                    qDebug() << "Page not modified:" << key;
+                    // the validator might have been replaced by a concurrent fetch, but the page count is still ours
+                    pages = validator.mPages;
+                }
+                else if (!newETag.isEmpty())
+                {
+                    mPageValidators.insert(key, { newETag, pages });
+                }
+
+                callback(ConditionalPage{std::move(decoder), key, notModified}, QString{}, expires, pages);
+            };
+
+            get<decltype(validatingCallback), ConditionalPaginatedJsonTag>(url, parameters, validatingCallback, getNumRetries(), eTag, decoderFactory);
+        });
+    }
+
     template<class T>
     void ESIInterface::fetchPaginatedData(Character::IdType charId,
                                           const QString &url,
@@ -651,53 +874,219 @@ namespace Evernus
     }
 
     template<class T, class ResultTag>
-    void ESIInterface::get(const QString &url, const QVariantMap &parameters, const T &continuation, uint retries) const
+    void ESIInterface::get(const QString &url,
+                           const QVariantMap &parameters,
+                           const T &continuation,
+                           uint retries,
+                           const QByteArray &eTag,
+                           const PageDecoderFactory &decoderFactory) const
     {
         runNowOrLater([=] {
-            auto reply = mOAuth.get(ESIUrls::esiUrl + url, parameters);
-            Q_ASSERT(reply != nullptr);
+            const auto key = getPageKey(url, parameters);
 
-            qDebug() << "ESI request:" << reply << "" << url << ":" << parameters;
-            qDebug() << "Retries" << retries;
+            // recording needs everything to come from the network
+            const auto recording = mFixtureRecorder.load() != nullptr;
+
+            ESIResponseCache::Response cached;
+            if (!recording && mResponseCache.find(key, cached))
+            {
+                qDebug() << "Cached ESI response:" << key << "expires" << cached.mExpires;
+
+                if constexpr (std::is_same_v<ResultTag, ConditionalPaginatedJsonTag>)
+                {
+                    // the caller still has the page decoded, no need to do it again
+                    const auto notModified = !eTag.isEmpty() && eTag == cached.mETag;
+                    const auto invoke = TaggedInvoke<ResultTag>::bind(notModified, cached.mETag, cached.mExpires, cached.mPages, continuation);
+
+                    if (notModified)
+                    {
+                        invoke(std::shared_ptr<PageDecoder>{}, QString{});
+                        return;
+                    }
+
+                    Q_ASSERT(decoderFactory);
+
+                    // the page is stored decoded - read and load it on a worker
+                    const std::shared_ptr<PageDecoder> decoder = decoderFactory();
+                    QtConcurrent::run([=] {
+                        QByteArray data;
+                        const auto hit = mResponseCache.read(key, data) && decoder->load(data);
+
+                        runNowOrLater([=] {
+                            if (hit)
+                            {
+                                invoke(decoder, QString{});
+                            }
+                            else
+                            {
+                                schedule([=] {
+                                    sendGet<T, ResultTag>(url, parameters, continuation, retries, eTag, decoderFactory);
+                                });
+                            }
+                        });
+                    });
+                }
+                else
+                {
+                    readCachedResponse(key, cached, [=](bool hit, const auto &response) {
+                        if (hit)
+                        {
+                            TaggedInvoke<ResultTag>::invoke(response, continuation);
+                        }
+                        else
+                        {
+                            schedule([=] {
+                                sendGet<T, ResultTag>(url, parameters, continuation, retries, eTag, decoderFactory);
+                            });
+                        }
+                    });
+                }
+
+                return;
+            }
 
-            new ReplyTimeout{*reply};
+            schedule([=] {
+                sendGet<T, ResultTag>(url, parameters, continuation, retries, eTag, decoderFactory);
+            });
+        });
+    }
 
-            connect(reply, &QNetworkReply::finished, this, [=] {
-                reply->deleteLater();
+    template<class T, class ResultTag>
+    void ESIInterface::sendGet(const QString &url,
+                               const QVariantMap &parameters,
+                               const T &continuation,
+                               uint retries,
+                               const QByteArray &eTag,
+                               const PageDecoderFactory &decoderFactory) const
+    {
+        const auto key = getPageKey(url, parameters);
+        const auto recording = mFixtureRecorder.load() != nullptr;
 
-                showReplyDebugInfo(*reply);
+        // the caller's validator takes precedence - otherwise try to revalidate our own copy, which survives restarts
+        auto requestETag = eTag;
+        if (requestETag.isEmpty() && !recording)
+            requestETag = mResponseCache.getETag(key);
 
-                const auto error = reply->error();
-                if (Q_UNLIKELY(error != QNetworkReply::NoError))
+        auto reply = mOAuth.get(ESIUrls::getESIUrl() + url, parameters, (recording) ? (QByteArray{}) : (requestETag));
+        Q_ASSERT(reply != nullptr);
+
+        qDebug() << "ESI request:" << reply << "" << url << ":" << parameters;
+        qDebug() << "Retries" << retries;
+
+        new ReplyTimeout{*reply};
+
+        std::shared_ptr<StreamingDecoder> streamer;
+        // raw body is only needed for fixtures - the cache gets the decoded page
+        std::shared_ptr<QByteArray> body;
+
+        if constexpr (std::is_same_v<ResultTag, ConditionalPaginatedJsonTag>)
+        {
+            Q_ASSERT(decoderFactory);
+            streamer = std::make_shared<StreamingDecoder>(decoderFactory());
+
+            if (recording)
+                body = std::make_shared<QByteArray>();
+
+            // decode while downloading, leaving error bodies for getError()
+            connect(reply, &QNetworkReply::readyRead, this, [=] {
+                if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == okCode)
                 {
-                    const auto httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-                    const auto errorInfo = getError(url, parameters, *reply);
+                    const auto chunk = reply->readAll();
+                    streamer->feed(chunk);
+
+                    if (body)
+                        body->append(chunk);
+                }
+            });
+        }
+
+        connect(reply, &QNetworkReply::finished, this, [=] {
+            reply->deleteLater();
+            mErrorLimiter.finish(*reply);
+
+            showReplyDebugInfo(*reply);
+
+            const auto error = reply->error();
+            if (Q_UNLIKELY(error != QNetworkReply::NoError))
+            {
+                const auto httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                const auto errorInfo = getError(url, parameters, *reply);
 
-                    qWarning() << "Error for request" << reply << ":" << url << parameters << ":" << httpStatus << errorInfo;
+                qWarning() << "Error for request" << reply << ":" << url << parameters << ":" << httpStatus << errorInfo;
 
-                    if (shouldThrottle(httpStatus))  // error limit reached?
+                if (shouldThrottle(httpStatus))  // error limit reached?
+                {
+                    schedulePostErrorLimitRequest([=] {
+                        sendGet<T, ResultTag>(url, parameters, continuation, retries, eTag, decoderFactory);
+                    }, *reply);
+                }
+                else
+                {
+                    if (retries > 0)
                     {
-                        schedulePostErrorLimitRequest([=] {
-                            get<T, ResultTag>(url, parameters, continuation, retries);
-                        }, *reply);
+                        mErrorLimiter.retry([=] {
+                            sendGet<T, ResultTag>(url, parameters, continuation, retries - 1, eTag, decoderFactory);
+                        }, mPriority, getRetryAttempt(retries));
                     }
                     else
                     {
-                        if (retries > 0)
-                            get<T, ResultTag>(url, parameters, continuation, retries - 1);
-                        else
-                            TaggedInvoke<ResultTag>::invoke(errorInfo, *reply, continuation);
+                        TaggedInvoke<ResultTag>::invoke(errorInfo, *reply, continuation);
                     }
                 }
+            }
+            else if (eTag.isEmpty() && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == notModifiedCode)
+            {
+                // our cached copy is still good - serve it from the cache like any other hit
+                const auto expires = getExpireTime(*reply);
+                if (expires.isValid() && expires > QDateTime::currentDateTimeUtc())
+                {
+                    mResponseCache.refresh(key, expires);
+                    get<T, ResultTag>(url, parameters, continuation, retries, eTag, decoderFactory);
+                }
+                else
+                {
+                    // can't keep it, so ask for the body
+                    mResponseCache.erase(key);
+                    schedule([=] {
+                        sendGet<T, ResultTag>(url, parameters, continuation, retries, eTag, decoderFactory);
+                    });
+                }
+            }
+            else if constexpr (std::is_same_v<ResultTag, ConditionalPaginatedJsonTag>)
+            {
+                const auto invoke = TaggedInvoke<ResultTag>::bind(*reply, continuation);
+                if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == notModifiedCode)
+                {
+                    mResponseCache.refresh(key, getExpireTime(*reply));
+                    invoke(std::shared_ptr<PageDecoder>{}, QString{});
+                }
                 else
                 {
-                    const auto data = reply->readAll();
                     if (mLogReplies)
-                        qDebug() << reply << data;
+                        qDebug() << reply << "streamed to decoder";
+
+                    const auto rest = reply->readAll();
+                    streamer->feed(rest);
+
+                    if (body)
+                    {
+                        body->append(rest);
+                        recordFixture(*reply, *body);
+                    }
 
-                    TaggedInvoke<ResultTag>::invoke(data, *reply, continuation);
+                    finishDecoding(streamer, key, getCacheableResponse(QByteArray{}, *reply), invoke);
                 }
-            });
+            }
+            else
+            {
+                const auto data = reply->readAll();
+                if (mLogReplies)
+                    qDebug() << reply << data;
+
+                recordFixture(*reply, data);
+                cacheResponse(key, getCacheableResponse(data, *reply));
+                TaggedInvoke<ResultTag>::invoke(data, *reply, continuation);
+            }
         });
     }
 
@@ -710,162 +1099,197 @@ namespace Evernus
                            bool importingCitadels,
                            quint64 citadelId) const
     {
-        runNowOrLater([=] {
-            mOAuth.get(charId, ESIUrls::esiUrl + url, parameters, [=](auto &reply) {
-                qDebug() << "ESI request:" << url << ":" << parameters;
-                qDebug() << "Retries" << retries;
+        schedule([=] {
+            sendGet<T, ResultTag>(charId, url, parameters, continuation, retries, importingCitadels, citadelId);
+        });
+    }
 
-                showReplyDebugInfo(reply);
+    template<class T, class ResultTag>
+    void ESIInterface::sendGet(Character::IdType charId,
+                               const QString &url,
+                               const QVariantMap &parameters,
+                               const T &continuation,
+                               uint retries,
+                               bool importingCitadels,
+                               quint64 citadelId) const
+    {
+        // never send bearer tokens to a stand-in server
+        mOAuth.get(charId, ESIUrls::defaultESIUrl + url, parameters, [=](auto &reply) {
+            mErrorLimiter.finish(reply);
 
-                const auto error = reply.error();
-                if (Q_UNLIKELY(error != QNetworkReply::NoError))
-                {
-                    const auto httpStatus = reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-                    const auto parsedError = getError(url, parameters, reply);
+            qDebug() << "ESI request:" << url << ":" << parameters;
+            qDebug() << "Retries" << retries;
 
-                    qWarning() << "Error for request:" << httpStatus << parsedError;
+            showReplyDebugInfo(reply);
 
-                    if (shouldThrottle(httpStatus))  // error limit reached?
-                    {
-                        schedulePostErrorLimitRequest([=] {
-                            get<T, ResultTag>(charId, url, parameters, continuation, retries, importingCitadels, citadelId);
-                        }, reply);
-                    }
-                    else
+            const auto error = reply.error();
+            if (Q_UNLIKELY(error != QNetworkReply::NoError))
+            {
+                const auto httpStatus = reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                const auto parsedError = getError(url, parameters, reply);
+
+                qWarning() << "Error for request:" << httpStatus << parsedError;
+
+                if (shouldThrottle(httpStatus))  // error limit reached?
+                {
+                    schedulePostErrorLimitRequest([=] {
+                        sendGet<T, ResultTag>(charId, url, parameters, continuation, retries, importingCitadels, citadelId);
+                    }, reply);
+                }
+                else
+                {
+                    if (error == QNetworkReply::ContentAccessDenied)
                     {
-                        if (error == QNetworkReply::ContentAccessDenied)
+                        if (importingCitadels && parsedError.mSSOStatus == 0)
                         {
-                            if (importingCitadels && parsedError.mSSOStatus == 0)
-                            {
-                                if (citadelId != 0)
-                                {
-                                    qDebug() << "Blacklisting citadel:" << citadelId << charId;
-                                    mCitadelAccessCache.blacklist(charId, citadelId);
-                                }
-
-                                TaggedInvoke<ResultTag>::invoke(QString{}, reply, continuation);
-                            }
-                            else
+                            if (citadelId != 0)
                             {
-                                TaggedInvoke<ResultTag>::invoke(parsedError, reply, continuation);
+                                qDebug() << "Blacklisting citadel:" << citadelId << charId;
+                                mCitadelAccessCache.blacklist(charId, citadelId);
                             }
-                        }
-                        else if (retries > 0)
-                        {
-                            get<T, ResultTag>(charId, url, parameters, continuation, retries - 1, importingCitadels, citadelId);
+
+                            TaggedInvoke<ResultTag>::invoke(QString{}, reply, continuation);
                         }
                         else
                         {
                             TaggedInvoke<ResultTag>::invoke(parsedError, reply, continuation);
                         }
                     }
+                    else if (retries > 0)
+                    {
+                        mErrorLimiter.retry([=] {
+                            sendGet<T, ResultTag>(charId, url, parameters, continuation, retries - 1, importingCitadels, citadelId);
+                        }, mPriority, getRetryAttempt(retries));
+                    }
+                    else
+                    {
+                        TaggedInvoke<ResultTag>::invoke(parsedError, reply, continuation);
+                    }
                 }
-                else
-                {
-                    const auto data = reply.readAll();
-                    if (mLogReplies)
-                        qDebug() << url << data;
+            }
+            else
+            {
+                const auto data = reply.readAll();
+                if (mLogReplies)
+                    qDebug() << url << data;
 
-                    TaggedInvoke<ResultTag>::invoke(data, reply, continuation);
-                }
-            }, [=](const auto &error) {
-                TaggedInvoke<ResultTag>::invoke(error, continuation);
-            });
+                TaggedInvoke<ResultTag>::invoke(data, reply, continuation);
+            }
+        }, [=](const auto &error) {
+            mErrorLimiter.finish();
+            TaggedInvoke<ResultTag>::invoke(error, continuation);
         });
     }
 
     template<class T>
     void ESIInterface::post(Character::IdType charId, const QString &url, const QVariant &data, T &&errorCallback) const
     {
-        runNowOrLater([=] {
-            mOAuth.post(charId, ESIUrls::esiUrl + url, data, [=](auto &reply) {
-                qDebug() << "ESI request:" << url << ":" << data;
+        schedule([=] {
+            sendPost(charId, url, data, errorCallback);
+        });
+    }
 
-                showReplyDebugInfo(reply);
+    template<class T>
+    void ESIInterface::sendPost(Character::IdType charId, const QString &url, const QVariant &data, T errorCallback) const
+    {
+        // never send bearer tokens to a stand-in server
+        mOAuth.post(charId, ESIUrls::defaultESIUrl + url, data, [=](auto &reply) {
+            mErrorLimiter.finish(reply);
 
-                const auto error = reply.error();
-                if (Q_UNLIKELY(error != QNetworkReply::NoError))
-                {
-                    const auto httpStatus = reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-                    const auto parsedError = getError(url, {}, reply);
+            qDebug() << "ESI request:" << url << ":" << data;
 
-                    qWarning() << "Error for request:" << httpStatus << parsedError;
+            showReplyDebugInfo(reply);
 
-                    if (shouldThrottle(httpStatus))  // error limit reached?
-                    {
-                        schedulePostErrorLimitRequest([=] {
-                            post(charId, url, data, std::move(errorCallback));
-                        }, reply);
-                    }
-                    else
-                    {
-                        errorCallback(parsedError);
-                    }
+            const auto error = reply.error();
+            if (Q_UNLIKELY(error != QNetworkReply::NoError))
+            {
+                const auto httpStatus = reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                const auto parsedError = getError(url, {}, reply);
+
+                qWarning() << "Error for request:" << httpStatus << parsedError;
+
+                if (shouldThrottle(httpStatus))  // error limit reached?
+                {
+                    schedulePostErrorLimitRequest([=] {
+                        sendPost(charId, url, data, errorCallback);
+                    }, reply);
                 }
                 else
                 {
-                    const auto data = reply.readAll();
-                    if (mLogReplies)
-                        qDebug() << url << data;
-
-                    const auto error = getError(data);
-                    if (!error.mMessage.isEmpty())
-                        errorCallback(error);
+                    errorCallback(parsedError);
                 }
-            }, [=](const auto &error) {
-                errorCallback(error);
-            });
+            }
+            else
+            {
+                const auto data = reply.readAll();
+                if (mLogReplies)
+                    qDebug() << url << data;
+
+                const auto error = getError(data);
+                if (!error.mMessage.isEmpty())
+                    errorCallback(error);
+            }
+        }, [=](const auto &error) {
+            mErrorLimiter.finish();
+            errorCallback(error);
         });
     }
 
     template<class T>
     void ESIInterface::post(const QString &url, const QVariant &data, ErrorCallback errorCallback, T &&resultCallback) const
     {
-        runNowOrLater([=] {
-            auto reply = mOAuth.post(ESIUrls::esiUrl + url, data);
-            Q_ASSERT(reply != nullptr);
+        schedule([=] {
+            sendPost(url, data, errorCallback, resultCallback);
+        });
+    }
 
-            qDebug() << "ESI request" << reply << ":" << url << ":" << data;
+    template<class T>
+    void ESIInterface::sendPost(const QString &url, const QVariant &data, ErrorCallback errorCallback, T resultCallback) const
+    {
+        auto reply = mOAuth.post(ESIUrls::getESIUrl() + url, data);
+        Q_ASSERT(reply != nullptr);
 
-            new ReplyTimeout{*reply};
+        qDebug() << "ESI request" << reply << ":" << url << ":" << data;
 
-            connect(reply, &QNetworkReply::finished, this, [=] {
-                reply->deleteLater();
+        new ReplyTimeout{*reply};
 
-                showReplyDebugInfo(*reply);
+        connect(reply, &QNetworkReply::finished, this, [=] {
+            reply->deleteLater();
+            mErrorLimiter.finish(*reply);
 
-                const auto error = reply->error();
-                if (Q_UNLIKELY(error != QNetworkReply::NoError))
-                {
-                    const auto httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-                    const auto parsedError = getError(url, {}, *reply);
+            showReplyDebugInfo(*reply);
 
-                    qWarning() << "Error for request" << reply << ":" << url << ":" << httpStatus << parsedError;
+            const auto error = reply->error();
+            if (Q_UNLIKELY(error != QNetworkReply::NoError))
+            {
+                const auto httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                const auto parsedError = getError(url, {}, *reply);
 
-                    if (shouldThrottle(httpStatus))  // error limit reached?
-                    {
-                        schedulePostErrorLimitRequest([=] {
-                            post(url, data, errorCallback, resultCallback);
-                        }, *reply);
-                    }
-                    else
-                    {
-                        errorCallback(parsedError);
-                    }
+                qWarning() << "Error for request" << reply << ":" << url << ":" << httpStatus << parsedError;
+
+                if (shouldThrottle(httpStatus))  // error limit reached?
+                {
+                    schedulePostErrorLimitRequest([=] {
+                        sendPost(url, data, errorCallback, resultCallback);
+                    }, *reply);
                 }
                 else
                 {
-                    const auto resultText = reply->readAll();
-                    if (mLogReplies)
-                        qDebug() << url << resultText;
-
-                    const auto error = getError(resultText);
-                    if (!error.mMessage.isEmpty())
-                        errorCallback(error);
-                    else
-                        resultCallback(resultText);
+                    errorCallback(parsedError);
                 }
-            });
+            }
+            else
+            {
+                const auto resultText = reply->readAll();
+                if (mLogReplies)
+                    qDebug() << url << resultText;
+
+                const auto error = getError(resultText);
+                if (!error.mMessage.isEmpty())
+                    errorCallback(error);
+                else
+                    resultCallback(resultText);
+            }
         });
     }
 
@@ -874,11 +1298,11 @@ namespace Evernus
     {
         const auto esiLimitHeader = QByteArrayLiteral("X-Esi-Error-Limit-Reset");
 
-        auto errorTimeout = 10u;
+        qint64 errorTimeout = 10;
 
         if (reply.hasRawHeader(esiLimitHeader))
         {
-            errorTimeout = reply.rawHeader(esiLimitHeader).toUInt();
+            errorTimeout = reply.rawHeader(esiLimitHeader).toLongLong();
         }
         else
         {
@@ -887,10 +1311,13 @@ namespace Evernus
             if (targetDate.isValid())
                 errorTimeout = QDateTime::currentDateTime().secsTo(targetDate);
             else
-                errorTimeout = retryAfter.toUInt();
+                errorTimeout = retryAfter.toLongLong();
         }
 
-        mErrorLimiter.addCallback(std::move(callback), std::chrono::seconds{errorTimeout});
+        // dates in the past or garbage shouldn't stall requests or spin on them
+        errorTimeout = std::clamp<qint64>(errorTimeout, 1, 60);
+
+        mErrorLimiter.addCallback(std::move(callback), mPriority, std::chrono::seconds{errorTimeout});
     }
 
     uint ESIInterface::getNumRetries() const
@@ -898,6 +1325,68 @@ namespace Evernus
         return mSettings.value(NetworkSettings::maxRetriesKey, NetworkSettings::maxRetriesDefault).toUInt();
     }
 
+    uint ESIInterface::getRetryAttempt(uint retries) const
+    {
+        const auto maxRetries = getNumRetries();
+        return (maxRetries > retries) ? (maxRetries - retries) : (0);
+    }
+
+    template<class T>
+    void ESIInterface::finishDecoding(const std::shared_ptr<StreamingDecoder> &streamer,
+                                      const QString &key,
+                                      const ESIResponseCache::Response &response,
+                                      T callback) const
+    {
+        streamer->finish([=](const auto &error) {
+            // only cache pages which decoded fine; still on the worker, so serializing doesn't block us
+            if (error.isEmpty())
+            {
+                auto decoded = response;
+                decoded.mData = streamer->getDecoder()->save();
+
+                cacheResponse(key, decoded);
+            }
+
+            runNowOrLater([=] {
+                callback(streamer->getDecoder(), error);
+            });
+        });
+    }
+
+    template<class T>
+    void ESIInterface::readCachedResponse(const QString &key, const ESIResponseCache::Response &response, T callback) const
+    {
+        QtConcurrent::run([=] {
+            auto cached = response;
+            const auto hit = mResponseCache.read(key, cached.mData);
+
+            runNowOrLater([=] {
+                callback(hit, cached);
+            });
+        });
+    }
+
+    void ESIInterface::recordFixture(const QNetworkReply &reply, const QByteArray &data) const
+    {
+        const auto recorder = mFixtureRecorder.load();
+        if (recorder != nullptr)
+            recorder->store(reply.url(), { data, reply.rawHeader(QByteArrayLiteral("ETag")), getPageCount(reply) });
+    }
+
+    void ESIInterface::cacheResponse(const QString &key, const ESIResponseCache::Response &response) const
+    {
+        if (response.mExpires.isValid() && response.mExpires > QDateTime::currentDateTimeUtc())
+            mResponseCache.insert(key, response);
+    }
+
+    template<class T>
+    void ESIInterface::schedule(T callback) const
+    {
+        runNowOrLater([=] {
+            mErrorLimiter.schedule(callback, mPriority);
+        });
+    }
+
     template<class T>
     void ESIInterface::runNowOrLater(T callback) const
     {
@@ -932,11 +1421,12 @@ namespace Evernus
         if (error.mMessage.isEmpty())
             error.mMessage = reply.errorString();
 
-        QStringList query;
-        for (auto param = std::begin(parameters); param != std::end(parameters); ++param)
-            query << QStringLiteral("%1=%2").arg(param.key()).arg(param.value().toString());
+        return { QStringLiteral("%1?%2: %3").arg(url).arg(getQueryString(parameters)).arg(error.mMessage), error.mSSOStatus };
+    }
 
-        return { QStringLiteral("%1?%2: %3").arg(url).arg(query.join('&')).arg(error.mMessage), error.mSSOStatus };
+    ESIResponseCache::Response ESIInterface::getCacheableResponse(QByteArray data, const QNetworkReply &reply)
+    {
+        return { std::move(data), reply.rawHeader(QByteArrayLiteral("ETag")), getExpireTime(reply), getPageCount(reply) };
     }
 
     QDateTime ESIInterface::getExpireTime(const QNetworkReply &reply)
@@ -949,6 +1439,31 @@ namespace Evernus
         return reply.rawHeader(QByteArrayLiteral("X-Pages")).toUInt();
     }
 
+    QString ESIInterface::getPageKey(const QString &url, const QVariantMap &parameters)
+    {
+        // replies from a stand-in server must not mix with the real ones
+        return QStringLiteral("%1%2?%3").arg(ESIUrls::getESIUrl()).arg(url).arg(getQueryString(parameters));
+    }
+
+    QString ESIInterface::getQueryString(const QVariantMap &parameters)
+    {
+        QStringList query;
+        for (auto param = std::begin(parameters); param != std::end(parameters); ++param)
+            query << QStringLiteral("%1=%2").arg(param.key()).arg(param.value().toString());
+
+        return query.join('&');
+    }
+
+    bool ESIInterface::isEmptyPage(const QJsonDocument &page)
+    {
+        return page.array().isEmpty();
+    }
+
+    bool ESIInterface::isEmptyPage(const ConditionalPage &page)
+    {
+        return !page.mNotModified && page.mDecoder && page.mDecoder->isEmpty();
+    }
+
     void ESIInterface::showReplyDebugInfo(const QNetworkReply &reply)
     {
         qDebug() << "X-Esi-Ab-Test:" << reply.rawHeader(QByteArrayLiteral("X-Esi-Ab-Test"));
@@ -16,16 +16,22 @@
 
 #include <unordered_map>
 #include <functional>
+#include <memory>
+#include <atomic>
 #include <mutex>
 
 #include <optional>
 
+#include <QByteArray>
 #include <QSettings>
 #include <QDateTime>
 #include <QString>
 
+#include "ExternalOrderPageCache.h"
 #include "WalletJournalEntry.h"
+#include "ESIRequestPriority.h"
 #include "WalletTransaction.h"
+#include "ESIResponseCache.h"
 #include "Character.h"
 #include "Contract.h"
 #include "EveType.h"
@@ -39,6 +45,7 @@ namespace Evernus
 {
     class ESIInterfaceErrorLimiter;
     class CitadelAccessCache;
+    class ESIFixtureStore;
     class ESIOAuth;
 
     class ESIInterface final
@@ -56,16 +63,62 @@ namespace Evernus
         using PersistentStringCallback = PersistentCallback<QString>;
         using PersistentJsonCallback = PersistentCallback<QJsonDocument>;
 
+        // decodes a page body as it arrives - calls are serialized, but come from worker threads
+        class PageDecoder
+        {
+        public:
+            PageDecoder() = default;
+            virtual ~PageDecoder() = default;
+
+            virtual void feed(const QByteArray &chunk) = 0;
+            // returns error, if any
+            virtual QString finish() = 0;
+
+            virtual bool isEmpty() const = 0;
+
+            // compact form of a decoded page, for the response cache
+            virtual QByteArray save() const = 0;
+            // false on malformed data
+            virtual bool load(const QByteArray &data) = 0;
+        };
+
+        using PageDecoderFactory = std::function<std::shared_ptr<PageDecoder> ()>;
+
+        // page of a conditional request - when not modified, there's no decoder and the caller should reuse what it got for the key before
+        struct ConditionalPage
+        {
+            std::shared_ptr<PageDecoder> mDecoder;
+            QString mKey;
+            bool mNotModified = false;
+        };
+
+        // tells if the caller still has the result for given page key, so the page can be requested conditionally
+        using PageCachedCallback = std::function<bool (const QString &key)>;
+        using ConditionalPaginatedCallback = std::function<void (ConditionalPage &&page, bool atEnd, const QString &error, const QDateTime &expires)>;
+
         ESIInterface(CitadelAccessCache &citadelAccessCache,
                      ESIInterfaceErrorLimiter &errorLimiter,
+                     ESIResponseCache &responseCache,
+                     ExternalOrderPageValidatorCache &pageValidators,
                      ESIOAuth &oauth,
+                     ESIRequestPriority priority,
                      QObject *parent = nullptr);
         ESIInterface(const ESIInterface &) = default;
         ESIInterface(ESIInterface &&) = default;
         virtual ~ESIInterface() = default;
 
-        void fetchMarketOrders(uint regionId, EveType::IdType typeId, const PaginatedCallback &callback) const;
-        void fetchMarketOrders(uint regionId, const PaginatedCallback &callback) const;
+        // public replies get stored as fixtures, bypassing caches; nullptr stops recording
+        void setFixtureRecorder(const ESIFixtureStore *recorder) noexcept;
+
+        void fetchMarketOrders(uint regionId,
+                               EveType::IdType typeId,
+                               const PageCachedCallback &isPageCached,
+                               const PageDecoderFactory &decoderFactory,
+                               const ConditionalPaginatedCallback &callback) const;
+        void fetchMarketOrders(uint regionId,
+                               const PageCachedCallback &isPageCached,
+                               const PageDecoderFactory &decoderFactory,
+                               const ConditionalPaginatedCallback &callback) const;
         void fetchMarketHistory(uint regionId, EveType::IdType typeId, const JsonCallback &callback) const;
         void fetchCitadelMarketOrders(quint64 citadelId, Character::IdType charId, const PaginatedCallback &callback) const;
         void fetchCharacterAssets(Character::IdType charId, const PaginatedCallback &callback) const;
@@ -126,6 +179,7 @@ namespace Evernus
 
         struct JsonTag {};
         struct PaginatedJsonTag {};
+        struct ConditionalPaginatedJsonTag {};
         struct StringTag {};
 
         template<class Tag>
@@ -133,22 +187,40 @@ namespace Evernus
 
         struct PaginatedContext;
 
+        class StreamingDecoder;
+
+        static const int okCode = 200;
+        static const int notModifiedCode = 304;
         static const int errorLimitCode = 420;
         static const int requestThrottledCode = 429;
 
         CitadelAccessCache &mCitadelAccessCache;
         ESIInterfaceErrorLimiter &mErrorLimiter;
+        ESIResponseCache &mResponseCache;
+        ExternalOrderPageValidatorCache &mPageValidators;
         ESIOAuth &mOAuth;
 
+        ESIRequestPriority mPriority = ESIRequestPriority::Interactive;
+
         bool mLogReplies = false;
 
         mutable std::mutex mObjectStateMutex;
 
+        std::atomic<const ESIFixtureStore *> mFixtureRecorder{nullptr};
+
         QSettings mSettings;
 
         template<class T>
         void fetchPaginatedData(const QString &url, QVariantMap parameters, uint page, T &&continuation, const std::shared_ptr<PaginatedContext> &context) const;
         template<class T>
+        void fetchConditionalPaginatedData(const QString &url,
+                                           QVariantMap parameters,
+                                           uint page,
+                                           const PageCachedCallback &isPageCached,
+                                           const PageDecoderFactory &decoderFactory,
+                                           T &&continuation,
+                                           const std::shared_ptr<PaginatedContext> &context) const;
+        template<class T>
         void fetchPaginatedData(Character::IdType charId,
                                 const QString &url,
                                 uint page,
@@ -158,7 +230,12 @@ namespace Evernus
                                 quint64 citadelId = 0) const;
 
         template<class T, class ResultTag = JsonTag>
-        void get(const QString &url, const QVariantMap &parameters, const T &continuation, uint retries) const;
+        void get(const QString &url,
+                 const QVariantMap &parameters,
+                 const T &continuation,
+                 uint retries,
+                 const QByteArray &eTag = QByteArray{},
+                 const PageDecoderFactory &decoderFactory = PageDecoderFactory{}) const;
         template<class T, class ResultTag = JsonTag>
         void get(Character::IdType charId,
                  const QString &url,
@@ -173,21 +250,70 @@ namespace Evernus
         template<class T>
         void post(const QString &url, const QVariant &data, ErrorCallback errorCallback, T &&resultCallback) const;
 
+        // send right away, taking up the limiter slot given to the caller - retries and throttled requests go straight here, so
+        // they don't hold a second slot
+        template<class T, class ResultTag>
+        void sendGet(const QString &url,
+                     const QVariantMap &parameters,
+                     const T &continuation,
+                     uint retries,
+                     const QByteArray &eTag,
+                     const PageDecoderFactory &decoderFactory) const;
+        template<class T, class ResultTag>
+        void sendGet(Character::IdType charId,
+                     const QString &url,
+                     const QVariantMap &parameters,
+                     const T &continuation,
+                     uint retries,
+                     bool importingCitadels,
+                     quint64 citadelId) const;
+
+        template<class T>
+        void sendPost(Character::IdType charId, const QString &url, const QVariant &data, T errorCallback) const;
+        template<class T>
+        void sendPost(const QString &url, const QVariant &data, ErrorCallback errorCallback, T resultCallback) const;
+
         template<class T>
         void schedulePostErrorLimitRequest(T &&callback, const QNetworkReply &reply) const;
 
         uint getNumRetries() const;
+        // 0 for the first retry
+        uint getRetryAttempt(uint retries) const;
 
+        // sends the request through the error limiter
+        template<class T>
+        void schedule(T callback) const;
         template<class T>
         void runNowOrLater(T callback) const;
 
+        // callback(decoder, error) gets called on our thread; successfully decoded pages go to the cache under key
+        template<class T>
+        void finishDecoding(const std::shared_ptr<StreamingDecoder> &streamer,
+                            const QString &key,
+                            const ESIResponseCache::Response &response,
+                            T callback) const;
+
+        // body of a response found in the cache is read on a worker; callback(hit, response) gets called on our thread
+        template<class T>
+        void readCachedResponse(const QString &key, const ESIResponseCache::Response &response, T callback) const;
+
+        void recordFixture(const QNetworkReply &reply, const QByteArray &data) const;
+        // only unexpired responses are worth keeping
+        void cacheResponse(const QString &key, const ESIResponseCache::Response &response) const;
+
         template<class T, class U>
         static auto createPaginatedCallback(uint page, T continuation, U fetchNext, std::shared_ptr<PaginatedContext> context);
 
         static ErrorInfo getError(const QByteArray &reply);
         static ErrorInfo getError(const QString &url, const QVariantMap &parameters, QNetworkReply &reply);
+        static ESIResponseCache::Response getCacheableResponse(QByteArray data, const QNetworkReply &reply);
         static QDateTime getExpireTime(const QNetworkReply &reply);
         static uint getPageCount(const QNetworkReply &reply);
+        static QString getPageKey(const QString &url, const QVariantMap &parameters);
+        static QString getQueryString(const QVariantMap &parameters);
+
+        static bool isEmptyPage(const QJsonDocument &page);
+        static bool isEmptyPage(const ConditionalPage &page);
 
         static void showReplyDebugInfo(const QNetworkReply &reply);
 
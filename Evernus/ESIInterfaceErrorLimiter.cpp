@@ -12,50 +12,252 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <limits>
+
+#include <QNetworkReply>
+
 #include <QtDebug>
 
+#include "NetworkSettings.h"
+
 #include "ESIInterfaceErrorLimiter.h"
 
 namespace Evernus
 {
+    const int ESIInterfaceErrorLimiter::errorLimit;
+    const int ESIInterfaceErrorLimiter::errorReserve;
+
+    const std::size_t ESIInterfaceErrorLimiter::priorityCount;
+
+    const std::chrono::milliseconds ESIInterfaceErrorLimiter::baseRetryDelay{500};
+    const std::chrono::milliseconds ESIInterfaceErrorLimiter::maxRetryDelay{30000};
+
     ESIInterfaceErrorLimiter::ESIInterfaceErrorLimiter(QObject *parent)
         : QObject{parent}
+        , mRandomEngine{std::random_device{}()}
     {
-        mErrorRetryTimer.setSingleShot(true);
+        mResumeTimer.setSingleShot(true);
 
         // queued because timeout crashes for some reason (someone died in the meantime?)
-        connect(&mErrorRetryTimer, &QTimer::timeout,
-                this, &ESIInterfaceErrorLimiter::processPendingRequestsAfterErrors, Qt::QueuedConnection);
+        connect(&mResumeTimer, &QTimer::timeout,
+                this, &ESIInterfaceErrorLimiter::dispatch, Qt::QueuedConnection);
+    }
+
+    void ESIInterfaceErrorLimiter::schedule(Callback callback, ESIRequestPriority priority)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mRequestMutex};
+            enqueue(std::move(callback), priority, false);
+        }
+
+        dispatch();
     }
 
-    void ESIInterfaceErrorLimiter::addCallback(Callback callback, const std::chrono::seconds &timeout)
+    void ESIInterfaceErrorLimiter::finish(const QNetworkReply &reply)
     {
-        const auto errorTime = QDateTime::currentDateTime().addSecs(timeout.count());
+        const auto remainHeader = QByteArrayLiteral("X-Esi-Error-Limit-Remain");
+        const auto resetHeader = QByteArrayLiteral("X-Esi-Error-Limit-Reset");
+
+        if (reply.hasRawHeader(remainHeader))
+        {
+            const auto now = Clock::now();
+            const auto remain = reply.rawHeader(remainHeader).toInt();
+            const std::chrono::seconds reset{reply.rawHeader(resetHeader).toUInt()};
+
+            std::lock_guard<std::mutex> lock{mRequestMutex};
+
+            mErrorsRemaining = remain;
+            mErrorLimitReset = now + reset;
+
+            if (mErrorsRemaining <= errorReserve)
+            {
+                qDebug() << "ESI error budget exhausted, pausing requests for" << reset.count() << "s";
+                pause(reset);
+            }
+        }
 
-        std::lock_guard<std::mutex> lock{mErrorRequestMutex};
-        mPendingErrorRequests.emplace_back(std::move(callback));
+        finish();
+    }
 
-        if (mNextErrorLimitRetry < errorTime)
+    void ESIInterfaceErrorLimiter::finish()
+    {
         {
-            qDebug() << "Rescheduling request:" << errorTime;
+            std::lock_guard<std::mutex> lock{mRequestMutex};
 
-            mNextErrorLimitRetry = errorTime;
-            mErrorRetryTimer.start(timeout.count() * 1000);
+            Q_ASSERT(mActiveRequests > 0);
+            --mActiveRequests;
         }
+
+        dispatch();
     }
 
-    void ESIInterfaceErrorLimiter::processPendingRequestsAfterErrors()
+    void ESIInterfaceErrorLimiter::retry(Callback callback, ESIRequestPriority priority, uint attempt)
     {
-        decltype(mPendingErrorRequests) requests;
+        auto delay = maxRetryDelay;
+        if (attempt < 16)
+            delay = std::min(maxRetryDelay, baseRetryDelay * (1 << attempt));
 
         {
-            std::lock_guard<std::mutex> lock{mErrorRequestMutex};
-            requests = std::move(mPendingErrorRequests);
+            std::lock_guard<std::mutex> lock{mRequestMutex};
+
+            // full jitter over the upper half, so retries of a failed batch don't come back in lockstep
+            std::uniform_int_distribution<std::chrono::milliseconds::rep> dis{delay.count() / 2, delay.count()};
+            delay = std::chrono::milliseconds{dis(mRandomEngine)};
         }
 
-        qDebug() << "Processing pending error requests:" << requests.size();
+        qDebug() << "Retrying request in" << delay.count() << "ms";
+
+        QTimer::singleShot(delay, this, [=] {
+            schedule(callback, priority);
+        });
+    }
+
+    void ESIInterfaceErrorLimiter::addCallback(Callback callback, ESIRequestPriority priority, const std::chrono::seconds &timeout)
+    {
+        std::lock_guard<std::mutex> lock{mRequestMutex};
+
+        // it was sent already, so let it go first
+        enqueue(std::move(callback), priority, true);
+        pause(timeout);
+    }
+
+    void ESIInterfaceErrorLimiter::dispatch()
+    {
+        std::unique_lock<std::mutex> lock{mRequestMutex};
+
+        // callbacks can finish synchronously and get back here
+        if (mDispatching)
+            return;
+
+        mDispatching = true;
+
+        while (true)
+        {
+            const auto now = Clock::now();
+            if (now < mPausedUntil)
+                break;
+
+            const auto concurrency = getAllowedConcurrency(now);
+
+            RequestQueue *next = nullptr;
+            auto nextPriority = ESIRequestPriority::Interactive;
+
+            // on equal pass, the higher priority wins
+            for (auto i = 0u; i < priorityCount; ++i)
+            {
+                auto &queue = mPendingRequests[i];
+                if (queue.mPending.empty())
+                    continue;
+
+                const auto priority = static_cast<ESIRequestPriority>(i);
+                const auto limit = std::max(concurrency * getConcurrencyShare(priority) / 100, 1u);
+
+                if (mActiveRequests >= std::min(limit, concurrency))
+                    continue;
+
+                if (next == nullptr || queue.mPass < next->mPass)
+                {
+                    next = &queue;
+                    nextPriority = priority;
+                }
+            }
+
+            if (next == nullptr)
+                break;
+
+            const auto callback = std::move(next->mPending.front());
+            next->mPending.pop_front();
+
+            next->mPass += getStride(nextPriority);
+            ++mActiveRequests;
+
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+
+        mDispatching = false;
+    }
+
+    void ESIInterfaceErrorLimiter::enqueue(Callback callback, ESIRequestPriority priority, bool first)
+    {
+        auto &queue = mPendingRequests[static_cast<std::size_t>(priority)];
+        if (queue.mPending.empty())
+        {
+            // a queue coming back from idle joins at the current virtual time, so it neither catches up nor waits for others to
+            auto pass = std::numeric_limits<quint64>::max();
+            for (const auto &other : mPendingRequests)
+            {
+                if (!other.mPending.empty())
+                    pass = std::min(pass, other.mPass);
+            }
+
+            queue.mPass = (pass == std::numeric_limits<quint64>::max()) ? (0) : (pass);
+        }
+
+        if (first)
+            queue.mPending.emplace_front(std::move(callback));
+        else
+            queue.mPending.emplace_back(std::move(callback));
+    }
+
+    void ESIInterfaceErrorLimiter::pause(Clock::duration time)
+    {
+        const auto until = Clock::now() + time;
+        if (until <= mPausedUntil)
+            return;
+
+        qDebug() << "Pausing ESI requests:" << std::chrono::duration_cast<std::chrono::seconds>(time).count() << "s";
+
+        mPausedUntil = until;
+        // round up, so we don't wake up just before the window resets
+        const auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(time).count() + 1;
+        mResumeTimer.start(static_cast<int>(std::clamp<qint64>(interval, 0, std::numeric_limits<int>::max())));
+    }
+
+    uint ESIInterfaceErrorLimiter::getAllowedConcurrency(Clock::time_point now) const
+    {
+        const auto maxConcurrency = std::max(
+            mSettings.value(NetworkSettings::maxConcurrentRequestsKey, NetworkSettings::maxConcurrentRequestsDefault).toUInt(), 1u);
+
+        // budget window passed - assume it's whole again
+        if (now >= mErrorLimitReset || mErrorsRemaining >= errorLimit)
+            return maxConcurrency;
+        if (mErrorsRemaining <= errorReserve)
+            return 0;
+
+        // scale with what's left, but always allow some progress
+        return std::max(maxConcurrency * (mErrorsRemaining - errorReserve) / (errorLimit - errorReserve), 1u);
+    }
+    uint ESIInterfaceErrorLimiter::getStride(ESIRequestPriority priority) noexcept
+    {
+        // inverse of the class weight - interactive gets 8 requests for every background one
+        switch (priority) {
+        case ESIRequestPriority::Interactive:
+            return 1;
+        case ESIRequestPriority::ForegroundImport:
+            return 2;
+        case ESIRequestPriority::BackgroundRefresh:
+            return 8;
+        }
+
+        return 1;
+    }
+
+    uint ESIInterfaceErrorLimiter::getConcurrencyShare(ESIRequestPriority priority) noexcept
+    {
+        // percentage of allowed concurrency in use, above which the class has to wait
+        // keeps slots free for interactive requests even when imports saturate the connection
+        switch (priority) {
+        case ESIRequestPriority::Interactive:
+            return 100;
+        case ESIRequestPriority::ForegroundImport:
+            return 90;
+        case ESIRequestPriority::BackgroundRefresh:
+            return 75;
+        }
 
-        for (const auto &request : requests)
-            request();
+        return 100;
     }
 }
@@ -15,15 +15,24 @@
 #pragma once
 
 #include <functional>
-#include <vector>
+#include <random>
 #include <chrono>
+#include <array>
+#include <deque>
 #include <mutex>
 
-#include <QDateTime>
+#include <QSettings>
 #include <QTimer>
 
+#include "ESIRequestPriority.h"
+
+class QNetworkReply;
+
 namespace Evernus
 {
+    // paces ESI requests, so the error limit is never hit
+    // concurrency shrinks along with the error budget reported by ESI and stops until the budget window resets when it runs out
+    // priority classes share the slots in a weighted fair way and lower ones leave some free for those above
     class ESIInterfaceErrorLimiter final
         : public QObject
     {
@@ -37,18 +46,62 @@ namespace Evernus
         ESIInterfaceErrorLimiter(ESIInterfaceErrorLimiter &&) = default;
         virtual ~ESIInterfaceErrorLimiter() = default;
 
-        void addCallback(Callback callback, const std::chrono::seconds &timeout);
+        // callback sends a request and has to be paired with finish()
+        void schedule(Callback callback, ESIRequestPriority priority);
+        void finish(const QNetworkReply &reply);
+        void finish();
+
+        // delays schedule() using exponential backoff with jitter; attempt starts at 0
+        // like with schedule(), callback has to send the request itself and not schedule another one
+        void retry(Callback callback, ESIRequestPriority priority, uint attempt);
+
+        // ESI told us to back off - nothing gets sent until timeout; callback is a send, same as above
+        void addCallback(Callback callback, ESIRequestPriority priority, const std::chrono::seconds &timeout);
 
         ESIInterfaceErrorLimiter &operator =(const ESIInterfaceErrorLimiter &) = default;
         ESIInterfaceErrorLimiter &operator =(ESIInterfaceErrorLimiter &&) = default;
 
     private slots:
-        void processPendingRequestsAfterErrors();
+        void dispatch();
 
     private:
-        std::vector<Callback> mPendingErrorRequests;
-        QTimer mErrorRetryTimer;
-        QDateTime mNextErrorLimitRetry;
-        std::mutex mErrorRequestMutex;
+        using Clock = std::chrono::steady_clock;
+
+        static const int errorLimit = 100;
+        // errors left for requests already in flight when we stop sending
+        static const int errorReserve = 10;
+
+        static const std::chrono::milliseconds baseRetryDelay;
+        static const std::chrono::milliseconds maxRetryDelay;
+
+        struct RequestQueue
+        {
+            std::deque<Callback> mPending;
+            // virtual time - the queue with the lowest one goes next
+            quint64 mPass = 0;
+        };
+
+        static const std::size_t priorityCount = 3;
+
+        std::array<RequestQueue, priorityCount> mPendingRequests;
+        uint mActiveRequests = 0;
+        bool mDispatching = false;
+
+        int mErrorsRemaining = errorLimit;
+        Clock::time_point mErrorLimitReset;
+        Clock::time_point mPausedUntil;
+
+        QTimer mResumeTimer;
+        QSettings mSettings;
+        std::mt19937 mRandomEngine;
+        std::mutex mRequestMutex;
+
+        // mRequestMutex must be held for the following
+        void enqueue(Callback callback, ESIRequestPriority priority, bool first);
+        void pause(Clock::duration time);
+        uint getAllowedConcurrency(Clock::time_point now) const;
+
+        static uint getStride(ESIRequestPriority priority) noexcept;
+        static uint getConcurrencyShare(ESIRequestPriority priority) noexcept;
     };
 }
@@ -15,9 +15,11 @@
 #include <QStandardPaths>
 #include <QDataStream>
 #include <QSettings>
+#include <QtDebug>
 #include <QFile>
 #include <QDir>
 
+#include "ESIFixtureStore.h"
 #include "ImportSettings.h"
 
 #include "ESIInterfaceManager.h"
@@ -32,8 +34,12 @@ namespace Evernus
         : QObject{parent}
         , mClientId{clientId}
         , mClientSecret{clientSecret}
+        , mResponseCache{getResponseCachePath()}
         , mOAuth{std::move(clientId), std::move(clientSecret), characterRepo, dataProvider}
-        , mInterface{mCitadelAccessCache, mErrorLimiter, mOAuth}
+        , mExternalOrderPageCache{QStringLiteral("Market order pages"), 8}
+        , mInterface{mCitadelAccessCache, mErrorLimiter, mResponseCache, mExternalOrderPageValidators, mOAuth, ESIRequestPriority::Interactive}
+        , mForegroundImportInterface{mCitadelAccessCache, mErrorLimiter, mResponseCache, mExternalOrderPageValidators, mOAuth, ESIRequestPriority::ForegroundImport}
+        , mBackgroundRefreshInterface{mCitadelAccessCache, mErrorLimiter, mResponseCache, mExternalOrderPageValidators, mOAuth, ESIRequestPriority::BackgroundRefresh}
     {
         connect(&mOAuth, &ESIOAuth::ssoAuthRequested, this, &ESIInterfaceManager::ssoAuthRequested);
 
@@ -42,6 +48,10 @@ namespace Evernus
 
     ESIInterfaceManager::~ESIInterfaceManager()
     {
+        mInterface.setFixtureRecorder(nullptr);
+        mForegroundImportInterface.setFixtureRecorder(nullptr);
+        mBackgroundRefreshInterface.setFixtureRecorder(nullptr);
+
         try
         {
             writeCitadelAccessCache();
@@ -56,6 +66,21 @@ namespace Evernus
         mOAuth.clearRefreshTokens();
     }
 
+    void ESIInterfaceManager::handleNewPreferences()
+    {
+        mResponseCache.handleNewPreferences();
+    }
+
+    void ESIInterfaceManager::recordFixtures(const QString &path)
+    {
+        qDebug() << "Recording ESI fixtures to" << path;
+
+        mFixtureRecorder = std::make_unique<ESIFixtureStore>(path);
+        mInterface.setFixtureRecorder(mFixtureRecorder.get());
+        mForegroundImportInterface.setFixtureRecorder(mFixtureRecorder.get());
+        mBackgroundRefreshInterface.setFixtureRecorder(mFixtureRecorder.get());
+    }
+
     void ESIInterfaceManager::processSSOAuthorizationCode(Character::IdType charId, const QByteArray &code)
     {
         mOAuth.processSSOAuthorizationCode(charId, code);
@@ -71,8 +96,17 @@ namespace Evernus
         mOAuth.setTokens(id, accessToken, refreshToken);
     }
 
-    const ESIInterface &ESIInterfaceManager::getInterface() const
+    const ESIInterface &ESIInterfaceManager::getInterface(ESIRequestPriority priority) const
     {
+        switch (priority) {
+        case ESIRequestPriority::Interactive:
+            return mInterface;
+        case ESIRequestPriority::ForegroundImport:
+            return mForegroundImportInterface;
+        case ESIRequestPriority::BackgroundRefresh:
+            return mBackgroundRefreshInterface;
+        }
+
         return mInterface;
     }
 
@@ -86,6 +120,21 @@ namespace Evernus
         return mCitadelAccessCache;
     }
 
+    ExternalOrderPageCache &ESIInterfaceManager::getExternalOrderPageCache() noexcept
+    {
+        return mExternalOrderPageCache;
+    }
+
+    ESIInterfaceManager::MarketOrderRequests &ESIInterfaceManager::getMarketOrderRequests() noexcept
+    {
+        return mMarketOrderRequests;
+    }
+
+    ESIInterfaceManager::MarketHistoryRequests &ESIInterfaceManager::getMarketHistoryRequests() noexcept
+    {
+        return mMarketHistoryRequests;
+    }
+
     QString ESIInterfaceManager::getClientId() const
     {
         return mClientId;
@@ -125,4 +174,9 @@ namespace Evernus
     {
         return QDir{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/data")}.filePath(QStringLiteral("citadel_access"));
     }
+
+    QString ESIInterfaceManager::getResponseCachePath()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/esi");
+    }
 }
@@ -14,13 +14,23 @@
  */
 #pragma once
 
+#include <vector>
+#include <memory>
+#include <map>
+
 #include <QDateTime>
 #include <QObject>
 #include <QString>
+#include <QDate>
 
 #include "QObjectDeleteLaterDeleter.h"
 #include "ESIInterfaceErrorLimiter.h"
+#include "ExternalOrderPageCache.h"
+#include "ESIRequestCoalescer.h"
+#include "ESIRequestPriority.h"
+#include "ESIResponseCache.h"
 #include "CitadelAccessCache.h"
+#include "MarketHistoryEntry.h"
 #include "ESIInterface.h"
 #include "Character.h"
 #include "ESIOAuth.h"
@@ -31,6 +41,7 @@ class QUrl;
 namespace Evernus
 {
     class CharacterRepository;
+    class ESIFixtureStore;
     class EveDataProvider;
     class ESIInterface;
 
@@ -40,6 +51,9 @@ namespace Evernus
         Q_OBJECT
 
     public:
+        using MarketOrderRequests = ESIRequestCoalescer<std::vector<ExternalOrder>>;
+        using MarketHistoryRequests = ESIRequestCoalescer<std::map<QDate, MarketHistoryEntry>>;
+
         ESIInterfaceManager(QString clientId,
                             QString clientSecret,
                             const CharacterRepository &characterRepo,
@@ -51,15 +65,26 @@ namespace Evernus
 
         void clearRefreshTokens();
 
+        void handleNewPreferences();
+
+        // stores public ESI replies in given directory, for ESIReplayService
+        void recordFixtures(const QString &path);
+
         void processSSOAuthorizationCode(Character::IdType charId, const QByteArray &code);
         void cancelSsoAuth(Character::IdType charId);
         void setTokens(Character::IdType id, const QString &accessToken, const QString &refreshToken);
 
-        const ESIInterface &getInterface() const;
+        // each priority class has its own interface, so requests made through it get scheduled accordingly
+        const ESIInterface &getInterface(ESIRequestPriority priority = ESIRequestPriority::Interactive) const;
 
         const CitadelAccessCache &getCitadelAccessCache() const noexcept;
         CitadelAccessCache &getCitadelAccessCache() noexcept;
 
+        ExternalOrderPageCache &getExternalOrderPageCache() noexcept;
+
+        MarketOrderRequests &getMarketOrderRequests() noexcept;
+        MarketHistoryRequests &getMarketHistoryRequests() noexcept;
+
         QString getClientId() const;
         QString getClientSecret() const;
 
@@ -75,13 +100,26 @@ namespace Evernus
 
         CitadelAccessCache mCitadelAccessCache;
         ESIInterfaceErrorLimiter mErrorLimiter;
+        ESIResponseCache mResponseCache;
         ESIOAuth mOAuth;
 
+        ExternalOrderPageCache mExternalOrderPageCache;
+        ExternalOrderPageValidatorCache mExternalOrderPageValidators;
+
         ESIInterface mInterface;
+        ESIInterface mForegroundImportInterface;
+        ESIInterface mBackgroundRefreshInterface;
+
+        std::unique_ptr<ESIFixtureStore> mFixtureRecorder;
+
+        // shared by all ESIManagers, so importers and fetchers running together don't duplicate requests
+        MarketOrderRequests mMarketOrderRequests;
+        MarketHistoryRequests mMarketHistoryRequests;
 
         void readCitadelAccessCache();
         void writeCitadelAccessCache();
 
         static QString getCachePath();
+        static QString getResponseCachePath();
     };
 }
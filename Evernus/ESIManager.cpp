@@ -38,6 +38,7 @@
 #include <boost/scope_exit.hpp>
 
 #include "SovereigntyStructure.h"
+#include "ExternalOrderJsonParser.h"
 #include "ESIInterfaceManager.h"
 #include "EveDataProvider.h"
 #include "NetworkSettings.h"
@@ -57,10 +58,12 @@ namespace Evernus
 
     ESIManager::ESIManager(const EveDataProvider &dataProvider,
                            ESIInterfaceManager &interfaceManager,
+                           ESIRequestPriority priority,
                            QObject *parent)
         : QObject{parent}
         , mDataProvider{dataProvider}
         , mInterfaceManager{interfaceManager}
+        , mPriority{priority}
     {
         QSettings settings;
         mFirstTimeCitadelOrderImport = settings.value(firstTimeCitadelOrderImportKey, mFirstTimeCitadelOrderImport).toBool();
@@ -70,21 +73,39 @@ namespace Evernus
                                        EveType::IdType typeId,
                                        const MarketOrderCallback &callback) const
     {
+        const auto requestCallback = mInterfaceManager.getMarketOrderRequests().attach(
+            QStringLiteral("/v1/markets/%1/orders/?type_id=%2").arg(regionId).arg(typeId),
+            mPriority,
+            callback
+        );
+        if (!requestCallback)
+            return;
+
         qDebug() << "Started market order import at" << QDateTime::currentDateTime();
-        getInterface().fetchMarketOrders(regionId, typeId, getMarketOrderCallback(regionId, callback));
+
+        const auto pinnedPages = std::make_shared<PinnedOrderPages>();
+        getInterface().fetchMarketOrders(regionId,
+                                         typeId,
+                                         getMarketOrderPageCachedCallback(pinnedPages),
+                                         getMarketOrderDecoderFactory(regionId),
+                                         getMarketOrderCallback(regionId, requestCallback, pinnedPages));
     }
 
     void ESIManager::fetchMarketHistory(uint regionId,
                                         EveType::IdType typeId,
                                         const Callback<HistoryMap> &callback) const
     {
+        const auto requestCallback = mInterfaceManager.getMarketHistoryRequests().attach(
+            QStringLiteral("/v1/markets/%1/history/?type_id=%2").arg(regionId).arg(typeId),
+            mPriority,
+            callback
+        );
+        if (!requestCallback)
+            return;
+
         qDebug() << "Started history import at" << QDateTime::currentDateTime();
 
-#if EVERNUS_CLANG_LAMBDA_CAPTURE_BUG
-        getInterface().fetchMarketHistory(regionId, typeId, [=, callback = callback](auto &&data, const auto &error, const auto &expires) {
-#else
-        getInterface().fetchMarketHistory(regionId, typeId, [=](auto &&data, const auto &error, const auto &expires) {
-#endif
+        getInterface().fetchMarketHistory(regionId, typeId, [=, callback = requestCallback](auto &&data, const auto &error, const auto &expires) {
             if (Q_UNLIKELY(!error.isEmpty()))
             {
                 callback({}, error, expires);
@@ -115,8 +136,21 @@ namespace Evernus
 
     void ESIManager::fetchMarketOrders(uint regionId, const MarketOrderCallback &callback) const
     {
+        const auto requestCallback = mInterfaceManager.getMarketOrderRequests().attach(
+            QStringLiteral("/v1/markets/%1/orders/").arg(regionId),
+            mPriority,
+            callback
+        );
+        if (!requestCallback)
+            return;
+
         qDebug() << "Started market order import at" << QDateTime::currentDateTime();
-        getInterface().fetchMarketOrders(regionId, getMarketOrderCallback(regionId, callback));
+
+        const auto pinnedPages = std::make_shared<PinnedOrderPages>();
+        getInterface().fetchMarketOrders(regionId,
+                                         getMarketOrderPageCachedCallback(pinnedPages),
+                                         getMarketOrderDecoderFactory(regionId),
+                                         getMarketOrderCallback(regionId, requestCallback, pinnedPages));
     }
 
     void ESIManager::fetchCitadelMarketOrders(quint64 citadelId, uint regionId, Character::IdType charId, const MarketOrderCallback &callback) const
@@ -556,12 +590,15 @@ namespace Evernus
             std::unordered_map<quint64, QString> mResult;
             QString mError;
             bool mEmittedError = false;
+            std::size_t mPendingRequests = 0;
         };
 
         auto state = std::make_shared<SharedState>();
+        state->mPendingRequests = (ids.size() + maxPerRequest - 1) / maxPerRequest;
+
         auto current = 0u;
 
-        const auto transformCallback = [=, totalSize = ids.size()](auto &&data, const auto &error) {
+        const auto transformCallback = [=](auto &&data, const auto &error) {
             if (state->mError.isEmpty() && !error.isEmpty())
                 state->mError = error;
 
@@ -585,7 +622,8 @@ namespace Evernus
                 return std::make_pair(static_cast<quint64>(nameObj.value(QStringLiteral("id")).toDouble()), nameObj.value(QStringLiteral("name")).toString());
             });
 
-            if (state->mResult.size() == totalSize)
+            // ESI can skip ids, so count replies instead of names
+            if (--state->mPendingRequests == 0)
                 callback(std::move(state->mResult), {});
         };
 
@@ -597,7 +635,7 @@ namespace Evernus
             );
         }
 
-        if (current < ids.size())
+        if (current * maxPerRequest < ids.size())
             getInterface().fetchGenericNames(std::vector<quint64>(std::begin(ids) + current * maxPerRequest, std::end(ids)), transformCallback);
     }
 
@@ -796,7 +834,10 @@ namespace Evernus
         );
     }
 
-    ExternalOrder ESIManager::getExternalOrderFromJson(const QJsonObject &object, uint regionId, const QDateTime &updateTime) const
+    ExternalOrder ESIManager::getExternalOrderFromJson(const QJsonObject &object,
+                                                       uint regionId,
+                                                       const QDateTime &updateTime,
+                                                       const EveDataProvider &dataProvider)
     {
         const auto range = object.value(QStringLiteral("range")).toString();
 
@@ -811,7 +852,7 @@ namespace Evernus
         if (object.contains(QStringLiteral("system_id")))
             order.setSolarSystemId(object.value(QStringLiteral("system_id")).toDouble());
         else
-            order.setSolarSystemId(mDataProvider.getStationSolarSystemId(order.getStationId()));
+            order.setSolarSystemId(dataProvider.getStationSolarSystemId(order.getStationId()));
 
         if (range == "station")
             order.setRange(ExternalOrder::rangeStation);
@@ -843,19 +884,93 @@ namespace Evernus
                 return;
             }
 
-            const auto items = data.array();
-            const auto curSize = orders->size();
-            orders->resize(curSize + items.size());
+            appendExternalOrdersFromJson(data.array(), regionId, *orders);
+
+            if (atEnd)
+                callback(std::move(*orders), {}, expires);
+        };
+    }
+
+    void ESIManager::appendExternalOrdersFromJson(const QJsonArray &items, uint regionId, ExternalOrderList &orders) const
+    {
+        const auto curSize = orders.size();
+        orders.resize(curSize + items.size());
 
-            const auto updateTime = QDateTime::currentDateTimeUtc();
+        const auto updateTime = QDateTime::currentDateTimeUtc();
 
-            std::atomic_size_t nextIndex{curSize};
+        std::atomic_size_t nextIndex{curSize};
 
-            const auto parseItem = [&](const auto &item) {
-                (*orders)[nextIndex++] = getExternalOrderFromJson(item.toObject(), regionId, updateTime);
-            };
+        const auto parseItem = [&](const auto &item) {
+            orders[nextIndex++] = getExternalOrderFromJson(item.toObject(), regionId, updateTime, mDataProvider);
+        };
+
+        QtConcurrent::blockingMap(items, parseItem);
+    }
+
+    ESIInterface::PageCachedCallback ESIManager::getMarketOrderPageCachedCallback(const std::shared_ptr<PinnedOrderPages> &pinnedPages) const
+    {
+        return [=](const auto &key) {
+            ExternalOrderPage page;
+            if (!mInterfaceManager.getExternalOrderPageCache().find(key, page))
+                return false;
+
+            pinnedPages->insert(key, std::move(page));
+            return true;
+        };
+    }
 
-            QtConcurrent::blockingMap(items, parseItem);
+    ESIInterface::PageDecoderFactory ESIManager::getMarketOrderDecoderFactory(uint regionId) const
+    {
+        return [=] {
+            return std::make_shared<ExternalOrderJsonParser>(mDataProvider, regionId, QDateTime::currentDateTimeUtc());
+        };
+    }
+
+    ESIInterface::ConditionalPaginatedCallback ESIManager::getMarketOrderCallback(uint regionId,
+                                                                                  const MarketOrderCallback &callback,
+                                                                                  const std::shared_ptr<PinnedOrderPages> &pinnedPages) const
+    {
+        auto orders = std::make_shared<ExternalOrderList>();
+        return [=, orders = std::move(orders)](auto &&page, auto atEnd, const auto &error, const auto &expires) {
+            if (Q_UNLIKELY(!error.isEmpty()))
+            {
+                callback({}, error, expires);
+                return;
+            }
+
+            if (page.mNotModified)
+            {
+                const auto cachedPage = pinnedPages->take(page.mKey);
+                if (Q_UNLIKELY(!cachedPage))
+                {
+                    callback({}, tr("Missing cached market order page: %1").arg(page.mKey), expires);
+                    return;
+                }
+
+                const auto updateTime = QDateTime::currentDateTimeUtc();
+
+                orders->reserve(orders->size() + cachedPage->size());
+                for (auto order : *cachedPage)
+                {
+                    order.setUpdateTime(updateTime);
+                    orders->emplace_back(std::move(order));
+                }
+            }
+            else
+            {
+                pinnedPages->remove(page.mKey);
+
+                Q_ASSERT(page.mDecoder);
+
+                // already decoded by the time we get here
+                auto pageOrders = static_cast<ExternalOrderJsonParser &>(*page.mDecoder).takeOrders();
+                orders->insert(std::end(*orders), std::begin(pageOrders), std::end(pageOrders));
+
+                mInterfaceManager.getExternalOrderPageCache().insert(
+                    page.mKey,
+                    std::make_shared<const ExternalOrderList>(std::move(pageOrders))
+                );
+            }
 
             if (atEnd)
                 callback(std::move(*orders), {}, expires);
@@ -1300,7 +1415,7 @@ namespace Evernus
 
     const ESIInterface &ESIManager::getInterface() const
     {
-        return mInterfaceManager.getInterface();
+        return mInterfaceManager.getInterface(mPriority);
     }
 
     short ESIManager::getMarketOrderRangeFromString(const QString &range)
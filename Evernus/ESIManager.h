@@ -24,9 +24,12 @@
 #include <QDateTime>
 #include <QString>
 #include <QDate>
+#include <QHash>
 
+#include "ExternalOrderPageCache.h"
 #include "IndustryCostIndices.h"
 #include "MarketHistoryEntry.h"
+#include "ESIRequestPriority.h"
 #include "WalletJournalEntry.h"
 #include "WalletTransactions.h"
 #include "WalletTransaction.h"
@@ -43,6 +46,7 @@
 #include "EveType.h"
 
 class QJsonObject;
+class QJsonArray;
 class QDateTime;
 
 namespace Evernus
@@ -50,7 +54,6 @@ namespace Evernus
     struct SovereigntyStructure;
     class ESIInterfaceManager;
     class EveDataProvider;
-    class ExternalOrder;
     class MiningLedger;
     class Blueprint;
 
@@ -84,6 +87,7 @@ namespace Evernus
 
         ESIManager(const EveDataProvider &dataProvider,
                    ESIInterfaceManager &interfaceManager,
+                   ESIRequestPriority priority = ESIRequestPriority::Interactive,
                    QObject *parent = nullptr);
         ESIManager(const ESIManager &) = default;
         ESIManager(ESIManager &&) = default;
@@ -144,6 +148,12 @@ namespace Evernus
         ESIManager &operator =(const ESIManager &) = default;
         ESIManager &operator =(ESIManager &&) = default;
 
+        // decoding of a single order from a parsed JSON document, for replies which didn't go through ExternalOrderJsonParser
+        static ExternalOrder getExternalOrderFromJson(const QJsonObject &object,
+                                                      uint regionId,
+                                                      const QDateTime &updateTime,
+                                                      const EveDataProvider &dataProvider);
+
     signals:
         void error(const QString &text) const;
 
@@ -156,6 +166,8 @@ namespace Evernus
 
         ESIInterfaceManager &mInterfaceManager;
 
+        ESIRequestPriority mPriority = ESIRequestPriority::Interactive;
+
         void fetchCharacterWalletTransactions(Character::IdType charId,
                                               const std::optional<WalletTransaction::IdType> &fromId,
                                               WalletTransaction::IdType tillId,
@@ -169,8 +181,16 @@ namespace Evernus
                                                 std::shared_ptr<WalletTransactions> &&transactions,
                                                 const WalletTransactionsCallback &callback) const;
 
-        ExternalOrder getExternalOrderFromJson(const QJsonObject &object, uint regionId, const QDateTime &updateTime) const;
+        // cached pages kept alive for the duration of an import, in case they get evicted before ESI replies
+        using PinnedOrderPages = QHash<QString, ExternalOrderPage>;
+
+        void appendExternalOrdersFromJson(const QJsonArray &items, uint regionId, ExternalOrderList &orders) const;
         ESIInterface::PaginatedCallback getMarketOrderCallback(uint regionId, const MarketOrderCallback &callback) const;
+        ESIInterface::PageCachedCallback getMarketOrderPageCachedCallback(const std::shared_ptr<PinnedOrderPages> &pinnedPages) const;
+        ESIInterface::PageDecoderFactory getMarketOrderDecoderFactory(uint regionId) const;
+        ESIInterface::ConditionalPaginatedCallback getMarketOrderCallback(uint regionId,
+                                                                          const MarketOrderCallback &callback,
+                                                                          const std::shared_ptr<PinnedOrderPages> &pinnedPages) const;
         ESIInterface::JsonCallback getMarketOrdersCallback(Character::IdType charId, const MarketOrdersCallback &callback) const;
         ESIInterface::PaginatedCallback getAssetListCallback(Character::IdType charId, const AssetCallback &callback) const;
         ESIInterface::JsonCallback getContractCallback(const ContractCallback &callback) const;
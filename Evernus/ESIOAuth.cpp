@@ -68,7 +68,7 @@ namespace Evernus
         });
     }
 
-    QNetworkReply *ESIOAuth::get(QUrl url, QVariantMap parameters)
+    QNetworkReply *ESIOAuth::get(QUrl url, QVariantMap parameters, const QByteArray &eTag)
     {
         prepareParameters(parameters);
 
@@ -78,7 +78,11 @@ namespace Evernus
 
         url.setQuery(query);
 
-        const auto reply = mUnauthNetworkAccessManager.get(prepareRequest(url));
+        auto request = prepareRequest(url);
+        if (!eTag.isEmpty())
+            request.setRawHeader(QByteArrayLiteral("If-None-Match"), eTag);
+
+        const auto reply = mUnauthNetworkAccessManager.get(request);
         connect(reply, &QNetworkReply::sslErrors, this, &ESIOAuth::processSslErrors);
 
         return reply;
@@ -54,7 +54,8 @@ namespace Evernus
         virtual ~ESIOAuth() = default;
 
         void get(Character::IdType charId, const QUrl &url, QVariantMap parameters, NetworkReplyCallback callback, AuthErrorCallback errorCallback);
-        QNetworkReply *get(QUrl url, QVariantMap parameters = {});
+        // non-empty eTag makes the request conditional
+        QNetworkReply *get(QUrl url, QVariantMap parameters = {}, const QByteArray &eTag = {});
         QNetworkReply *post(QUrl url, const QVariant &data = {});
         void post(Character::IdType charId, QUrl url, const QVariant &data, NetworkReplyCallback callback, AuthErrorCallback errorCallback);
 
@@ -0,0 +1,186 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <array>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QLocale>
+#include <QtDebug>
+#include <QTimer>
+
+#include "qxtwebevent.h"
+
+#include "ESIReplayService.h"
+
+namespace Evernus
+{
+    ESIReplayService::ESIReplayService(const QString &fixturePath,
+                                       const Options &options,
+                                       QxtAbstractWebSessionManager *sm,
+                                       QObject *parent)
+        : QxtAbstractWebService{sm, parent}
+        , mFixtures{fixturePath}
+        , mOptions{options}
+    {
+        updateErrorLimit();
+    }
+
+    void ESIReplayService::pageRequestedEvent(QxtWebRequestEvent *event)
+    {
+        Q_ASSERT(event != nullptr);
+
+        qDebug() << "ESI replay request:" << event->url;
+
+        updateErrorLimit();
+
+        if (mErrorLimitRemain == 0)
+        {
+            respondWithError(event, errorLimitCode, QStringLiteral("This software has exceeded the error limit for ESI."));
+            return;
+        }
+
+        std::uniform_real_distribution<> errorDistribution;
+        const auto errorRoll = errorDistribution(mRandomEngine);
+
+        if (errorRoll < mOptions.mErrorLimitRate)
+        {
+            mErrorLimitRemain = 0;
+            respondWithError(event, errorLimitCode, QStringLiteral("This software has exceeded the error limit for ESI."));
+            return;
+        }
+
+        if (errorRoll < mOptions.mErrorLimitRate + mOptions.mServerErrorRate)
+        {
+            const std::array<int, 3> serverErrors = { 502, 503, 504 };
+            std::uniform_int_distribution<std::size_t> statusDistribution{0, serverErrors.size() - 1};
+
+            --mErrorLimitRemain;
+            respondWithError(event, serverErrors[statusDistribution(mRandomEngine)], QStringLiteral("Injected server error"));
+            return;
+        }
+
+        const auto page = QUrlQuery{event->url}.queryItemValue(QStringLiteral("page")).toUInt();
+        if (mOptions.mMaxPages != 0 && page > mOptions.mMaxPages)
+        {
+            --mErrorLimitRemain;
+            respondWithError(event, notFoundCode, QStringLiteral("Requested page does not exist!"));
+            return;
+        }
+
+        ESIFixtureStore::Fixture fixture;
+        if (!mFixtures.find(event->url, fixture))
+        {
+            qWarning() << "Missing ESI fixture:" << ESIFixtureStore::getKey(event->url);
+
+            --mErrorLimitRemain;
+            respondWithError(event, notFoundCode, QStringLiteral("No fixture recorded for this request"));
+            return;
+        }
+
+        const auto pages = (mOptions.mMaxPages != 0 && fixture.mPages > mOptions.mMaxPages) ? (mOptions.mMaxPages) : (fixture.mPages);
+
+        const auto eTag = getHeader(*event, QStringLiteral("If-None-Match"));
+        if (!fixture.mETag.isEmpty() && eTag == QString::fromLatin1(fixture.mETag))
+            respond(event, notModifiedCode, QByteArray{}, fixture.mETag, pages);
+        else
+            respond(event, okCode, fixture.mData, fixture.mETag, pages);
+    }
+
+    void ESIReplayService::respond(QxtWebRequestEvent *event, int status, const QByteArray &body, const QByteArray &eTag, uint pages)
+    {
+        Q_ASSERT(event != nullptr);
+
+        const auto pageEvent = new QxtWebPageEvent{event->sessionID, event->requestID, body};
+        pageEvent->status = status;
+        pageEvent->statusMessage = getStatusMessage(status);
+        pageEvent->contentType = QByteArrayLiteral("application/json; charset=UTF-8");
+
+        // expire right away - cached replies would make runs depend on each other
+        pageEvent->headers.insert(QStringLiteral("Expires"),
+                                  QLocale::c().toString(QDateTime::currentDateTimeUtc(), QStringLiteral("ddd, dd MMM yyyy hh:mm:ss 'GMT'")));
+        pageEvent->headers.insert(QStringLiteral("X-Esi-Error-Limit-Remain"), QString::number(mErrorLimitRemain));
+        pageEvent->headers.insert(QStringLiteral("X-Esi-Error-Limit-Reset"),
+                                  QString::number(std::max(QDateTime::currentDateTimeUtc().secsTo(mErrorLimitReset), 0ll)));
+
+        if (!eTag.isEmpty())
+            pageEvent->headers.insert(QStringLiteral("ETag"), QString::fromLatin1(eTag));
+        if (pages > 0)
+            pageEvent->headers.insert(QStringLiteral("X-Pages"), QString::number(pages));
+
+        if (mOptions.mLatency.count() > 0)
+        {
+            QTimer::singleShot(mOptions.mLatency, this, [=] {
+                postEvent(pageEvent);
+            });
+        }
+        else
+        {
+            postEvent(pageEvent);
+        }
+    }
+
+    void ESIReplayService::respondWithError(QxtWebRequestEvent *event, int status, const QString &error)
+    {
+        QJsonObject body;
+        body[QStringLiteral("error")] = error;
+
+        respond(event, status, QJsonDocument{body}.toJson(QJsonDocument::Compact));
+    }
+
+    void ESIReplayService::updateErrorLimit()
+    {
+        const auto now = QDateTime::currentDateTimeUtc();
+        if (mErrorLimitReset.isValid() && mErrorLimitReset > now)
+            return;
+
+        mErrorLimitRemain = mOptions.mErrorLimit;
+        mErrorLimitReset = now.addSecs(mOptions.mErrorLimitWindow.count());
+    }
+
+    QByteArray ESIReplayService::getStatusMessage(int status)
+    {
+        switch (status) {
+        case okCode:
+            return QByteArrayLiteral("OK");
+        case notModifiedCode:
+            return QByteArrayLiteral("Not Modified");
+        case notFoundCode:
+            return QByteArrayLiteral("Not Found");
+        case errorLimitCode:
+            return QByteArrayLiteral("Error Limited");
+        case 502:
+            return QByteArrayLiteral("Bad Gateway");
+        case 503:
+            return QByteArrayLiteral("Service Unavailable");
+        case 504:
+            return QByteArrayLiteral("Gateway Timeout");
+        default:
+            return QByteArray{};
+        }
+    }
+
+    QString ESIReplayService::getHeader(const QxtWebRequestEvent &event, const QString &name)
+    {
+        for (auto header = std::begin(event.headers); header != std::end(event.headers); ++header)
+        {
+            if (header.key().compare(name, Qt::CaseInsensitive) == 0)
+                return header.value();
+        }
+
+        return QString{};
+    }
+}
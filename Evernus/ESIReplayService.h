@@ -0,0 +1,78 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <random>
+
+#include <QDateTime>
+
+#include "qxtabstractwebservice.h"
+
+#include "ESIFixtureStore.h"
+
+class QxtWebRequestEvent;
+
+namespace Evernus
+{
+    // stand-in for ESI, serving recorded fixtures - for exercising imports offline
+    // error rates are fractions of all requests; the random sequence is fixed, so runs are reproducible
+    class ESIReplayService
+        : public QxtAbstractWebService
+    {
+        Q_OBJECT
+
+    public:
+        struct Options
+        {
+            std::chrono::milliseconds mLatency{0};
+            uint mMaxPages = 0; // 0 - all recorded
+            double mServerErrorRate = 0.;
+            double mErrorLimitRate = 0.;
+            uint mErrorLimit = 100;
+            std::chrono::seconds mErrorLimitWindow{60};
+        };
+
+        ESIReplayService(const QString &fixturePath,
+                         const Options &options,
+                         QxtAbstractWebSessionManager *sm,
+                         QObject *parent = nullptr);
+        virtual ~ESIReplayService() = default;
+
+        virtual void pageRequestedEvent(QxtWebRequestEvent *event) override;
+
+    private:
+        static const int okCode = 200;
+        static const int notModifiedCode = 304;
+        static const int notFoundCode = 404;
+        static const int errorLimitCode = 420;
+
+        ESIFixtureStore mFixtures;
+        Options mOptions;
+
+        std::mt19937 mRandomEngine;
+
+        uint mErrorLimitRemain = 0;
+        QDateTime mErrorLimitReset;
+
+        void respond(QxtWebRequestEvent *event, int status, const QByteArray &body, const QByteArray &eTag = QByteArray{}, uint pages = 0);
+        void respondWithError(QxtWebRequestEvent *event, int status, const QString &error);
+
+        void updateErrorLimit();
+
+        static QByteArray getStatusMessage(int status);
+        static QString getHeader(const QxtWebRequestEvent &event, const QString &name);
+    };
+}
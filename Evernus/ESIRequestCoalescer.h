@@ -0,0 +1,64 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+#include <QDateTime>
+#include <QString>
+#include <QHash>
+
+#include "ESIRequestPriority.h"
+
+namespace Evernus
+{
+    // attaches callers to an identical request which is already running, so it goes to ESI only once
+    // requests are keyed by url and parameters; callers never wait on a request with lower priority than their own
+    template<class T>
+    class ESIRequestCoalescer final
+    {
+    public:
+        using Callback = std::function<void (T &&data, const QString &error, const QDateTime &expires)>;
+
+        ESIRequestCoalescer() = default;
+        ESIRequestCoalescer(const ESIRequestCoalescer &) = delete;
+        ESIRequestCoalescer(ESIRequestCoalescer &&) = delete;
+        ~ESIRequestCoalescer() = default;
+
+        // returns the callback to finish the new request with, or an empty one if the caller got attached to a running request
+        // every caller gets called once, with the first result
+        Callback attach(const QString &key, ESIRequestPriority priority, const Callback &callback);
+
+        ESIRequestCoalescer &operator =(const ESIRequestCoalescer &) = delete;
+        ESIRequestCoalescer &operator =(ESIRequestCoalescer &&) = delete;
+
+    private:
+        struct Request
+        {
+            std::vector<Callback> mCallbacks;
+            ESIRequestPriority mPriority = ESIRequestPriority::Interactive;
+        };
+
+        std::mutex mRequestMutex;
+        QHash<QString, std::shared_ptr<Request>> mRequests;
+
+        void finish(const QString &key, const std::shared_ptr<Request> &request, T &&data, const QString &error, const QDateTime &expires);
+    };
+}
+
+#include "ESIRequestCoalescer.inl"
@@ -0,0 +1,76 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <utility>
+
+#include <QtDebug>
+
+namespace Evernus
+{
+    template<class T>
+    typename ESIRequestCoalescer<T>::Callback ESIRequestCoalescer<T>::attach(const QString &key, ESIRequestPriority priority, const Callback &callback)
+    {
+        std::lock_guard<std::mutex> lock{mRequestMutex};
+
+        auto &request = mRequests[key];
+        // a lower priority one could be queued behind everything else - start our own, which later callers will join
+        if (request && request->mPriority <= priority)
+        {
+            qDebug() << "Attaching to running request:" << key;
+
+            request->mCallbacks.emplace_back(callback);
+            return Callback{};
+        }
+
+        request = std::make_shared<Request>();
+        request->mCallbacks.emplace_back(callback);
+        request->mPriority = priority;
+
+        return [=, request = request](T &&data, const QString &error, const QDateTime &expires) {
+            finish(key, request, std::move(data), error, expires);
+        };
+    }
+
+    template<class T>
+    void ESIRequestCoalescer<T>::finish(const QString &key,
+                                        const std::shared_ptr<Request> &request,
+                                        T &&data,
+                                        const QString &error,
+                                        const QDateTime &expires)
+    {
+        std::vector<Callback> callbacks;
+
+        {
+            std::lock_guard<std::mutex> lock{mRequestMutex};
+
+            // a newer request might be running for the same key already
+            const auto it = mRequests.find(key);
+            if (it != std::end(mRequests) && *it == request)
+                mRequests.erase(it);
+
+            callbacks.swap(request->mCallbacks);
+        }
+
+        if (callbacks.empty())
+            return;
+
+        for (std::size_t i = 0; i < callbacks.size() - 1; ++i)
+        {
+            auto copy = data;
+            callbacks[i](std::move(copy), error, expires);
+        }
+
+        callbacks.back()(std::move(data), error, expires);
+    }
+}
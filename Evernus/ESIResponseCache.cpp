@@ -0,0 +1,369 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <vector>
+
+#include <QCryptographicHash>
+#include <QtConcurrent>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QSettings>
+#include <QFileInfo>
+#include <QtDebug>
+#include <QFile>
+
+#include "CacheSettings.h"
+
+#include "ESIResponseCache.h"
+
+namespace Evernus
+{
+    const quint32 ESIResponseCache::formatVersion;
+
+    ESIResponseCache::ESIResponseCache(const QString &path)
+        : mDirectory{path}
+    {
+        mWriterThread.setMaxThreadCount(1);
+        mWriterThread.setExpiryTimeout(-1);
+
+        if (!mDirectory.mkpath(QStringLiteral(".")))
+            qWarning() << "Cannot create ESI response cache directory:" << path;
+
+        // only headers are read here, bodies wait until needed
+        const auto files = mDirectory.entryInfoList(QDir::Files);
+        for (const auto &fileInfo : files)
+        {
+            QFile file{fileInfo.filePath()};
+
+            QString key;
+            Entry entry;
+
+            auto valid = file.open(QIODevice::ReadOnly);
+            if (valid)
+            {
+                QDataStream stream{&file};
+                valid = readHeader(stream, key, entry) && getFileName(key) == fileInfo.fileName();
+            }
+
+            file.close();
+
+            if (!valid)
+            {
+                QFile::remove(fileInfo.filePath());
+                continue;
+            }
+
+            entry.mSize = fileInfo.size();
+            entry.mLastUsed = fileInfo.lastModified();
+
+            mEntries[fileInfo.fileName()] = entry;
+            mTotalSize += entry.mSize;
+        }
+
+        handleNewPreferences();
+    }
+
+    ESIResponseCache::~ESIResponseCache()
+    {
+        mWriterThread.waitForDone();
+    }
+
+    bool ESIResponseCache::find(const QString &key, Response &response)
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        const auto entry = mEntries.find(getFileName(key));
+        if (entry == std::end(mEntries))
+            return false;
+
+        const auto now = QDateTime::currentDateTimeUtc();
+
+        // expired ones are kept, since they might get refreshed
+        if (!entry->mExpires.isValid() || entry->mExpires <= now)
+            return false;
+
+        entry->mLastUsed = now;
+
+        response.mETag = entry->mETag;
+        response.mExpires = entry->mExpires;
+        response.mPages = entry->mPages;
+
+        return true;
+    }
+
+    QByteArray ESIResponseCache::getETag(const QString &key) const
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        const auto entry = mEntries.constFind(getFileName(key));
+        return (entry == std::end(mEntries)) ? (QByteArray{}) : (entry->mETag);
+    }
+
+    bool ESIResponseCache::read(const QString &key, QByteArray &data)
+    {
+        const auto fileName = getFileName(key);
+
+        quint64 version = 0;
+
+        {
+            std::lock_guard<std::mutex> lock{mCacheMutex};
+
+            const auto entry = mEntries.constFind(fileName);
+            if (entry == std::end(mEntries))
+                return false;
+
+            // not written yet
+            if (!entry->mPendingData.isEmpty())
+            {
+                data = entry->mPendingData;
+                return true;
+            }
+
+            version = entry->mVersion;
+        }
+
+        QFile file{mDirectory.filePath(fileName)};
+        if (file.open(QIODevice::ReadOnly))
+        {
+            QDataStream stream{&file};
+
+            QString storedKey;
+            Entry header;
+            QByteArray body;
+
+            if (readHeader(stream, storedKey, header) && storedKey == key)
+            {
+                stream >> body;
+                if (stream.status() == QDataStream::Ok)
+                {
+                    data = qUncompress(body);
+                    if (!data.isEmpty())
+                        return true;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        // don't drop something written in the meantime
+        const auto entry = mEntries.constFind(fileName);
+        if (entry != std::end(mEntries) && entry->mVersion == version)
+            remove(fileName);
+
+        return false;
+    }
+
+    void ESIResponseCache::insert(const QString &key, const Response &response)
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        if (mMaxSize == 0)
+            return;
+
+        const auto fileName = getFileName(key);
+
+        auto &entry = mEntries[fileName];
+        entry.mLastUsed = QDateTime::currentDateTimeUtc();
+        entry.mExpires = response.mExpires;
+        entry.mETag = response.mETag;
+        entry.mPages = response.mPages;
+        entry.mPendingData = response.mData;
+        entry.mVersion = ++mNextVersion;
+
+        scheduleWrite(key, fileName, entry, false);
+    }
+
+    void ESIResponseCache::refresh(const QString &key, const QDateTime &expires)
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        const auto fileName = getFileName(key);
+        const auto entry = mEntries.find(fileName);
+        if (entry == std::end(mEntries))
+            return;
+
+        entry->mExpires = expires;
+        entry->mVersion = ++mNextVersion;
+
+        // the body is the same, unless it hasn't been written yet
+        scheduleWrite(key, fileName, *entry, entry->mPendingData.isEmpty());
+    }
+
+    void ESIResponseCache::erase(const QString &key)
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+        remove(getFileName(key));
+    }
+
+    void ESIResponseCache::clear()
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        const auto fileNames = mEntries.keys();
+        for (const auto &fileName : fileNames)
+            remove(fileName);
+    }
+
+    void ESIResponseCache::handleNewPreferences()
+    {
+        QSettings settings;
+
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        mMaxSize = settings.value(CacheSettings::esiResponseCacheSizeKey, CacheSettings::esiResponseCacheSizeDefault).toLongLong() * 1024 * 1024;
+        if (mMaxSize == 0)
+        {
+            const auto fileNames = mEntries.keys();
+            for (const auto &fileName : fileNames)
+                remove(fileName);
+        }
+        else
+        {
+            evict();
+        }
+    }
+
+    void ESIResponseCache::scheduleWrite(const QString &key, const QString &fileName, const Entry &entry, bool headerOnly)
+    {
+        QtConcurrent::run(&mWriterThread, [=, version = entry.mVersion] {
+            const auto filePath = mDirectory.filePath(fileName);
+
+            auto written = true;
+
+            QByteArray body;
+            if (headerOnly)
+            {
+                // keep the compressed body from the previous write
+                QFile file{filePath};
+                written = file.open(QIODevice::ReadOnly);
+
+                if (written)
+                {
+                    QDataStream stream{&file};
+
+                    QString storedKey;
+                    Entry header;
+
+                    written = readHeader(stream, storedKey, header) && storedKey == key;
+                    if (written)
+                    {
+                        stream >> body;
+                        written = stream.status() == QDataStream::Ok;
+                    }
+                }
+            }
+            else
+            {
+                body = qCompress(entry.mPendingData);
+            }
+
+            if (written)
+            {
+                QSaveFile file{filePath};
+                written = file.open(QIODevice::WriteOnly);
+
+                if (written)
+                {
+                    QDataStream stream{&file};
+                    stream << formatVersion << key << entry.mExpires << entry.mPages << entry.mETag << body;
+
+                    written = stream.status() == QDataStream::Ok && file.commit();
+                }
+            }
+
+            if (!written)
+                qWarning() << "Cannot write ESI response cache:" << filePath;
+
+            std::lock_guard<std::mutex> lock{mCacheMutex};
+
+            const auto current = mEntries.find(fileName);
+            if (current == std::end(mEntries) || current->mVersion != version)
+                return;
+
+            if (!written)
+            {
+                remove(fileName);
+                return;
+            }
+
+            const auto size = QFileInfo{filePath}.size();
+
+            current->mPendingData.clear();
+
+            mTotalSize += size - current->mSize;
+            current->mSize = size;
+
+            evict();
+        });
+    }
+
+    void ESIResponseCache::remove(const QString &fileName)
+    {
+        const auto entry = mEntries.find(fileName);
+        if (entry == std::end(mEntries))
+            return;
+
+        mTotalSize -= entry->mSize;
+        mEntries.erase(entry);
+
+        // after any pending write of the same file
+        QtConcurrent::run(&mWriterThread, [=, filePath = mDirectory.filePath(fileName)] {
+            QFile::remove(filePath);
+        });
+    }
+
+    void ESIResponseCache::evict()
+    {
+        if (mTotalSize <= mMaxSize)
+            return;
+
+        std::vector<std::pair<QDateTime, QString>> entries;
+        entries.reserve(mEntries.size());
+
+        for (auto entry = std::begin(mEntries); entry != std::end(mEntries); ++entry)
+            entries.emplace_back(entry->mLastUsed, entry.key());
+
+        std::sort(std::begin(entries), std::end(entries));
+
+        // make some room, so we don't evict on every insert
+        const auto targetSize = mMaxSize / 4 * 3;
+        for (const auto &entry : entries)
+        {
+            if (mTotalSize <= targetSize)
+                break;
+
+            remove(entry.second);
+        }
+
+        qDebug() << "ESI response cache size after eviction:" << mTotalSize;
+    }
+
+    bool ESIResponseCache::readHeader(QDataStream &stream, QString &key, Entry &entry)
+    {
+        quint32 version = 0;
+
+        stream >> version;
+        if (version != formatVersion)
+            return false;
+
+        stream >> key >> entry.mExpires >> entry.mPages >> entry.mETag;
+        return stream.status() == QDataStream::Ok;
+    }
+
+    QString ESIResponseCache::getFileName(const QString &key)
+    {
+        return QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex());
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <mutex>
+
+#include <QThreadPool>
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QHash>
+#include <QDir>
+
+class QDataStream;
+
+namespace Evernus
+{
+    // size-bounded on-disk cache of ESI replies, valid until their Expires time
+    // bodies are stored compressed, one file per request
+    // everything else is kept in memory, so lookups don't touch the disk; writes happen in the background
+    class ESIResponseCache final
+    {
+    public:
+        struct Response
+        {
+            // reply body, or the decoded page for conditional requests
+            QByteArray mData;
+            QByteArray mETag;
+            QDateTime mExpires;
+            uint mPages = 0;
+        };
+
+        explicit ESIResponseCache(const QString &path);
+        ESIResponseCache(const ESIResponseCache &) = delete;
+        ESIResponseCache(ESIResponseCache &&) = delete;
+        ~ESIResponseCache();
+
+        // only finds unexpired responses and doesn't fill mData - use read() for that
+        bool find(const QString &key, Response &response);
+        // expired responses count too, so they can be revalidated with If-None-Match; empty if unknown
+        QByteArray getETag(const QString &key) const;
+        // reads the body from disk, so better keep it off the GUI thread; false if it's gone
+        bool read(const QString &key, QByteArray &data);
+        void insert(const QString &key, const Response &response);
+        // for responses confirmed to be unchanged
+        void refresh(const QString &key, const QDateTime &expires);
+        void erase(const QString &key);
+
+        void clear();
+
+        void handleNewPreferences();
+
+        ESIResponseCache &operator =(const ESIResponseCache &) = delete;
+        ESIResponseCache &operator =(ESIResponseCache &&) = delete;
+
+    private:
+        struct Entry
+        {
+            qint64 mSize = 0;
+            QDateTime mLastUsed;
+            QDateTime mExpires;
+            QByteArray mETag;
+            uint mPages = 0;
+            // body which isn't on disk yet
+            QByteArray mPendingData;
+            // changes on every write, so only the newest one gets accounted for
+            quint64 mVersion = 0;
+        };
+
+        static const quint32 formatVersion = 2;
+
+        QDir mDirectory;
+
+        mutable std::mutex mCacheMutex;
+        QHash<QString, Entry> mEntries;
+        qint64 mTotalSize = 0;
+        qint64 mMaxSize = 0;
+        quint64 mNextVersion = 0;
+
+        // single thread, so writes and removals of a file happen in order
+        QThreadPool mWriterThread;
+
+        // mCacheMutex must be held for the following
+        void scheduleWrite(const QString &key, const QString &fileName, const Entry &entry, bool headerOnly);
+        void remove(const QString &fileName);
+        void evict();
+
+        static bool readHeader(QDataStream &stream, QString &key, Entry &entry);
+        static QString getFileName(const QString &key);
+    };
+}
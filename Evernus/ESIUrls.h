@@ -20,8 +20,13 @@ namespace Evernus
 {
     namespace ESIUrls
     {
-        const auto esiUrl = QStringLiteral("https://esi.evetech.net");
+        const auto defaultESIUrl = QStringLiteral("https://esi.evetech.net");
         const auto callbackUrl = QStringLiteral("https://slysmoke.github.io/evernus-auth/index.html#/");
         const auto verifyUrl = QStringLiteral("https://login.eveonline.com/oauth/verify");
+
+        // can point at a stand-in server; should be set before any requests are made
+        // authenticated requests ignore it and always go to defaultESIUrl
+        QString getESIUrl();
+        void setESIUrl(QString url);
     }
 }
@@ -29,7 +29,7 @@ namespace Evernus
     ESIWholeExternalOrderImporter::ESIWholeExternalOrderImporter(const EveDataProvider &dataProvider,
                                                                  ESIInterfaceManager &interfaceManager,
                                                                  QObject *parent)
-        : ESIExternalOrderImporter{dataProvider, interfaceManager, parent}
+        : ESIExternalOrderImporter{dataProvider, interfaceManager, ESIRequestPriority::BackgroundRefresh, parent}
         , mDataProvider{dataProvider}
     {
     }
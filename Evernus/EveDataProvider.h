@@ -26,6 +26,7 @@
 
 #include "CitadelRepository.h"
 #include "MarketGroup.h"
+#include "RouteType.h"
 #include "MetaGroup.h"
 #include "EveType.h"
 
@@ -126,7 +127,12 @@ namespace Evernus
 
         virtual uint getGroupId(const QString &name) const = 0;
 
+        // jumps within a region, as used by order ranges
         virtual uint getDistance(uint startSystem, uint endSystem) const = 0;
+        // jumps across the whole universe
+        virtual uint getRouteLength(uint startSystem, uint endSystem, RouteType type = RouteType::Shortest) const = 0;
+        virtual std::vector<uint> getRouteLengths(uint startSystem, const std::vector<uint> &endSystems, RouteType type = RouteType::Shortest) const = 0;
+        virtual std::vector<uint> getRoute(uint startSystem, uint endSystem, RouteType type = RouteType::Shortest) const = 0;
 
         virtual QString getRaceName(uint raceId) const = 0;
         virtual QString getBloodlineName(uint bloodlineId) const = 0;
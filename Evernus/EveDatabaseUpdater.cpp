@@ -13,6 +13,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <QNetworkRequest>
+#include <QSqlDatabase>
 #include <QDesktopWidget>
 #include <QNetworkReply>
 #include <QJsonDocument>
@@ -25,6 +26,7 @@
 #include <QtDebug>
 
 #include "EveDatabaseConnectionProvider.h"
+#include "CachingEveDataProvider.h"
 #include "UpdaterSettings.h"
 #include "ReplyTimeout.h"
 #include "FileDownload.h"
@@ -95,11 +97,33 @@ namespace Evernus
                 QSettings settings;
                 settings.setValue(UpdaterSettings::sdeVersionKey, latestVersion);
 
+                updateStaticData();
+
                 QCoreApplication::exit();
             }
         });
     }
 
+    void EveDatabaseUpdater::updateStaticData()
+    {
+        const auto connectionName = QStringLiteral("sde-update");
+
+        {
+            auto db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+            db.setDatabaseName(EveDatabaseConnectionProvider::getDatabasePath());
+            db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+
+            const auto cacheDir = CachingEveDataProvider::getCacheDir();
+            cacheDir.mkpath(QStringLiteral("."));
+
+            // not fatal - the application compiles the pack on startup if it's missing or stale
+            if (!db.open() || !StaticDataPack::write(cacheDir.filePath(CachingEveDataProvider::staticDataCacheFileName), db))
+                qWarning() << "Cannot compile static data pack.";
+        }
+
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+
     void EveDatabaseUpdater::checkUpdate(QNetworkReply &reply)
     {
         const auto error = reply.error();
@@ -53,6 +53,7 @@ namespace Evernus
         virtual ~EveDatabaseUpdater() = default;
 
         void doUpdate(const QString &latestVersion);
+        void updateStaticData();
         void checkUpdate(QNetworkReply &reply);
     };
 }
@@ -47,6 +47,7 @@
 
 #include "StandardExceptionQtWrapperException.h"
 #include "ExternalOrderImporterNames.h"
+#include "PreparedStatementCache.h"
 #include "LanguageSelectDialog.h"
 #include "SovereigntyStructure.h"
 #include "StatisticsSettings.h"
@@ -56,6 +57,9 @@
 #include "WalletSettings.h"
 #include "PriceSettings.h"
 #include "OrderSettings.h"
+#include "QueryProfiler.h"
+#include "CacheSettings.h"
+#include "CacheMonitor.h"
 #include "PathSettings.h"
 #include "HttpSettings.h"
 #include "SyncSettings.h"
@@ -121,6 +125,8 @@ namespace Evernus
             setApplicationVersion(forcedVersion);
 
         setProxySettings();
+        setQueryProfilerSettings();
+        setCacheSettings();
 
 #ifdef EVERNUS_DROPBOX_ENABLED
         if (settings.value(SyncSettings::enabledOnStartupKey, SyncSettings::enabledOnStartupDefault).toBool())
@@ -182,9 +188,14 @@ namespace Evernus
         precacheCacheTimers();
         precacheUpdateTimers();
 
+        showSplashMessage(tr("Loading static data..."), splash);
+        mDataProvider->precacheStaticData();
+
         showSplashMessage(tr("Precaching jump map..."), splash);
         mDataProvider->precacheJumpMap();
 
+        mDataProvider->reloadOrderBook();
+
         showSplashMessage(tr("Clearing old wallet entries..."), splash);
         deleteOldWalletEntries();
 
@@ -248,6 +259,15 @@ namespace Evernus
     EvernusApplication::~EvernusApplication()
     {
         QThreadPool::globalInstance()->waitForDone();
+        mMainDatabaseWriteQueue.waitForDone();
+
+        const auto statementStats = PreparedStatementCache::getStats();
+        qDebug() << "Prepared statement cache hits:" << statementStats.mHits
+                 << "misses:" << statementStats.mMisses
+                 << "evictions:" << statementStats.mEvictions;
+
+        // statements must be finalized while the sql drivers are still around
+        PreparedStatementCache::clearAll();
     }
 
     void EvernusApplication::registerImporter(const std::string &name, std::unique_ptr<ExternalOrderImporter> &&importer)
@@ -1223,13 +1243,14 @@ namespace Evernus
             {
                 mDataProvider->clearCitadelCache();
 
-                asyncExecute([=, citadels = std::move(citadels)] {
+                mMainDatabaseWriteQueue.enqueue([=, citadels = std::move(citadels)] {
                     QSettings settings;
 
                     mCitadelRepository->replace(std::move(citadels), settings.value(ImportSettings::clearExistingCitadelsKey, ImportSettings::clearExistingCitadelsDefault).toBool());
                     mExternalOrderRepository->fixMissingData(*mCitadelRepository);
+                    mDataProvider->reloadOrderBook();
                     emit citadelsChanged();
-                });
+                }, DatabaseWriteQueue::TransactionMode::Standalone);
             }
 
             emit taskEnded(task, error);
@@ -1295,6 +1316,10 @@ namespace Evernus
 
     void EvernusApplication::updateExternalOrdersAndAssetValue(const std::vector<ExternalOrder> &orders)
     {
+        TypeLocationPairs typeRegions;
+        for (const auto &order : orders)
+            typeRegions.emplace(std::make_pair(order.getTypeId(), order.getRegionId()));
+
         auto watcher = new QFutureWatcher<void>{this};
         connect(watcher, &QFutureWatcher<void>::finished, this, [=] {
             QSettings settings;
@@ -1305,10 +1330,11 @@ namespace Evernus
                     computeAssetListSellValueSnapshot(*list);
             }
 
-            emit externalOrdersChanged();
+            emit externalOrdersChangedForTypes(typeRegions);
         });
 
-        watcher->setFuture(asyncExecute(std::bind(&CachingEveDataProvider::updateExternalOrders, mDataProvider.get(), orders)));
+        watcher->setFuture(mMainDatabaseWriteQueue.enqueue(std::bind(&CachingEveDataProvider::updateExternalOrders, mDataProvider.get(), orders),
+                                                           DatabaseWriteQueue::TransactionMode::Standalone));
     }
 
     void EvernusApplication::handleNewPreferences()
@@ -1317,6 +1343,8 @@ namespace Evernus
         updateTranslator(settings.value(UISettings::languageKey).toString());
 
         setProxySettings();
+        setQueryProfilerSettings();
+        setCacheSettings();
 
         mHttpSessionManager.shutdown();
         mHttpSessionManager.setPort(settings.value(HttpSettings::portKey, HttpSettings::portDefault).value<quint16>());
@@ -1326,6 +1354,7 @@ namespace Evernus
 
         mCharacterItemCostCache.clear();
         mDataProvider->handleNewPreferences();
+        mESIInterfaceManager->handleNewPreferences();
 
         setSmtpSettings();
 
@@ -2619,7 +2648,8 @@ namespace Evernus
     template<class T, class Data>
     QFuture<void> EvernusApplication::asyncBatchStore(const T &repo, Data data, bool hasId)
     {
-        return asyncExecute(std::bind(&T::template batchStore<Data>, &repo, std::move(data), hasId, true));
+        // the write queue wraps batched jobs in its own transaction
+        return mMainDatabaseWriteQueue.enqueue(std::bind(&T::template batchStore<Data>, &repo, std::move(data), hasId, false));
     }
 
     template<class T, class Data, class Callback>
@@ -2692,4 +2722,19 @@ namespace Evernus
             QNetworkProxy::setApplicationProxy(QNetworkProxy::NoProxy);
         }
     }
+
+    void EvernusApplication::setQueryProfilerSettings()
+    {
+        QSettings settings;
+        QueryProfiler::setEnabled(settings.value(DbSettings::profileQueriesKey, DbSettings::profileQueriesDefault).toBool());
+        QueryProfiler::setSlowQueryThreshold(std::chrono::milliseconds{
+            settings.value(DbSettings::slowQueryThresholdKey, DbSettings::slowQueryThresholdDefault).toInt()});
+    }
+
+    void EvernusApplication::setCacheSettings()
+    {
+        QSettings settings;
+        CacheMonitor::setTotalBudget(
+            settings.value(CacheSettings::memoryBudgetKey, CacheSettings::memoryBudgetDefault).toULongLong() * 1024 * 1024);
+    }
 }
@@ -42,6 +42,7 @@
 #include "RegionTypePresetRepository.h"
 #include "WalletSnapshotRepository.h"
 #include "ExternalOrderRepository.h"
+#include "DatabaseWriteQueue.h"
 #include "CachingContractProvider.h"
 #include "EveDataManagerProvider.h"
 #include "FavoriteItemRepository.h"
@@ -189,6 +190,7 @@ namespace Evernus
         void characterAssetsChanged();
         void externalOrdersChanged();
         void externalOrdersChangedWithMarketOrders();
+        void externalOrdersChangedForTypes(const TypeLocationPairs &typeRegions);
         void characterWalletJournalChanged();
         void characterWalletTransactionsChanged();
         void characterMarketOrdersChanged();
@@ -280,6 +282,8 @@ namespace Evernus
         MainDatabaseConnectionProvider mMainDatabaseConnectionProvider;
         EveDatabaseConnectionProvider mEveDatabaseConnectionProvider;
 
+        DatabaseWriteQueue mMainDatabaseWriteQueue{mMainDatabaseConnectionProvider};
+
         std::unique_ptr<CharacterRepository> mCharacterRepository;
         std::unique_ptr<ItemRepository> mItemRepository, mCorpItemRepository;
         std::unique_ptr<AssetListRepository> mAssetListRepository, mCorpAssetListRepository;
@@ -430,5 +434,7 @@ namespace Evernus
         static QString getCharacterImportMessage(Character::IdType id);
 
         static void setProxySettings();
+        static void setQueryProfilerSettings();
+        static void setCacheSettings();
     };
 }
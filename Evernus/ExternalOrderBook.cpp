@@ -0,0 +1,261 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <limits>
+
+#include "ExternalOrderBook.h"
+
+namespace Evernus
+{
+    namespace
+    {
+        const auto invalidTime = std::numeric_limits<qint64>::min();
+
+        // per order bytes of all Side columns
+        const auto orderBytes = sizeof(double) +
+                                sizeof(uint) +
+                                sizeof(quint64) +
+                                sizeof(uint) +
+                                sizeof(short) +
+                                sizeof(ExternalOrder::IdType) +
+                                sizeof(qint64) +
+                                sizeof(uint) +
+                                sizeof(uint) +
+                                sizeof(qint64) +
+                                sizeof(short);
+
+        qint64 toMSecs(const QDateTime &dt)
+        {
+            return (dt.isValid()) ? (dt.toMSecsSinceEpoch()) : (invalidTime);
+        }
+
+        QDateTime fromMSecs(qint64 msecs)
+        {
+            return (msecs == invalidTime) ? (QDateTime{}) : (QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC));
+        }
+
+        template<class T>
+        void permute(std::vector<T> &column, const std::vector<std::size_t> &permutation)
+        {
+            std::vector<T> result;
+            result.reserve(column.size());
+
+            for (const auto index : permutation)
+                result.emplace_back(std::move(column[index]));
+
+            column = std::move(result);
+        }
+    }
+
+    const ExternalOrderBook::Side ExternalOrderBook::emptySide{};
+
+    ExternalOrder ExternalOrderBook::Side::getOrder(std::size_t index) const
+    {
+        ExternalOrder order{mIds[index]};
+        order.setType(mType);
+        order.setTypeId(mTypeId);
+        order.setStationId(mStationIds[index]);
+        order.setSolarSystemId(mSolarSystemIds[index]);
+        order.setRegionId(mRegionId);
+        order.setRange(mRanges[index]);
+        order.setUpdateTime(fromMSecs(mUpdateTimes[index]));
+        order.setPrice(mPrices[index]);
+        order.setVolumeEntered(mVolumesEntered[index]);
+        order.setVolumeRemaining(mVolumes[index]);
+        order.setMinVolume(mMinVolumes[index]);
+        order.setIssued(fromMSecs(mIssued[index]));
+        order.setDuration(mDurations[index]);
+        order.setNew(false);
+
+        return order;
+    }
+
+    void ExternalOrderBook::add(const std::vector<ExternalOrder> &orders)
+    {
+        for (const auto &order : orders)
+            addOrder(order);
+    }
+
+    void ExternalOrderBook::sort()
+    {
+        for (auto &partition : mPartitions)
+        {
+            if (partition.second.mSorted)
+                continue;
+
+            sortSide(partition.second.mSell, true);
+            sortSide(partition.second.mBuy, false);
+
+            partition.second.mSorted = true;
+        }
+    }
+
+    void ExternalOrderBook::replace(const TypeLocationPairs &typeRegions, const std::vector<ExternalOrder> &orders)
+    {
+        for (const auto &typeRegion : typeRegions)
+        {
+            const auto it = mPartitions.find(std::make_pair(typeRegion.first, static_cast<uint>(typeRegion.second)));
+            if (it == std::end(mPartitions))
+                continue;
+
+            mSize -= it->second.mSell.size() + it->second.mBuy.size();
+            mPartitions.erase(it);
+        }
+
+        add(orders);
+        sort();
+    }
+
+    void ExternalOrderBook::removeType(EveType::IdType typeId)
+    {
+        for (auto it = std::begin(mPartitions); it != std::end(mPartitions);)
+        {
+            if (it->first.first == typeId)
+            {
+                mSize -= it->second.mSell.size() + it->second.mBuy.size();
+                it = mPartitions.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void ExternalOrderBook::clear()
+    {
+        mPartitions.clear();
+        mSize = 0;
+    }
+
+    const ExternalOrderBook::Side &ExternalOrderBook::getSellOrders(EveType::IdType typeId, uint regionId) const
+    {
+        const auto it = mPartitions.find(std::make_pair(typeId, regionId));
+        return (it == std::end(mPartitions)) ? (emptySide) : (it->second.mSell);
+    }
+
+    const ExternalOrderBook::Side &ExternalOrderBook::getBuyOrders(EveType::IdType typeId, uint regionId) const
+    {
+        const auto it = mPartitions.find(std::make_pair(typeId, regionId));
+        return (it == std::end(mPartitions)) ? (emptySide) : (it->second.mBuy);
+    }
+
+    std::size_t ExternalOrderBook::size() const noexcept
+    {
+        return mSize;
+    }
+
+    std::size_t ExternalOrderBook::getMemoryUsage() const noexcept
+    {
+        // hash nodes hold the key, the value and a next pointer
+        const auto partitionBytes = sizeof(TypeRegionPair) + sizeof(Partition) + sizeof(void *);
+        return mSize * orderBytes + mPartitions.size() * partitionBytes + mPartitions.bucket_count() * sizeof(void *);
+    }
+
+    void ExternalOrderBook::addOrder(const ExternalOrder &order)
+    {
+        auto &partition = mPartitions[std::make_pair(order.getTypeId(), order.getRegionId())];
+        auto &side = (order.getType() == ExternalOrder::Type::Buy) ? (partition.mBuy) : (partition.mSell);
+
+        side.mPrices.emplace_back(order.getPrice());
+        side.mVolumes.emplace_back(order.getVolumeRemaining());
+        side.mStationIds.emplace_back(order.getStationId());
+        side.mSolarSystemIds.emplace_back(order.getSolarSystemId());
+        side.mRanges.emplace_back(order.getRange());
+        side.mIds.emplace_back(order.getId());
+        side.mUpdateTimes.emplace_back(toMSecs(order.getUpdateTime()));
+        side.mVolumesEntered.emplace_back(order.getVolumeEntered());
+        side.mMinVolumes.emplace_back(order.getMinVolume());
+        side.mIssued.emplace_back(toMSecs(order.getIssued()));
+        side.mDurations.emplace_back(order.getDuration());
+
+        side.mTypeId = order.getTypeId();
+        side.mRegionId = order.getRegionId();
+        side.mType = order.getType();
+
+        partition.mSorted = false;
+        ++mSize;
+    }
+
+    void ExternalOrderBook::sortSide(Side &side, bool ascending)
+    {
+        std::vector<std::size_t> permutation(side.size());
+        std::iota(std::begin(permutation), std::end(permutation), 0);
+
+        const auto &prices = side.mPrices;
+        if (ascending)
+        {
+            std::stable_sort(std::begin(permutation), std::end(permutation), [&](auto a, auto b) {
+                return prices[a] < prices[b];
+            });
+        }
+        else
+        {
+            std::stable_sort(std::begin(permutation), std::end(permutation), [&](auto a, auto b) {
+                return prices[a] > prices[b];
+            });
+        }
+
+        permute(side.mPrices, permutation);
+        permute(side.mVolumes, permutation);
+        permute(side.mStationIds, permutation);
+        permute(side.mSolarSystemIds, permutation);
+        permute(side.mRanges, permutation);
+        permute(side.mIds, permutation);
+        permute(side.mUpdateTimes, permutation);
+        permute(side.mVolumesEntered, permutation);
+        permute(side.mMinVolumes, permutation);
+        permute(side.mIssued, permutation);
+        permute(side.mDurations, permutation);
+    }
+
+    ExternalOrderBookMonitor::ExternalOrderBookMonitor(QString name)
+        : mName{std::move(name)}
+    {
+        CacheMonitor::registerCache(*this, 0);
+    }
+
+    ExternalOrderBookMonitor::~ExternalOrderBookMonitor()
+    {
+        CacheMonitor::unregisterCache(*this);
+    }
+
+    CacheMonitor::CacheStats ExternalOrderBookMonitor::getStats() const
+    {
+        CacheMonitor::CacheStats stats;
+        stats.mName = mName;
+        stats.mEntries = mEntries;
+        stats.mBytes = mBytes;
+
+        return stats;
+    }
+
+    void ExternalOrderBookMonitor::resetStats()
+    {
+    }
+
+    void ExternalOrderBookMonitor::setBudget(std::size_t bytes)
+    {
+        Q_UNUSED(bytes);
+    }
+
+    void ExternalOrderBookMonitor::update(const ExternalOrderBook &book) noexcept
+    {
+        mEntries = book.size();
+        mBytes = book.getMemoryUsage();
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <atomic>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "TypeLocationPairs.h"
+#include "ExternalOrder.h"
+#include "CacheMonitor.h"
+
+namespace Evernus
+{
+    // in-memory mirror of external orders, partitioned by type and region
+    class ExternalOrderBook final
+    {
+    public:
+        // struct-of-arrays sorted by price: ascending for sell orders, descending for buy orders
+        struct Side
+        {
+            std::vector<double> mPrices;
+            std::vector<uint> mVolumes;
+            std::vector<quint64> mStationIds;
+            std::vector<uint> mSolarSystemIds;
+            std::vector<short> mRanges;
+            std::vector<ExternalOrder::IdType> mIds;
+            // only needed to rebuild whole orders; times in msecs since epoch, UTC
+            std::vector<qint64> mUpdateTimes;
+            std::vector<uint> mVolumesEntered;
+            std::vector<uint> mMinVolumes;
+            std::vector<qint64> mIssued;
+            std::vector<short> mDurations;
+
+            EveType::IdType mTypeId = 0;
+            uint mRegionId = 0;
+            ExternalOrder::Type mType = ExternalOrder::Type::Sell;
+
+            inline std::size_t size() const noexcept
+            {
+                return mPrices.size();
+            }
+
+            inline bool empty() const noexcept
+            {
+                return mPrices.empty();
+            }
+
+            // for the rare cases where callers need the whole order
+            ExternalOrder getOrder(std::size_t index) const;
+        };
+
+        // bulk loading - call sort() when done
+        void add(const std::vector<ExternalOrder> &orders);
+        void sort();
+
+        // mirrors ExternalOrderRepository::removeObsolete() followed by storing new orders
+        void replace(const TypeLocationPairs &typeRegions, const std::vector<ExternalOrder> &orders);
+        void removeType(EveType::IdType typeId);
+        void clear();
+
+        const Side &getSellOrders(EveType::IdType typeId, uint regionId) const;
+        const Side &getBuyOrders(EveType::IdType typeId, uint regionId) const;
+
+        std::size_t size() const noexcept;
+        // approximate, ignores spare vector capacity
+        std::size_t getMemoryUsage() const noexcept;
+
+    private:
+        using TypeRegionPair = std::pair<EveType::IdType, uint>;
+
+        struct Partition
+        {
+            Side mSell;
+            Side mBuy;
+            bool mSorted = true;
+        };
+
+        static const Side emptySide;
+
+        std::unordered_map<TypeRegionPair, Partition, boost::hash<TypeRegionPair>> mPartitions;
+        std::size_t mSize = 0;
+
+        void addOrder(const ExternalOrder &order);
+
+        static void sortSide(Side &side, bool ascending);
+    };
+
+    // lists an order book in cache statistics; orders can't be evicted, so it doesn't take a share of the budget
+    class ExternalOrderBookMonitor final
+        : public CacheMonitor::MonitoredCache
+    {
+    public:
+        explicit ExternalOrderBookMonitor(QString name);
+        ExternalOrderBookMonitor(const ExternalOrderBookMonitor &) = delete;
+        ExternalOrderBookMonitor(ExternalOrderBookMonitor &&) = delete;
+        virtual ~ExternalOrderBookMonitor();
+
+        virtual CacheMonitor::CacheStats getStats() const override;
+        virtual void resetStats() override;
+        virtual void setBudget(std::size_t bytes) override;
+
+        // call after changing the book, so stats don't need its lock
+        void update(const ExternalOrderBook &book) noexcept;
+
+        ExternalOrderBookMonitor &operator =(const ExternalOrderBookMonitor &) = delete;
+        ExternalOrderBookMonitor &operator =(ExternalOrderBookMonitor &&) = delete;
+
+    private:
+        QString mName;
+        std::atomic<quint64> mEntries{0};
+        std::atomic<quint64> mBytes{0};
+    };
+}
@@ -181,7 +181,7 @@ namespace Evernus
 
         for (const auto &order : mOrders)
         {
-            const auto price = order->getPrice();
+            const auto price = order.getPrice();
             if (price < mMinPrice)
                 mMinPrice = price;
             if (price > mMaxPrice)
@@ -189,10 +189,10 @@ namespace Evernus
 
             prices.emplace_back(price);
 
-            const auto volume = order->getVolumeRemaining();
+            const auto volume = order.getVolumeRemaining();
 
             mTotalPrice += price * volume;
-            mTotalSize += mDataProvider.getTypeVolume(order->getTypeId()) * volume;
+            mTotalSize += mDataProvider.getTypeVolume(order.getTypeId()) * volume;
             mTotalVolume += volume;
         }
 
@@ -218,7 +218,7 @@ namespace Evernus
 
         switch (mGrouping) {
         case Grouping::None:
-            return mOrders[index.row()]->getPrice();
+            return mOrders[index.row()].getPrice();
         case Grouping::Station:
         case Grouping::System:
         case Grouping::Region:
@@ -447,11 +447,11 @@ namespace Evernus
 
         for (const auto &order : mOrders)
         {
-            const auto id = (order.get()->*Func)();
+            const auto id = (order.*Func)();
             auto &curData = data[id];
             curData.mId = id;
 
-            const auto price = order->getPrice();
+            const auto price = order.getPrice();
             if (curData.mLowestPrice > price)
                 curData.mLowestPrice = price;
             if (curData.mHighestPrice < price)
@@ -459,13 +459,13 @@ namespace Evernus
 
             prices[id].emplace_back(price);
 
-            curData.mVolumeEntered += order->getVolumeEntered();
-            curData.mVolumeRemaining += order->getVolumeRemaining();
-            curData.mTotalCost += order->getVolumeRemaining() * price;
+            curData.mVolumeEntered += order.getVolumeEntered();
+            curData.mVolumeRemaining += order.getVolumeRemaining();
+            curData.mTotalCost += order.getVolumeRemaining() * price;
 
             ++curData.mCount;
 
-            curData.mTotalSize += order->getVolumeRemaining() * mDataProvider.getTypeVolume(order->getTypeId());
+            curData.mTotalSize += order.getVolumeRemaining() * mDataProvider.getTypeVolume(order.getTypeId());
         }
 
         mGroupedData.reserve(data.size());
@@ -0,0 +1,649 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string_view>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QByteArray>
+#include <QDateTime>
+
+#include "EveDataProvider.h"
+#include "ExternalOrder.h"
+
+#include "ExternalOrderJsonParser.h"
+
+namespace Evernus
+{
+    namespace
+    {
+        // forward-only cursor over JSON text - string values are returned raw, without unescaping
+        class JsonReader final
+        {
+        public:
+            JsonReader(const char *begin, const char *end) noexcept
+                : mBegin{begin}
+                , mPos{begin}
+                , mEnd{end}
+            {
+            }
+
+            void expect(char c)
+            {
+                if (!consume(c))
+                    fail("unexpected character");
+            }
+
+            bool consume(char c) noexcept
+            {
+                skipWhitespace();
+                if (mPos == mEnd || *mPos != c)
+                    return false;
+
+                ++mPos;
+                return true;
+            }
+
+            void expectEnd()
+            {
+                skipWhitespace();
+                if (mPos != mEnd)
+                    fail("trailing data");
+            }
+
+            std::string_view readString()
+            {
+                expect('"');
+
+                const auto start = mPos;
+                while (mPos != mEnd && *mPos != '"')
+                {
+                    if (*mPos == '\\')
+                    {
+                        ++mPos;
+                        if (mPos == mEnd)
+                            break;
+                    }
+
+                    ++mPos;
+                }
+
+                if (mPos == mEnd)
+                    fail("unterminated string");
+
+                return { start, static_cast<std::size_t>(mPos++ - start) };
+            }
+
+            bool readBool()
+            {
+                skipWhitespace();
+                if (consumeLiteral("true"))
+                    return true;
+                if (consumeLiteral("false"))
+                    return false;
+
+                fail("expected boolean");
+            }
+
+            quint64 readInteger()
+            {
+                skipWhitespace();
+
+                const auto start = mPos;
+
+                // not an unsigned integer - let the general path handle it
+                if (mPos != mEnd && *mPos == '-')
+                    return static_cast<quint64>(std::max(readDouble(), 0.));
+
+                quint64 value = 0;
+                while (mPos != mEnd && isDigit(*mPos))
+                    value = value * 10 + (*mPos++ - '0');
+
+                if (mPos == start)
+                    fail("expected number");
+
+                if (mPos != mEnd && (*mPos == '.' || *mPos == 'e' || *mPos == 'E'))
+                {
+                    mPos = start;
+                    return static_cast<quint64>(readDouble());
+                }
+
+                return value;
+            }
+
+            double readDouble()
+            {
+                skipWhitespace();
+
+                const auto start = mPos;
+                const auto negative = mPos != mEnd && *mPos == '-';
+                if (negative)
+                    ++mPos;
+
+                quint64 mantissa = 0;
+                auto digits = 0;
+                auto exponent = 0;
+
+                while (mPos != mEnd && isDigit(*mPos))
+                {
+                    mantissa = mantissa * 10 + (*mPos++ - '0');
+                    ++digits;
+                }
+
+                if (mPos != mEnd && *mPos == '.')
+                {
+                    ++mPos;
+                    while (mPos != mEnd && isDigit(*mPos))
+                    {
+                        mantissa = mantissa * 10 + (*mPos++ - '0');
+                        ++digits;
+                        --exponent;
+                    }
+                }
+
+                if (digits == 0)
+                    fail("expected number");
+
+                auto hasExponent = false;
+                if (mPos != mEnd && (*mPos == 'e' || *mPos == 'E'))
+                {
+                    hasExponent = true;
+
+                    ++mPos;
+                    while (mPos != mEnd && (isDigit(*mPos) || *mPos == '-' || *mPos == '+'))
+                        ++mPos;
+                }
+
+                // mantissa and power of 10 both exact, so a single operation gives a correctly rounded result
+                if (!hasExponent && digits <= 15 && exponent >= -22)
+                {
+                    const auto value = (exponent == 0) ? (static_cast<double>(mantissa)) : (mantissa / powersOf10[-exponent]);
+                    return (negative) ? (-value) : (value);
+                }
+
+                auto ok = false;
+                const auto value = QByteArray::fromRawData(start, static_cast<int>(mPos - start)).toDouble(&ok);
+                if (!ok)
+                    fail("invalid number");
+
+                return value;
+            }
+
+            void skipValue()
+            {
+                skipWhitespace();
+                if (mPos == mEnd)
+                    fail("unexpected end of data");
+
+                switch (*mPos) {
+                case '"':
+                    readString();
+                    break;
+                case '{':
+                case '[':
+                    skipContainer();
+                    break;
+                case 't':
+                case 'f':
+                    readBool();
+                    break;
+                case 'n':
+                    if (!consumeLiteral("null"))
+                        fail("unexpected literal");
+                    break;
+                default:
+                    readDouble();
+                }
+            }
+
+        private:
+            static const double powersOf10[23];
+
+            const char * const mBegin;
+            const char *mPos;
+            const char * const mEnd;
+
+            void skipWhitespace() noexcept
+            {
+                while (mPos != mEnd && (*mPos == ' ' || *mPos == '\n' || *mPos == '\r' || *mPos == '\t'))
+                    ++mPos;
+            }
+
+            bool consumeLiteral(std::string_view literal) noexcept
+            {
+                if (static_cast<std::size_t>(mEnd - mPos) < literal.size() || std::string_view{mPos, literal.size()} != literal)
+                    return false;
+
+                mPos += literal.size();
+                return true;
+            }
+
+            void skipContainer()
+            {
+                auto depth = 0;
+                do
+                {
+                    if (mPos == mEnd)
+                        fail("unexpected end of data");
+
+                    switch (*mPos) {
+                    case '"':
+                        readString();
+                        continue;
+                    case '{':
+                    case '[':
+                        ++depth;
+                        break;
+                    case '}':
+                    case ']':
+                        --depth;
+                    }
+
+                    ++mPos;
+                } while (depth > 0);
+            }
+
+            [[noreturn]] void fail(const char *message) const
+            {
+                throw std::runtime_error{std::string{message} + " at offset " + std::to_string(mPos - mBegin)};
+            }
+
+            static bool isDigit(char c) noexcept
+            {
+                return c >= '0' && c <= '9';
+            }
+        };
+
+        const double JsonReader::powersOf10[23] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        int toInt(std::string_view value, std::size_t pos, std::size_t length) noexcept
+        {
+            auto result = 0;
+            for (auto i = pos; i < pos + length; ++i)
+            {
+                if (value[i] < '0' || value[i] > '9')
+                    return -1;
+
+                result = result * 10 + (value[i] - '0');
+            }
+
+            return result;
+        }
+
+        QDateTime getDateTime(std::string_view value)
+        {
+            // ESI always uses YYYY-MM-DDTHH:MM:SSZ
+            if (value.size() >= 19)
+            {
+                QDateTime dt{
+                    QDate{toInt(value, 0, 4), toInt(value, 5, 2), toInt(value, 8, 2)},
+                    QTime{toInt(value, 11, 2), toInt(value, 14, 2), toInt(value, 17, 2)},
+                    Qt::UTC
+                };
+
+                if (Q_LIKELY(dt.isValid()))
+                    return dt;
+            }
+
+            auto dt = QDateTime::fromString(QString::fromLatin1(value.data(), static_cast<int>(value.size())), Qt::ISODate);
+            if (Q_UNLIKELY(!dt.isValid()))
+                dt = QDateTime::currentDateTimeUtc();   // just to be safe
+            else
+                dt.setTimeSpec(Qt::UTC);
+
+            return dt;
+        }
+
+        short getRange(std::string_view range) noexcept
+        {
+            if (range == "station")
+                return ExternalOrder::rangeStation;
+            if (range == "system")
+                return ExternalOrder::rangeSystem;
+            if (range == "region")
+                return ExternalOrder::rangeRegion;
+
+            const auto jumps = toInt(range, 0, range.size());
+            return (jumps < 0 || jumps > std::numeric_limits<short>::max()) ? (0) : (static_cast<short>(jumps));
+        }
+    }
+
+    ExternalOrderJsonParser::ExternalOrderJsonParser(const EveDataProvider &dataProvider, uint regionId, QDateTime updateTime)
+        : ESIInterface::PageDecoder{}
+        , mDataProvider{dataProvider}
+        , mRegionId{regionId}
+        , mUpdateTime{std::move(updateTime)}
+    {
+    }
+
+    void ExternalOrderJsonParser::feed(const QByteArray &chunk)
+    {
+        if (mState == State::Failed)
+            return;
+
+        mBuffer.append(chunk);
+        parseBuffer();
+    }
+
+    QString ExternalOrderJsonParser::finish()
+    {
+        if (mState != State::Failed && mState != State::AfterArray)
+            setError(QStringLiteral("unexpected end of data"));
+
+        mBuffer.clear();
+        return mError;
+    }
+
+    bool ExternalOrderJsonParser::isEmpty() const
+    {
+        return mOrders.empty();
+    }
+
+    QByteArray ExternalOrderJsonParser::save() const
+    {
+        QByteArray data;
+        QDataStream stream{&data, QIODevice::WriteOnly};
+
+        stream << static_cast<quint32>(mOrders.size());
+
+        for (const auto &order : mOrders)
+        {
+            stream
+                << order.getId()
+                << static_cast<qint8>(order.getType())
+                << static_cast<quint32>(order.getTypeId())
+                << order.getStationId()
+                << static_cast<quint32>(order.getSolarSystemId())
+                << static_cast<qint16>(order.getRange())
+                << order.getPrice()
+                << static_cast<quint32>(order.getVolumeEntered())
+                << static_cast<quint32>(order.getVolumeRemaining())
+                << static_cast<quint32>(order.getMinVolume())
+                << order.getIssued()
+                << static_cast<qint16>(order.getDuration());
+        }
+
+        return data;
+    }
+
+    bool ExternalOrderJsonParser::load(const QByteArray &data)
+    {
+        QDataStream stream{data};
+
+        quint32 count = 0;
+        stream >> count;
+
+        mOrders.clear();
+
+        for (auto i = 0u; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            quint64 id = 0, stationId = 0;
+            qint8 type = 0;
+            quint32 typeId = 0, solarSystemId = 0, volumeEntered = 0, volumeRemaining = 0, minVolume = 0;
+            qint16 range = 0, duration = 0;
+            double price = 0.;
+            QDateTime issued;
+
+            stream >> id >> type >> typeId >> stationId >> solarSystemId >> range >> price >> volumeEntered >> volumeRemaining >> minVolume >> issued >> duration;
+
+            auto &order = mOrders.emplace_back(id);
+            order.setRegionId(mRegionId);
+            order.setUpdateTime(mUpdateTime);
+            order.setType(static_cast<ExternalOrder::Type>(type));
+            order.setTypeId(typeId);
+            order.setStationId(stationId);
+            order.setSolarSystemId(solarSystemId);
+            order.setRange(range);
+            order.setPrice(price);
+            order.setVolumeEntered(volumeEntered);
+            order.setVolumeRemaining(volumeRemaining);
+            order.setMinVolume(minVolume);
+            order.setIssued(issued);
+            order.setDuration(duration);
+        }
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            mOrders.clear();
+            return false;
+        }
+
+        mState = State::AfterArray;
+        return true;
+    }
+
+    std::vector<ExternalOrder> ExternalOrderJsonParser::takeOrders()
+    {
+        return std::move(mOrders);
+    }
+
+    void ExternalOrderJsonParser::parseBuffer()
+    {
+        const auto isWhitespace = [](char c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        };
+
+        const auto data = mBuffer.constData();
+        const auto size = mBuffer.size();
+
+        auto pos = 0;
+        while (mState != State::Failed)
+        {
+            while (pos < size && isWhitespace(data[pos]))
+                ++pos;
+
+            if (pos == size)
+                break;
+
+            if (mState == State::Element)
+            {
+                const auto end = findElementEnd(pos);
+                if (end < 0)
+                    break;
+
+                parseOrder(data + pos, data + end);
+
+                pos = end;
+                if (mState != State::Failed)
+                    mState = State::AfterElement;
+
+                continue;
+            }
+
+            const auto c = data[pos++];
+            switch (mState) {
+            case State::BeforeArray:
+                if (c == '[')
+                    mState = State::FirstElement;
+                else
+                    setError(QStringLiteral("expected array"));
+                break;
+            case State::FirstElement:
+                if (c == ']')
+                {
+                    mState = State::AfterArray;
+                }
+                else
+                {
+                    --pos;
+                    mState = State::Element;
+                }
+                break;
+            case State::AfterElement:
+                if (c == ',')
+                    mState = State::Element;
+                else if (c == ']')
+                    mState = State::AfterArray;
+                else
+                    setError(QStringLiteral("unexpected character"));
+                break;
+            default:
+                setError(QStringLiteral("trailing data"));
+            }
+        }
+
+        // keep only the incomplete element
+        if (mState == State::Failed)
+        {
+            mBuffer.clear();
+        }
+        else
+        {
+            mBuffer.remove(0, pos);
+            mScanPos -= pos;
+        }
+    }
+
+    int ExternalOrderJsonParser::findElementEnd(int start)
+    {
+        const auto data = mBuffer.constData();
+        const auto size = mBuffer.size();
+
+        // fresh element
+        if (mScanPos <= start)
+        {
+            mScanPos = start;
+            mScanDepth = 0;
+            mScanInString = false;
+        }
+
+        while (mScanPos < size)
+        {
+            const auto c = data[mScanPos++];
+
+            if (mScanInString)
+            {
+                if (c == '\\')
+                {
+                    // escaped character might be in the next chunk
+                    if (mScanPos == size)
+                    {
+                        --mScanPos;
+                        return -1;
+                    }
+
+                    ++mScanPos;
+                }
+                else if (c == '"')
+                {
+                    mScanInString = false;
+                }
+            }
+            else if (c == '"')
+            {
+                mScanInString = true;
+            }
+            else if (c == '{' || c == '[')
+            {
+                ++mScanDepth;
+            }
+            else if (c == '}' || c == ']')
+            {
+                if (--mScanDepth <= 0)
+                {
+                    const auto end = mScanPos;
+                    mScanPos = 0;
+
+                    return end;
+                }
+            }
+            else if (mScanDepth == 0)
+            {
+                // scalars can't be orders
+                setError(QStringLiteral("expected object"));
+                return -1;
+            }
+        }
+
+        return -1;
+    }
+
+    void ExternalOrderJsonParser::parseOrder(const char *begin, const char *end)
+    {
+        try
+        {
+            JsonReader reader{begin, end};
+
+            auto &order = mOrders.emplace_back();
+            order.setRegionId(mRegionId);
+            order.setUpdateTime(mUpdateTime);
+
+            auto hasSolarSystem = false;
+
+            reader.expect('{');
+            if (!reader.consume('}'))
+            {
+                do
+                {
+                    const auto key = reader.readString();
+                    reader.expect(':');
+
+                    if (key == "order_id")
+                        order.setId(reader.readInteger());
+                    else if (key == "is_buy_order")
+                        order.setType((reader.readBool()) ? (ExternalOrder::Type::Buy) : (ExternalOrder::Type::Sell));
+                    else if (key == "type_id")
+                        order.setTypeId(reader.readInteger());
+                    else if (key == "location_id")
+                        order.setStationId(reader.readInteger());
+                    else if (key == "system_id")
+                    {
+                        order.setSolarSystemId(reader.readInteger());
+                        hasSolarSystem = true;
+                    }
+                    else if (key == "range")
+                        order.setRange(getRange(reader.readString()));
+                    else if (key == "price")
+                        order.setPrice(reader.readDouble());
+                    else if (key == "volume_total")
+                        order.setVolumeEntered(reader.readInteger());
+                    else if (key == "volume_remain")
+                        order.setVolumeRemaining(reader.readInteger());
+                    else if (key == "min_volume")
+                        order.setMinVolume(reader.readInteger());
+                    else if (key == "issued")
+                        order.setIssued(getDateTime(reader.readString()));
+                    else if (key == "duration")
+                        order.setDuration(reader.readInteger());
+                    else
+                        reader.skipValue();
+                } while (reader.consume(','));
+
+                reader.expect('}');
+            }
+
+            reader.expectEnd();
+
+            if (!hasSolarSystem)
+                order.setSolarSystemId(mDataProvider.getStationSolarSystemId(order.getStationId()));
+        }
+        catch (const std::exception &e)
+        {
+            setError(QString::fromLatin1(e.what()));
+        }
+    }
+
+    void ExternalOrderJsonParser::setError(const QString &error)
+    {
+        mState = State::Failed;
+        mOrders.clear();
+        mError = QCoreApplication::translate("ExternalOrderJsonParser", "Error parsing market orders: %1").arg(error);
+    }
+}
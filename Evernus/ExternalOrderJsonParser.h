@@ -0,0 +1,84 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+#include "ESIInterface.h"
+
+namespace Evernus
+{
+    class EveDataProvider;
+    class ExternalOrder;
+
+    // decodes ESI market order pages straight into orders, without building a JSON document first
+    // data can be fed in chunks, as it arrives - only the currently incomplete order is buffered
+    class ExternalOrderJsonParser final
+        : public ESIInterface::PageDecoder
+    {
+    public:
+        ExternalOrderJsonParser(const EveDataProvider &dataProvider, uint regionId, QDateTime updateTime);
+        ExternalOrderJsonParser(const ExternalOrderJsonParser &) = default;
+        ExternalOrderJsonParser(ExternalOrderJsonParser &&) = default;
+        virtual ~ExternalOrderJsonParser() = default;
+
+        virtual void feed(const QByteArray &chunk) override;
+        virtual QString finish() override;
+
+        virtual bool isEmpty() const override;
+
+        virtual QByteArray save() const override;
+        virtual bool load(const QByteArray &data) override;
+
+        std::vector<ExternalOrder> takeOrders();
+
+    private:
+        enum class State
+        {
+            BeforeArray,
+            FirstElement,
+            Element,
+            AfterElement,
+            AfterArray,
+            Failed
+        };
+
+        const EveDataProvider &mDataProvider;
+
+        uint mRegionId = 0;
+        QDateTime mUpdateTime;
+
+        std::vector<ExternalOrder> mOrders;
+
+        QByteArray mBuffer;
+        State mState = State::BeforeArray;
+        QString mError;
+
+        // progress of looking for the end of current element, so chunks aren't rescanned
+        int mScanPos = 0;
+        int mScanDepth = 0;
+        bool mScanInString = false;
+
+        void parseBuffer();
+        int findElementEnd(int start);
+        void parseOrder(const char *begin, const char *end);
+
+        void setError(const QString &error);
+    };
+}
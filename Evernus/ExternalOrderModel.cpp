@@ -33,7 +33,7 @@ namespace Evernus
 
         switch (mGrouping) {
         case Grouping::None:
-            return getUngroupedData(column, role, *mOrders[index.row()]);
+            return getUngroupedData(column, role, mOrders[index.row()]);
         case Grouping::Station:
             return getStationGroupedData(column, role, mGroupedData[index.row()]);
         case Grouping::System:
@@ -99,7 +99,7 @@ namespace Evernus
 
     const ExternalOrder &ExternalOrderModel::getOrder(std::size_t row) const noexcept
     {
-        return *mOrders[row];
+        return mOrders[row];
     }
 
     EveType::IdType ExternalOrderModel::getTypeId() const noexcept
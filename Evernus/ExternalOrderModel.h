@@ -20,13 +20,13 @@
 
 #include <QAbstractItemModel>
 
+#include "ExternalOrder.h"
 #include "Character.h"
 #include "EveType.h"
 
 namespace Evernus
 {
     class EveDataProvider;
-    class ExternalOrder;
 
     class ExternalOrderModel
         : public QAbstractItemModel
@@ -128,7 +128,7 @@ namespace Evernus
         double mTotalSize = 0.;
         quint64 mTotalVolume = 0;
 
-        std::vector<std::shared_ptr<ExternalOrder>> mOrders;
+        std::vector<ExternalOrder> mOrders;
         std::vector<GroupedData> mGroupedData;
 
     private:
@@ -0,0 +1,49 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+
+#include "ConcurrentCache.h"
+#include "ExternalOrder.h"
+
+namespace Evernus
+{
+    struct QStringHash
+    {
+        std::size_t operator ()(const QString &value) const noexcept
+        {
+            return qHash(value);
+        }
+    };
+
+    // parsed ESI market order pages, keyed by page url - reused when ESI replies with 304 Not Modified
+    using ExternalOrderPage = std::shared_ptr<const std::vector<ExternalOrder>>;
+    using ExternalOrderPageCache = ConcurrentCache<QString, ExternalOrderPage, QStringHash>;
+
+    // ETags of conditionally fetched pages, shared by all interfaces - without the page count we wouldn't know where a not modified sequence ends
+    struct ExternalOrderPageValidator
+    {
+        QByteArray mETag;
+        uint mPages = 0;
+    };
+
+    using ExternalOrderPageValidatorCache = ConcurrentCache<QString, ExternalOrderPageValidator, QStringHash>;
+}
@@ -18,12 +18,67 @@
 #include <QSqlQuery>
 
 #include "MarketOrder.h"
+#include "ColumnSet.h"
 #include "Citadel.h"
 
 #include "ExternalOrderRepository.h"
 
 namespace Evernus
 {
+    namespace
+    {
+        QDateTime toUTCDateTime(const QVariant &value)
+        {
+            auto dt = value.toDateTime();
+            dt.setTimeSpec(Qt::UTC);
+
+            return dt;
+        }
+
+        const auto columns = makeColumnSet<ExternalOrder>(
+            makeIdColumn<ExternalOrder>("id"),
+            makeColumn("type",
+                       [](const ExternalOrder &order) { return static_cast<int>(order.getType()); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setType(static_cast<ExternalOrder::Type>(value.toInt())); }),
+            makeColumn("type_id",
+                       [](const ExternalOrder &order) { return order.getTypeId(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setTypeId(value.value<ExternalOrder::TypeIdType>()); }),
+            makeColumn("location_id",
+                       [](const ExternalOrder &order) { return order.getStationId(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setStationId(value.toULongLong()); }),
+            makeColumn("solar_system_id",
+                       [](const ExternalOrder &order) { return order.getSolarSystemId(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setSolarSystemId(value.toUInt()); }),
+            makeColumn("region_id",
+                       [](const ExternalOrder &order) { return order.getRegionId(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setRegionId(value.toUInt()); }),
+            makeColumn("range",
+                       [](const ExternalOrder &order) { return order.getRange(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setRange(value.toInt()); }),
+            makeColumn("update_time",
+                       [](const ExternalOrder &order) { return order.getUpdateTime(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setUpdateTime(toUTCDateTime(value)); }),
+            makeColumn("value",
+                       [](const ExternalOrder &order) { return order.getPrice(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setPrice(value.toDouble()); }),
+            makeColumn("volume_entered",
+                       [](const ExternalOrder &order) { return order.getVolumeEntered(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setVolumeEntered(value.toUInt()); }),
+            makeColumn("volume_remaining",
+                       [](const ExternalOrder &order) { return order.getVolumeRemaining(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setVolumeRemaining(value.toUInt()); }),
+            makeColumn("min_volume",
+                       [](const ExternalOrder &order) { return order.getMinVolume(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setMinVolume(value.toUInt()); }),
+            makeColumn("issued",
+                       [](const ExternalOrder &order) { return order.getIssued(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setIssued(toUTCDateTime(value)); }),
+            makeColumn("duration",
+                       [](const ExternalOrder &order) { return order.getDuration(); },
+                       [](ExternalOrder &order, const QVariant &value) { order.setDuration(value.value<short>()); })
+        );
+    }
+
     QString ExternalOrderRepository::getTableName() const
     {
         return QStringLiteral("external_orders");
@@ -36,26 +91,8 @@ namespace Evernus
 
     ExternalOrderRepository::EntityPtr ExternalOrderRepository::populate(const QSqlRecord &record) const
     {
-        auto updateDt = record.value(QStringLiteral("update_time")).toDateTime();
-        updateDt.setTimeSpec(Qt::UTC);
-
-        auto issuedDt = record.value(QStringLiteral("issued")).toDateTime();
-        issuedDt.setTimeSpec(Qt::UTC);
-
-        auto externalOrder = std::make_shared<ExternalOrder>(record.value(QStringLiteral("id")).value<ExternalOrder::IdType>());
-        externalOrder->setType(static_cast<ExternalOrder::Type>(record.value(QStringLiteral("type")).toInt()));
-        externalOrder->setTypeId(record.value(QStringLiteral("type_id")).value<ExternalOrder::TypeIdType>());
-        externalOrder->setStationId(record.value(QStringLiteral("location_id")).toULongLong());
-        externalOrder->setSolarSystemId(record.value(QStringLiteral("solar_system_id")).toUInt());
-        externalOrder->setRegionId(record.value(QStringLiteral("region_id")).toUInt());
-        externalOrder->setRange(record.value(QStringLiteral("range")).toInt());
-        externalOrder->setUpdateTime(updateDt);
-        externalOrder->setPrice(record.value(QStringLiteral("value")).toDouble());
-        externalOrder->setVolumeEntered(record.value(QStringLiteral("volume_entered")).toUInt());
-        externalOrder->setVolumeRemaining(record.value(QStringLiteral("volume_remaining")).toUInt());
-        externalOrder->setMinVolume(record.value(QStringLiteral("min_volume")).toUInt());
-        externalOrder->setIssued(issuedDt);
-        externalOrder->setDuration(record.value(QStringLiteral("duration")).value<short>());
+        auto externalOrder = std::make_shared<ExternalOrder>();
+        columns.decode(record, columns.resolveOrdinals(record), *externalOrder);
         externalOrder->setNew(false);
 
         return externalOrder;
@@ -111,7 +148,10 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return populate(query.record());
+        auto order = populateRow(query, resolveOrdinals(query.record()));
+        query.finish();
+
+        return order;
     }
 
     ExternalOrderRepository::EntityPtr ExternalOrderRepository::findSellByTypeAndRegion(ExternalOrder::TypeIdType typeId,
@@ -134,13 +174,16 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return populate(query.record());
+        auto order = populateRow(query, resolveOrdinals(query.record()));
+        query.finish();
+
+        return order;
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::findBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
-                                                                                        uint regionId,
-                                                                                        const Repository<MarketOrder> &orderRepo,
-                                                                                        const Repository<MarketOrder> &corpOrderRepo) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::findBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
+                                                                                       uint regionId,
+                                                                                       const Repository<MarketOrder> &orderRepo,
+                                                                                       const Repository<MarketOrder> &corpOrderRepo) const
     {
         auto query = prepare(QStringLiteral(
             "SELECT * FROM %1 WHERE type = ? AND type_id = ? AND region_id = ? AND id NOT IN "
@@ -152,62 +195,51 @@ namespace Evernus
         query.addBindValue(static_cast<int>(MarketOrder::State::Active));
         query.addBindValue(static_cast<int>(MarketOrder::State::Active));
 
-        DatabaseUtils::execQuery(query);
-
-        EntityList result;
-
-        const auto size = query.size();
-        if (size > 0)
-            result.reserve(size);
-
-        while (query.next())
-            result.emplace_back(populate(query.record()));
-
-        return result;
+        return fetchValues(query);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchBuyByType(ExternalOrder::TypeIdType typeId) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchBuyByType(ExternalOrder::TypeIdType typeId) const
     {
         return fetchByType(typeId, ExternalOrder::Type::Buy);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchBuyByTypeAndStation(ExternalOrder::TypeIdType typeId,
-                                                                                          quint64 stationId) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchBuyByTypeAndStation(ExternalOrder::TypeIdType typeId,
+                                                                                         quint64 stationId) const
     {
         return fetchByTypeAndStation(typeId, stationId, ExternalOrder::Type::Buy);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchBuyByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
-                                                                                              uint solarSystemId) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchBuyByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
+                                                                                             uint solarSystemId) const
     {
         return fetchByTypeAndSolarSystem(typeId, solarSystemId, ExternalOrder::Type::Buy);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
-                                                                                         uint regionId) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
+                                                                                        uint regionId) const
     {
         return fetchByTypeAndRegion(typeId, regionId, ExternalOrder::Type::Buy);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchSellByType(ExternalOrder::TypeIdType typeId) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchSellByType(ExternalOrder::TypeIdType typeId) const
     {
         return fetchByType(typeId, ExternalOrder::Type::Sell);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchSellByTypeAndStation(ExternalOrder::TypeIdType typeId,
-                                                                                           quint64 stationId) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchSellByTypeAndStation(ExternalOrder::TypeIdType typeId,
+                                                                                          quint64 stationId) const
     {
         return fetchByTypeAndStation(typeId, stationId, ExternalOrder::Type::Sell);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchSellByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
-                                                                                               uint solarSystemId) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchSellByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
+                                                                                              uint solarSystemId) const
     {
         return fetchByTypeAndSolarSystem(typeId, solarSystemId, ExternalOrder::Type::Sell);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchSellByTypeAndRegion(ExternalOrder::TypeIdType typeId,
-                                                                                          uint regionId) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchSellByTypeAndRegion(ExternalOrder::TypeIdType typeId,
+                                                                                         uint regionId) const
     {
         return fetchByTypeAndRegion(typeId, regionId, ExternalOrder::Type::Sell);
     }
@@ -294,29 +326,37 @@ namespace Evernus
 
         auto db = getDatabase();
 
-        db.transaction();
+        DatabaseUtils::beginTransaction(db);
 
         try
         {
-            const auto baseQuery = QStringLiteral("DELETE FROM %1 WHERE %2").arg(getTableName());
-            const auto baseWhere = QStringLiteral("(type_id = ? AND region_id = ?)");
+            // load the keys into a temp table, so the delete is a single lookup on the type_id, region_id index
+            const auto keyTable = QStringLiteral("%1_obsolete_keys").arg(getTableName());
+
+            exec(QStringLiteral(
+                "CREATE TEMP TABLE IF NOT EXISTS %1 (type_id INTEGER NOT NULL, region_id INTEGER NOT NULL, PRIMARY KEY (type_id, region_id)) WITHOUT ROWID"
+            ).arg(keyTable));
+            exec(QStringLiteral("DELETE FROM temp.%1").arg(keyTable));
+
+            const auto baseQuery = QStringLiteral("INSERT OR IGNORE INTO temp.%1 (type_id, region_id) VALUES %2").arg(keyTable);
+            const auto binding = QStringLiteral("(?, ?)");
 
-            const auto batchSize = 300;
+            const auto batchSize = maxSqliteBoundVariables / 2;
             const auto batches = set.size() / batchSize;
 
             auto it = std::begin(set);
 
-            QStringList batchWhere;
-            for (auto i = 0; i < batchSize; ++i)
-                batchWhere << baseWhere;
+            QStringList batchBindings;
+            for (auto i = 0u; i < batchSize; ++i)
+                batchBindings << binding;
 
-            const auto batchQuery = baseQuery.arg(batchWhere.join(QStringLiteral(" OR ")));
+            const auto batchQuery = baseQuery.arg(batchBindings.join(QStringLiteral(", ")));
 
             for (auto i = 0u; i < batches; ++i)
             {
                 auto query = prepare(batchQuery);
 
-                for (auto j = 0; j < batchSize; ++j)
+                for (auto j = 0u; j < batchSize; ++j)
                 {
                     query.addBindValue(it->first);
                     query.addBindValue(it->second);
@@ -328,33 +368,37 @@ namespace Evernus
             }
 
             const auto reminder = set.size() % batchSize;
-            if (reminder == 0)
-                return;
+            if (reminder > 0)
+            {
+                QStringList reminderBindings;
+                for (auto i = 0u; i < reminder; ++i)
+                    reminderBindings << binding;
 
-            QStringList reminderWhere;
-            for (auto i = 0u; i < reminder; ++i)
-                reminderWhere << baseWhere;
+                auto query = prepare(baseQuery.arg(reminderBindings.join(QStringLiteral(", "))));
 
-            const auto reminderQuery = baseQuery.arg(reminderWhere.join(QStringLiteral(" OR ")));
-            auto query = prepare(reminderQuery);
+                for (auto i = 0u; i < reminder; ++i)
+                {
+                    query.addBindValue(it->first);
+                    query.addBindValue(it->second);
 
-            for (auto i = 0u; i < reminder; ++i)
-            {
-                query.addBindValue(it->first);
-                query.addBindValue(it->second);
+                    ++it;
+                }
 
-                ++it;
+                DatabaseUtils::execQuery(query);
             }
 
-            DatabaseUtils::execQuery(query);
+            exec(QStringLiteral("DELETE FROM %1 WHERE (type_id, region_id) IN (SELECT type_id, region_id FROM temp.%2)")
+                .arg(getTableName())
+                .arg(keyTable));
+            exec(QStringLiteral("DELETE FROM temp.%1").arg(keyTable));
+
+            DatabaseUtils::commitTransaction(db);
         }
         catch (...)
         {
             db.rollback();
             throw;
         }
-
-        db.commit();
     }
 
     void ExternalOrderRepository::removeForType(ExternalOrder::TypeIdType typeId) const
@@ -381,154 +425,84 @@ namespace Evernus
         )").arg(getTableName()).arg(citadelRepo.getTableName()).arg(citadelRepo.getIdColumn()));
     }
 
+    ExternalOrderRepository::ColumnOrdinals ExternalOrderRepository::resolveOrdinals(const QSqlRecord &record) const
+    {
+        return columns.resolveOrdinals(record);
+    }
+
+    ExternalOrderRepository::EntityPtr ExternalOrderRepository::populateRow(const QSqlQuery &query, const ColumnOrdinals &ordinals) const
+    {
+        auto externalOrder = std::make_shared<ExternalOrder>();
+        decodeRow(query, ordinals, *externalOrder);
+
+        return externalOrder;
+    }
+
+    void ExternalOrderRepository::decodeRow(const QSqlQuery &query, const ColumnOrdinals &ordinals, ExternalOrder &entity) const
+    {
+        columns.decode(query, ordinals, entity);
+        entity.setNew(false);
+    }
+
     QStringList ExternalOrderRepository::getColumns() const
     {
-        return {
-            QStringLiteral("id"),
-            QStringLiteral("type"),
-            QStringLiteral("type_id"),
-            QStringLiteral("location_id"),
-            QStringLiteral("solar_system_id"),
-            QStringLiteral("region_id"),
-            QStringLiteral("range"),
-            QStringLiteral("update_time"),
-            QStringLiteral("value"),
-            QStringLiteral("volume_entered"),
-            QStringLiteral("volume_remaining"),
-            QStringLiteral("min_volume"),
-            QStringLiteral("issued"),
-            QStringLiteral("duration")
-        };
+        return columns.getNames();
     }
 
     void ExternalOrderRepository::bindValues(const ExternalOrder &entity, QSqlQuery &query) const
     {
-        if (entity.getId() != ExternalOrder::invalidId)
-            query.bindValue(QStringLiteral(":id"), entity.getId());
-
-        query.bindValue(QStringLiteral(":type"), static_cast<int>(entity.getType()));
-        query.bindValue(QStringLiteral(":type_id"), entity.getTypeId());
-        query.bindValue(QStringLiteral(":location_id"), entity.getStationId());
-        query.bindValue(QStringLiteral(":solar_system_id"), entity.getSolarSystemId());
-        query.bindValue(QStringLiteral(":region_id"), entity.getRegionId());
-        query.bindValue(QStringLiteral(":range"), entity.getRange());
-        query.bindValue(QStringLiteral(":update_time"), entity.getUpdateTime());
-        query.bindValue(QStringLiteral(":value"), entity.getPrice());
-        query.bindValue(QStringLiteral(":volume_entered"), entity.getVolumeEntered());
-        query.bindValue(QStringLiteral(":volume_remaining"), entity.getVolumeRemaining());
-        query.bindValue(QStringLiteral(":min_volume"), entity.getMinVolume());
-        query.bindValue(QStringLiteral(":issued"), entity.getIssued());
-        query.bindValue(QStringLiteral(":duration"), entity.getDuration());
+        columns.bindValues(entity, query);
     }
 
     void ExternalOrderRepository::bindPositionalValues(const ExternalOrder &entity, QSqlQuery &query) const
     {
-        if (entity.getId() != ExternalOrder::invalidId)
-            query.addBindValue(entity.getId());
-
-        query.addBindValue(static_cast<int>(entity.getType()));
-        query.addBindValue(entity.getTypeId());
-        query.addBindValue(entity.getStationId());
-        query.addBindValue(entity.getSolarSystemId());
-        query.addBindValue(entity.getRegionId());
-        query.addBindValue(entity.getRange());
-        query.addBindValue(entity.getUpdateTime());
-        query.addBindValue(entity.getPrice());
-        query.addBindValue(entity.getVolumeEntered());
-        query.addBindValue(entity.getVolumeRemaining());
-        query.addBindValue(entity.getMinVolume());
-        query.addBindValue(entity.getIssued());
-        query.addBindValue(entity.getDuration());
+        columns.bindPositionalValues(entity, query);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchByType(ExternalOrder::TypeIdType typeId,
-                                                                             ExternalOrder::Type type) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchByType(ExternalOrder::TypeIdType typeId,
+                                                                            ExternalOrder::Type type) const
     {
         auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ?").arg(getTableName()));
         query.addBindValue(static_cast<int>(type));
         query.addBindValue(typeId);
 
-        DatabaseUtils::execQuery(query);
-
-        EntityList result;
-
-        const auto size = query.size();
-        if (size > 0)
-            result.reserve(size);
-
-        while (query.next())
-            result.emplace_back(populate(query.record()));
-
-        return result;
+        return fetchValues(query);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchByTypeAndStation(ExternalOrder::TypeIdType typeId,
-                                                                                       quint64 stationId,
-                                                                                       ExternalOrder::Type type) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchByTypeAndStation(ExternalOrder::TypeIdType typeId,
+                                                                                      quint64 stationId,
+                                                                                      ExternalOrder::Type type) const
     {
         auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND location_id = ?").arg(getTableName()));
         query.addBindValue(static_cast<int>(type));
         query.addBindValue(typeId);
         query.addBindValue(stationId);
 
-        DatabaseUtils::execQuery(query);
-
-        EntityList result;
-
-        const auto size = query.size();
-        if (size > 0)
-            result.reserve(size);
-
-        while (query.next())
-            result.emplace_back(populate(query.record()));
-
-        return result;
+        return fetchValues(query);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
-                                                                                           uint solarSystemId,
-                                                                                           ExternalOrder::Type type) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
+                                                                                          uint solarSystemId,
+                                                                                          ExternalOrder::Type type) const
     {
         auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND solar_system_id = ?").arg(getTableName()));
         query.addBindValue(static_cast<int>(type));
         query.addBindValue(typeId);
         query.addBindValue(solarSystemId);
 
-        DatabaseUtils::execQuery(query);
-
-        EntityList result;
-
-        const auto size = query.size();
-        if (size > 0)
-            result.reserve(size);
-
-        while (query.next())
-            result.emplace_back(populate(query.record()));
-
-        return result;
+        return fetchValues(query);
     }
 
-    ExternalOrderRepository::EntityList ExternalOrderRepository::fetchByTypeAndRegion(ExternalOrder::TypeIdType typeId,
-                                                                                      uint regionId,
-                                                                                      ExternalOrder::Type type) const
+    ExternalOrderRepository::ValueList ExternalOrderRepository::fetchByTypeAndRegion(ExternalOrder::TypeIdType typeId,
+                                                                                     uint regionId,
+                                                                                     ExternalOrder::Type type) const
     {
         auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND region_id = ?").arg(getTableName()));
         query.addBindValue(static_cast<int>(type));
         query.addBindValue(typeId);
         query.addBindValue(regionId);
 
-        DatabaseUtils::execQuery(query);
-
-        EntityList result;
-
-        const auto size = query.size();
-        if (size > 0)
-            result.reserve(size);
-
-        while (query.next())
-            result.emplace_back(populate(query.record()));
-
-        return result;
+        return fetchValues(query);
     }
 
     template<class T>
@@ -45,27 +45,27 @@ namespace Evernus
                                           uint regionId,
                                           const Repository<MarketOrder> &orderRepo,
                                           const Repository<MarketOrder> &corpOrderRepo) const;
-        EntityList findBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
-                                          uint regionId,
-                                          const Repository<MarketOrder> &orderRepo,
-                                          const Repository<MarketOrder> &corpOrderRepo) const;
+        ValueList findBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
+                                         uint regionId,
+                                         const Repository<MarketOrder> &orderRepo,
+                                         const Repository<MarketOrder> &corpOrderRepo) const;
 
-        EntityList fetchBuyByType(ExternalOrder::TypeIdType typeId) const;
-        EntityList fetchBuyByTypeAndStation(ExternalOrder::TypeIdType typeId,
+        ValueList fetchBuyByType(ExternalOrder::TypeIdType typeId) const;
+        ValueList fetchBuyByTypeAndStation(ExternalOrder::TypeIdType typeId,
+                                           quint64 stationId) const;
+        ValueList fetchBuyByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
+                                               uint solarSystemId) const;
+        ValueList fetchBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
+                                          uint regionId) const;
+
+        ValueList fetchSellByType(ExternalOrder::TypeIdType typeId) const;
+        ValueList fetchSellByTypeAndStation(ExternalOrder::TypeIdType typeId,
                                             quint64 stationId) const;
-        EntityList fetchBuyByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
+        ValueList fetchSellByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
                                                 uint solarSystemId) const;
-        EntityList fetchBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
+        ValueList fetchSellByTypeAndRegion(ExternalOrder::TypeIdType typeId,
                                            uint regionId) const;
 
-        EntityList fetchSellByType(ExternalOrder::TypeIdType typeId) const;
-        EntityList fetchSellByTypeAndStation(ExternalOrder::TypeIdType typeId,
-                                             quint64 stationId) const;
-        EntityList fetchSellByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
-                                                 uint solarSystemId) const;
-        EntityList fetchSellByTypeAndRegion(ExternalOrder::TypeIdType typeId,
-                                            uint regionId) const;
-
         std::vector<EveType::IdType> fetchUniqueTypes() const;
         std::vector<uint> fetchUniqueRegions() const;
         std::vector<uint> fetchUniqueSolarSystems(uint regionId = 0) const;
@@ -79,21 +79,26 @@ namespace Evernus
 
         void fixMissingData(const Repository<Citadel> &citadelRepo) const;
 
+    protected:
+        virtual ColumnOrdinals resolveOrdinals(const QSqlRecord &record) const override;
+        virtual EntityPtr populateRow(const QSqlQuery &query, const ColumnOrdinals &ordinals) const override;
+        virtual void decodeRow(const QSqlQuery &query, const ColumnOrdinals &ordinals, ExternalOrder &entity) const override;
+
     private:
         virtual QStringList getColumns() const override;
         virtual void bindValues(const ExternalOrder &entity, QSqlQuery &query) const override;
         virtual void bindPositionalValues(const ExternalOrder &entity, QSqlQuery &query) const override;
 
-        EntityList fetchByType(ExternalOrder::TypeIdType typeId, ExternalOrder::Type type) const;
-        EntityList fetchByTypeAndStation(ExternalOrder::TypeIdType typeId,
-                                         quint64 stationId,
-                                         ExternalOrder::Type type) const;
-        EntityList fetchByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
-                                             uint solarSystemId,
-                                             ExternalOrder::Type type) const;
-        EntityList fetchByTypeAndRegion(ExternalOrder::TypeIdType typeId,
-                                        uint regionId,
+        ValueList fetchByType(ExternalOrder::TypeIdType typeId, ExternalOrder::Type type) const;
+        ValueList fetchByTypeAndStation(ExternalOrder::TypeIdType typeId,
+                                        quint64 stationId,
                                         ExternalOrder::Type type) const;
+        ValueList fetchByTypeAndSolarSystem(ExternalOrder::TypeIdType typeId,
+                                            uint solarSystemId,
+                                            ExternalOrder::Type type) const;
+        ValueList fetchByTypeAndRegion(ExternalOrder::TypeIdType typeId,
+                                       uint regionId,
+                                       ExternalOrder::Type type) const;
 
         template<class T>
         std::vector<T> fetchUniqueColumn(const QString &column) const;
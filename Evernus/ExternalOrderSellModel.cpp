@@ -15,6 +15,8 @@
 #include <unordered_map>
 #include <algorithm>
 
+#include <boost/range/adaptor/transformed.hpp>
+
 #include <QLocale>
 #include <QColor>
 
@@ -169,7 +171,9 @@ namespace Evernus
         else
             mOrders = mOrderRepo.fetchSellByType(mTypeId);
 
-        const auto aggrData = MathUtils::calcAggregates(mOrders, mDataProvider);
+        const auto aggrData = MathUtils::calcAggregates(mOrders | boost::adaptors::transformed([](const auto &order) {
+            return &order;
+        }), mDataProvider);
 
         mTotalPrice = aggrData.mTotalPrice;
         mMinPrice = aggrData.mMinPrice;
@@ -191,7 +195,7 @@ namespace Evernus
 
         switch (mGrouping) {
         case Grouping::None:
-            return mOrders[index.row()]->getPrice();
+            return mOrders[index.row()].getPrice();
         case Grouping::Station:
         case Grouping::System:
         case Grouping::Region:
@@ -403,11 +407,11 @@ namespace Evernus
 
         for (const auto &order : mOrders)
         {
-            const auto id = (order.get()->*Func)();
+            const auto id = (order.*Func)();
             auto &curData = data[id];
             curData.mId = id;
 
-            const auto price = order->getPrice();
+            const auto price = order.getPrice();
             if (curData.mLowestPrice > price)
                 curData.mLowestPrice = price;
             if (curData.mHighestPrice < price)
@@ -415,13 +419,13 @@ namespace Evernus
 
             prices[id].emplace_back(price);
 
-            curData.mVolumeEntered += order->getVolumeEntered();
-            curData.mVolumeRemaining += order->getVolumeRemaining();
-            curData.mTotalProfit += order->getVolumeRemaining() * price;
+            curData.mVolumeEntered += order.getVolumeEntered();
+            curData.mVolumeRemaining += order.getVolumeRemaining();
+            curData.mTotalProfit += order.getVolumeRemaining() * price;
 
             ++curData.mCount;
 
-            curData.mTotalSize += order->getVolumeRemaining() * mDataProvider.getTypeVolume(order->getTypeId());
+            curData.mTotalSize += order.getVolumeRemaining() * mDataProvider.getTypeVolume(order.getTypeId());
         }
 
         mGroupedData.reserve(data.size());
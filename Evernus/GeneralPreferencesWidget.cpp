@@ -20,10 +20,12 @@
 #include <QComboBox>
 #include <QSettings>
 #include <QSqlQuery>
+#include <QSpinBox>
 #include <QLabel>
 
 #include "LanguageComboBox.h"
 #include "UpdaterSettings.h"
+#include "CacheSettings.h"
 #include "UISettings.h"
 #include "DbSettings.h"
 
@@ -124,6 +126,39 @@ namespace Evernus
         mDbSynchronousEdit->setCurrentIndex(mDbSynchronousEdit->findData(
             settings.value(DbSettings::synchronousKey, DbSettings::synchronousDefault).toInt()));
 
+        mDbWalModeBtn = new QCheckBox{tr("Use write-ahead log for database (requires restart)"), this};
+        generalFormLayout->addRow(mDbWalModeBtn);
+        mDbWalModeBtn->setToolTip(tr("Allows reading data while large imports are being saved."));
+        mDbWalModeBtn->setChecked(settings.value(DbSettings::walModeKey, DbSettings::walModeDefault).toBool());
+
+        mDbProfileQueriesBtn = new QCheckBox{tr("Collect database query statistics"), this};
+        generalFormLayout->addRow(mDbProfileQueriesBtn);
+        mDbProfileQueriesBtn->setToolTip(tr("Statistics can be viewed in Tools -> Database statistics."));
+        mDbProfileQueriesBtn->setChecked(settings.value(DbSettings::profileQueriesKey, DbSettings::profileQueriesDefault).toBool());
+
+        mDbSlowQueryThresholdEdit = new QSpinBox{this};
+        generalFormLayout->addRow(tr("Slow query threshold:"), mDbSlowQueryThresholdEdit);
+        mDbSlowQueryThresholdEdit->setRange(1, 60000);
+        mDbSlowQueryThresholdEdit->setSuffix(QStringLiteral("ms"));
+        mDbSlowQueryThresholdEdit->setToolTip(tr("Queries taking longer are written to the slow query log along with their query plan."));
+        mDbSlowQueryThresholdEdit->setValue(settings.value(DbSettings::slowQueryThresholdKey, DbSettings::slowQueryThresholdDefault).toInt());
+
+        mCacheMemoryBudgetEdit = new QSpinBox{this};
+        generalFormLayout->addRow(tr("Data cache memory limit:"), mCacheMemoryBudgetEdit);
+        mCacheMemoryBudgetEdit->setRange(0, 65536);
+        mCacheMemoryBudgetEdit->setSuffix(QStringLiteral("MiB"));
+        mCacheMemoryBudgetEdit->setSpecialValueText(tr("unlimited"));
+        mCacheMemoryBudgetEdit->setToolTip(tr("Least recently used data is dropped from memory caches above this limit. Usage can be viewed in Tools -> Cache statistics."));
+        mCacheMemoryBudgetEdit->setValue(settings.value(CacheSettings::memoryBudgetKey, CacheSettings::memoryBudgetDefault).toInt());
+
+        mESIResponseCacheSizeEdit = new QSpinBox{this};
+        generalFormLayout->addRow(tr("ESI response disk cache size:"), mESIResponseCacheSizeEdit);
+        mESIResponseCacheSizeEdit->setRange(0, 65536);
+        mESIResponseCacheSizeEdit->setSuffix(QStringLiteral("MiB"));
+        mESIResponseCacheSizeEdit->setSpecialValueText(tr("disabled"));
+        mESIResponseCacheSizeEdit->setToolTip(tr("Public ESI replies are kept on disk and reused until they expire, even after restarting."));
+        mESIResponseCacheSizeEdit->setValue(settings.value(CacheSettings::esiResponseCacheSizeKey, CacheSettings::esiResponseCacheSizeDefault).toInt());
+
         mainLayout->addStretch();
     }
 
@@ -146,5 +181,10 @@ namespace Evernus
         settings.setValue(UISettings::applyDateFormatToGraphsKey, mApplyDateFormatToGraphsBtn->isChecked());
         settings.setValue(UISettings::columnDelimiterKey, mColumnDelimiterEdit->currentData().value<char>());
         settings.setValue(DbSettings::synchronousKey, synchronousFlag);
+        settings.setValue(DbSettings::walModeKey, mDbWalModeBtn->isChecked());
+        settings.setValue(DbSettings::profileQueriesKey, mDbProfileQueriesBtn->isChecked());
+        settings.setValue(DbSettings::slowQueryThresholdKey, mDbSlowQueryThresholdEdit->value());
+        settings.setValue(CacheSettings::memoryBudgetKey, mCacheMemoryBudgetEdit->value());
+        settings.setValue(CacheSettings::esiResponseCacheSizeKey, mESIResponseCacheSizeEdit->value());
     }
 }
@@ -20,6 +20,7 @@
 class QCheckBox;
 class QLineEdit;
 class QComboBox;
+class QSpinBox;
 
 namespace Evernus
 {
@@ -52,5 +53,10 @@ namespace Evernus
         QCheckBox *mApplyDateFormatToGraphsBtn = nullptr;
         QComboBox *mColumnDelimiterEdit = nullptr;
         QComboBox *mDbSynchronousEdit = nullptr;
+        QCheckBox *mDbWalModeBtn = nullptr;
+        QCheckBox *mDbProfileQueriesBtn = nullptr;
+        QSpinBox *mDbSlowQueryThresholdEdit = nullptr;
+        QSpinBox *mCacheMemoryBudgetEdit = nullptr;
+        QSpinBox *mESIResponseCacheSizeEdit = nullptr;
     };
 }
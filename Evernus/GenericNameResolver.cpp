@@ -0,0 +1,172 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+
+#include <QDataStream>
+#include <QFile>
+
+#include <QtDebug>
+
+#include "EveDataManagerProvider.h"
+#include "ESIManager.h"
+
+#include "GenericNameResolver.h"
+
+namespace Evernus
+{
+    const std::size_t GenericNameResolver::maxBatchSize;
+    const int GenericNameResolver::batchDelay;
+    const uint GenericNameResolver::maxBatchFailures;
+
+    GenericNameResolver::GenericNameResolver(const EveDataManagerProvider &dataManagerProvider, QString cacheFilePath, QObject *parent)
+        : QObject{parent}
+        , mDataManagerProvider{dataManagerProvider}
+        , mCacheFilePath{std::move(cacheFilePath)}
+    {
+        mBatchTimer.setSingleShot(true);
+        mBatchTimer.setInterval(batchDelay);
+
+        connect(&mBatchTimer, &QTimer::timeout, this, &GenericNameResolver::sendBatches);
+    }
+
+    GenericNameResolver::NameMap GenericNameResolver::readCache() const
+    {
+        NameMap result;
+
+        QFile cacheFile{mCacheFilePath};
+        if (cacheFile.open(QIODevice::ReadOnly))
+        {
+            QDataStream cacheStream{&cacheFile};
+            while (!cacheStream.atEnd())
+            {
+                quint64 id = 0;
+                QString name;
+
+                cacheStream >> id >> name;
+
+                // a truncated last record means we got killed while writing
+                if (cacheStream.status() != QDataStream::Ok)
+                    break;
+
+                result[id] = name;
+            }
+        }
+
+        return result;
+    }
+
+    void GenericNameResolver::writeCache(const NameMap &names) const
+    {
+        QFile cacheFile{mCacheFilePath};
+        if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Append))
+        {
+            qWarning() << "Cannot write name cache:" << mCacheFilePath;
+            return;
+        }
+
+        QDataStream cacheStream{&cacheFile};
+        for (auto name = std::begin(names); name != std::end(names); ++name)
+            cacheStream << name.key() << name.value();
+    }
+
+    void GenericNameResolver::resolve(quint64 id)
+    {
+        if (!mRequested.emplace(id).second)
+            return;
+
+        mQueue.emplace_back(id);
+
+        if (mQueue.size() >= maxBatchSize)
+            sendBatches();
+        else if (!mBatchTimer.isActive())
+            mBatchTimer.start();
+    }
+
+    void GenericNameResolver::sendBatches()
+    {
+        mBatchTimer.stop();
+
+        qDebug() << "Resolving" << mQueue.size() << "generic names.";
+
+        for (auto begin = std::begin(mQueue); begin != std::end(mQueue);)
+        {
+            const auto end = begin + std::min<std::ptrdiff_t>(maxBatchSize, std::distance(begin, std::end(mQueue)));
+
+            fetch(std::vector<quint64>(begin, end), std::make_shared<Batch>());
+            begin = end;
+        }
+
+        mQueue.clear();
+    }
+
+    void GenericNameResolver::fetch(std::vector<quint64> ids, const std::shared_ptr<Batch> &batch)
+    {
+        mDataManagerProvider.getESIManager().fetchGenericNames(ids, [=](auto &&data, const auto &error) {
+            if (Q_UNLIKELY(!error.isEmpty()))
+            {
+                qWarning() << "Error resolving" << ids.size() << "generic names:" << error;
+
+                // a single unknown id fails the whole request, so narrow it down
+                ++batch->mFailures;
+                split(ids, batch);
+
+                return;
+            }
+
+            NameMap names;
+            names.reserve(static_cast<int>(data.size()));
+
+            for (auto &name : data)
+                names.insert(name.first, std::move(name.second));
+
+            std::vector<quint64> missing;
+            for (const auto id : ids)
+            {
+                mRequested.erase(id);
+
+                if (!names.contains(id))
+                    missing.emplace_back(id);
+            }
+
+            writeCache(names);
+            emit namesResolved(names);
+
+            if (!missing.empty())
+                emit namesFailed(missing);
+        });
+    }
+
+    void GenericNameResolver::split(const std::vector<quint64> &ids, const std::shared_ptr<Batch> &batch)
+    {
+        if (ids.size() < 2 || batch->mFailures >= maxBatchFailures)
+        {
+            fail(ids);
+            return;
+        }
+
+        const auto middle = std::begin(ids) + ids.size() / 2;
+
+        fetch(std::vector<quint64>(std::begin(ids), middle), batch);
+        fetch(std::vector<quint64>(middle, std::end(ids)), batch);
+    }
+
+    void GenericNameResolver::fail(const std::vector<quint64> &ids)
+    {
+        for (const auto id : ids)
+            mRequested.erase(id);
+
+        emit namesFailed(ids);
+    }
+}
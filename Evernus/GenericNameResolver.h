@@ -0,0 +1,79 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_set>
+#include <memory>
+#include <vector>
+
+#include <QString>
+#include <QTimer>
+#include <QHash>
+
+namespace Evernus
+{
+    class EveDataManagerProvider;
+
+    // collects name lookups over a short window and resolves them in batches, persisting the results
+    class GenericNameResolver
+        : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        using NameMap = QHash<quint64, QString>;
+
+        GenericNameResolver(const EveDataManagerProvider &dataManagerProvider, QString cacheFilePath, QObject *parent = nullptr);
+        virtual ~GenericNameResolver() = default;
+
+        // names resolved in previous sessions
+        NameMap readCache() const;
+        // appends to the on-disk cache
+        void writeCache(const NameMap &names) const;
+
+        // ids already queued or in flight are ignored
+        void resolve(quint64 id);
+
+    signals:
+        void namesResolved(const GenericNameResolver::NameMap &names);
+        void namesFailed(const std::vector<quint64> &ids);
+
+    private slots:
+        void sendBatches();
+
+    private:
+        struct Batch
+        {
+            uint mFailures = 0;
+        };
+
+        static const std::size_t maxBatchSize = 1000;
+        static const int batchDelay = 100;
+        // failed requests after which a batch is given up instead of split further
+        static const uint maxBatchFailures = 64;
+
+        const EveDataManagerProvider &mDataManagerProvider;
+        QString mCacheFilePath;
+
+        QTimer mBatchTimer;
+
+        std::vector<quint64> mQueue;
+        std::unordered_set<quint64> mRequested;
+
+        void fetch(std::vector<quint64> ids, const std::shared_ptr<Batch> &batch);
+        void split(const std::vector<quint64> &ids, const std::shared_ptr<Batch> &batch);
+        void fail(const std::vector<quint64> &ids);
+    };
+}
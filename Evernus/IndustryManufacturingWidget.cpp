@@ -81,7 +81,7 @@ namespace Evernus
         , mSetupRepo{setupRepo}
         , mSetupModel{mSetup, mDataProvider, assetProvider, costProvider, mCharacterRepo}
         , mDataFetcher{mDataProvider, interfaceManager}
-        , mESIManager{mDataProvider, interfaceManager}
+        , mESIManager{mDataProvider, interfaceManager, ESIRequestPriority::ForegroundImport}
     {
         const auto mainLayout = new QVBoxLayout{this};
 
@@ -12,6 +12,8 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <limits>
 #include <set>
 
 #include <QEventLoop>
@@ -91,6 +93,10 @@ namespace Evernus
                     return locale.toString(data.mVolume);
                 case marginColumn:
                     return QStringLiteral("%1%2").arg(locale.toString(data.mMargin, 'f', 2)).arg(locale.percent());
+                case jumpsColumn:
+                    return (data.mJumps == 0) ? (QVariant{}) : (locale.toString(data.mJumps));
+                case scorePerJumpColumn:
+                    return (data.mJumps == 0) ? (QVariant{}) : (locale.toString(getScorePerJump(data), 'f', 0));
                 }
             }
             break;
@@ -122,6 +128,10 @@ namespace Evernus
                 return data.mVolume;
             case marginColumn:
                 return data.mMargin;
+            case jumpsColumn:
+                return data.mJumps;
+            case scorePerJumpColumn:
+                return getScorePerJump(data);
             }
             break;
         case Qt::UserRole + 1:
@@ -179,6 +189,10 @@ namespace Evernus
                 return tr("30-day avg. min. volume");
             case marginColumn:
                 return tr("Margin");
+            case jumpsColumn:
+                return tr("Jumps");
+            case scorePerJumpColumn:
+                return tr("Score per jump");
             }
         }
 
@@ -214,6 +228,16 @@ namespace Evernus
         const auto srcRegionId = (srcStation == 0) ? (0u) : (mDataProvider.getStationRegionId(srcStation));
         const auto dstRegionId = (dstStation == 0) ? (0u) : (mDataProvider.getStationRegionId(dstStation));
 
+        // haul length is only known when both ends are stations
+        auto jumps = 0u;
+        if (srcStation != 0 && dstStation != 0)
+        {
+            jumps = mDataProvider.getRouteLength(mDataProvider.getStationSolarSystemId(srcStation),
+                                                 mDataProvider.getStationSolarSystemId(dstStation));
+            if (jumps == std::numeric_limits<uint>::max())
+                jumps = 0;
+        }
+
         for (const auto &order : orders)
         {
             const auto typeId = order.getTypeId();
@@ -337,6 +361,7 @@ namespace Evernus
                     data.mVolume = std::min(type.second.mVolume, dstData->second.mVolume);
                     data.mSrcRegion = srcRegion.first;
                     data.mDstRegion = dstRegion.first;
+                    data.mJumps = jumps;
 
                     auto realSellPrice = getDstPrice(data);
                     auto realBuyPrice = getSrcPrice(data);
@@ -443,4 +468,9 @@ namespace Evernus
     {
         return (mDstPriceType == PriceType::Buy) ? (data.mDstBuyPrice) : (data.mDstSellPrice);
     }
+
+    double InterRegionMarketDataModel::getScorePerJump(const TypeData &data) noexcept
+    {
+        return data.mDifference * data.mVolume / std::max(data.mJumps, 1u);
+    }
 }
@@ -95,6 +95,8 @@ namespace Evernus
             differenceColumn,
             volumeColumn,
             marginColumn,
+            jumpsColumn,
+            scorePerJumpColumn,
 
             numColumns
         };
@@ -115,6 +117,7 @@ namespace Evernus
             quint64 mSrcSellOrderCount = 0;
             quint64 mDstBuyOrderCount = 0;
             quint64 mDstSellOrderCount = 0;
+            uint mJumps = 0;
         };
 
         const EveDataProvider &mDataProvider;
@@ -130,6 +133,7 @@ namespace Evernus
         PriceType mDstPriceType = PriceType::Sell;
 
         double getSrcPrice(const TypeData &data) const noexcept;
+        static double getScorePerJump(const TypeData &data) noexcept;
         double getDstPrice(const TypeData &data) const noexcept;
     };
 }
@@ -86,7 +86,10 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return populate(query.record());
+        auto cost = populate(query.record());
+        query.finish();
+
+        return cost;
     }
 
     ItemCostRepository::EntityPtr ItemCostRepository::fetchLatestForType(EveType::IdType typeId) const
@@ -99,7 +102,10 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return populate(query.record());
+        auto cost = populate(query.record());
+        query.finish();
+
+        return cost;
     }
 
     void ItemCostRepository::removeForCharacter(Character::IdType characterId) const
@@ -0,0 +1,338 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include <QtConcurrent>
+#include <QtDebug>
+
+#include "JumpDistanceMatrix.h"
+
+namespace Evernus
+{
+    const uint JumpDistanceMatrix::unreachable;
+
+    namespace
+    {
+        const char magic[4] = { 'E', 'J', 'D', 'M' };
+        const quint32 version = 2;
+
+        const auto unreachableJumps = std::numeric_limits<uchar>::max();
+
+        struct RegionMatrix
+        {
+            uint mRegionId = 0;
+            std::vector<uint> mSystems;
+            std::vector<uchar> mDistances;
+        };
+
+        void computeDistances(RegionMatrix &region, const std::unordered_multimap<uint, uint> &jumps)
+        {
+            const auto count = region.mSystems.size();
+            const auto getIndex = [&](uint systemId) {
+                return static_cast<std::size_t>(std::distance(
+                    std::begin(region.mSystems),
+                    std::lower_bound(std::begin(region.mSystems), std::end(region.mSystems), systemId)
+                ));
+            };
+
+            std::vector<std::vector<std::size_t>> neighbours(count);
+            for (const auto &jump : jumps)
+                neighbours[getIndex(jump.first)].emplace_back(getIndex(jump.second));
+
+            region.mDistances.assign(count * count, unreachableJumps);
+
+            // BFS from every system - regions are small enough for this to be cheap
+            std::vector<std::size_t> queue;
+            queue.reserve(count);
+
+            for (auto start = 0u; start < count; ++start)
+            {
+                const auto row = &region.mDistances[start * count];
+                row[start] = 0;
+
+                queue.clear();
+                queue.emplace_back(start);
+
+                for (auto i = 0u; i < queue.size(); ++i)
+                {
+                    const auto current = queue[i];
+                    const auto next = static_cast<uchar>(std::min(row[current] + 1, unreachableJumps - 1));
+
+                    for (const auto neighbour : neighbours[current])
+                    {
+                        if (row[neighbour] == unreachableJumps)
+                        {
+                            row[neighbour] = next;
+                            queue.emplace_back(neighbour);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void JumpDistanceMatrix::load(const QString &filePath, const JumpMap &jumps)
+    {
+        const auto fingerprint = getFingerprint(jumps);
+
+        mFile.setFileName(filePath);
+        if (map(fingerprint))
+            return;
+
+        qDebug() << "Computing jump distances for" << jumps.size() << "regions.";
+
+        const auto data = build(jumps, fingerprint);
+
+        QFile file{filePath};
+        if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size())
+        {
+            file.close();
+
+            if (map(fingerprint))
+                return;
+        }
+        else
+        {
+            qWarning() << "Cannot write jump distance cache:" << filePath;
+        }
+
+        mBuffer = data;
+        setData(reinterpret_cast<const uchar *>(mBuffer.constData()), mBuffer.size(), fingerprint);
+    }
+
+    uint JumpDistanceMatrix::getDistance(uint startSystem, uint endSystem) const noexcept
+    {
+        if (startSystem == endSystem)
+            return 0;
+
+        const auto start = findSystem(startSystem);
+        if (start == nullptr)
+            return unreachable;
+
+        const auto end = findSystem(endSystem);
+        if (end == nullptr || end->mRegionIndex != start->mRegionIndex)
+            return unreachable;
+
+        const auto &region = mRegions[start->mRegionIndex];
+        const auto jumps = mData[region.mMatrixOffset + static_cast<quint64>(start->mLocalIndex) * region.mSystemCount + end->mLocalIndex];
+
+        return (jumps == unreachableJumps) ? (unreachable) : (jumps);
+    }
+
+    std::vector<uint> JumpDistanceMatrix::getSystemsInRange(uint startSystem, uint maxJumps) const
+    {
+        const auto start = findSystem(startSystem);
+        if (start == nullptr)
+            return { startSystem };
+
+        std::vector<uint> result;
+
+        const auto &region = mRegions[start->mRegionIndex];
+        const auto row = mData + region.mMatrixOffset + static_cast<quint64>(start->mLocalIndex) * region.mSystemCount;
+
+        for (auto i = 0u; i < region.mSystemCount; ++i)
+        {
+            if (row[i] != unreachableJumps && row[i] <= maxJumps)
+                result.emplace_back(mRegionSystemIds[region.mFirstSystem + i]);
+        }
+
+        return result;
+    }
+
+    const JumpDistanceMatrix::SystemEntry *JumpDistanceMatrix::findSystem(uint systemId) const noexcept
+    {
+        const auto systemsEnd = mSystems + mSystemCount;
+        const auto it = std::lower_bound(mSystems, systemsEnd, systemId, [](const auto &entry, auto id) {
+            return entry.mSystemId < id;
+        });
+
+        return (it != systemsEnd && it->mSystemId == systemId) ? (it) : (nullptr);
+    }
+
+    bool JumpDistanceMatrix::map(quint64 fingerprint)
+    {
+        if (!mFile.open(QIODevice::ReadOnly))
+            return false;
+
+        const auto size = mFile.size();
+        const auto data = mFile.map(0, size);
+
+        if (data != nullptr && setData(data, size, fingerprint))
+            return true;
+
+        mFile.close();
+        return false;
+    }
+
+    bool JumpDistanceMatrix::setData(const uchar *data, qint64 size, quint64 fingerprint)
+    {
+        mData = nullptr;
+        mRegions = nullptr;
+        mSystems = nullptr;
+        mRegionSystemIds = nullptr;
+        mSystemCount = 0;
+
+        if (size < static_cast<qint64>(sizeof(Header)))
+            return false;
+
+        Header header;
+        std::memcpy(&header, data, sizeof(header));
+
+        if (std::memcmp(header.mMagic, magic, sizeof(magic)) != 0 || header.mVersion != version || header.mFingerprint != fingerprint)
+            return false;
+
+        const auto regionsOffset = sizeof(Header);
+        const auto systemsOffset = regionsOffset + header.mRegionCount * sizeof(RegionEntry);
+        const auto regionSystemIdsOffset = systemsOffset + header.mSystemCount * sizeof(SystemEntry);
+        const auto regionSystemIdsEnd = regionSystemIdsOffset + header.mSystemCount * sizeof(quint32);
+
+        if (static_cast<quint64>(size) < regionSystemIdsEnd)
+            return false;
+
+        const auto regions = reinterpret_cast<const RegionEntry *>(data + regionsOffset);
+        for (auto i = 0u; i < header.mRegionCount; ++i)
+        {
+            const auto &region = regions[i];
+            if (region.mMatrixOffset + static_cast<quint64>(region.mSystemCount) * region.mSystemCount > static_cast<quint64>(size) ||
+                static_cast<quint64>(region.mFirstSystem) + region.mSystemCount > header.mSystemCount)
+            {
+                return false;
+            }
+        }
+
+        mData = data;
+        mRegions = regions;
+        mSystems = reinterpret_cast<const SystemEntry *>(data + systemsOffset);
+        mRegionSystemIds = reinterpret_cast<const quint32 *>(data + regionSystemIdsOffset);
+        mSystemCount = header.mSystemCount;
+
+        return true;
+    }
+
+    QByteArray JumpDistanceMatrix::build(const JumpMap &jumps, quint64 fingerprint)
+    {
+        std::vector<RegionMatrix> regions;
+        regions.reserve(jumps.size());
+
+        for (const auto &regionJumps : jumps)
+        {
+            RegionMatrix region;
+            region.mRegionId = regionJumps.first;
+
+            for (const auto &jump : regionJumps.second)
+            {
+                region.mSystems.emplace_back(jump.first);
+                region.mSystems.emplace_back(jump.second);
+            }
+
+            std::sort(std::begin(region.mSystems), std::end(region.mSystems));
+            region.mSystems.erase(std::unique(std::begin(region.mSystems), std::end(region.mSystems)), std::end(region.mSystems));
+
+            regions.emplace_back(std::move(region));
+        }
+
+        std::sort(std::begin(regions), std::end(regions), [](const auto &a, const auto &b) {
+            return a.mRegionId < b.mRegionId;
+        });
+
+        QtConcurrent::blockingMap(regions, [&](auto &region) {
+            computeDistances(region, jumps.at(region.mRegionId));
+        });
+
+        quint64 systemCount = 0, matrixSize = 0;
+        for (const auto &region : regions)
+        {
+            systemCount += region.mSystems.size();
+            matrixSize += region.mDistances.size();
+        }
+
+        const auto regionsOffset = sizeof(Header);
+        const auto systemsOffset = regionsOffset + regions.size() * sizeof(RegionEntry);
+        const auto regionSystemIdsOffset = systemsOffset + systemCount * sizeof(SystemEntry);
+        auto matrixOffset = regionSystemIdsOffset + systemCount * sizeof(quint32);
+
+        QByteArray result{static_cast<int>(matrixOffset + matrixSize), '\0'};
+        const auto out = reinterpret_cast<uchar *>(result.data());
+
+        Header header{};
+        std::memcpy(header.mMagic, magic, sizeof(magic));
+        header.mVersion = version;
+        header.mFingerprint = fingerprint;
+        header.mRegionCount = static_cast<quint32>(regions.size());
+        header.mSystemCount = static_cast<quint32>(systemCount);
+
+        std::memcpy(out, &header, sizeof(header));
+
+        std::vector<SystemEntry> systems;
+        systems.reserve(systemCount);
+
+        std::vector<quint32> regionSystemIds;
+        regionSystemIds.reserve(systemCount);
+
+        for (auto i = 0u; i < regions.size(); ++i)
+        {
+            const auto &region = regions[i];
+
+            RegionEntry entry{};
+            entry.mMatrixOffset = matrixOffset;
+            entry.mSystemCount = static_cast<quint32>(region.mSystems.size());
+            entry.mFirstSystem = static_cast<quint32>(regionSystemIds.size());
+
+            std::memcpy(out + regionsOffset + i * sizeof(RegionEntry), &entry, sizeof(entry));
+            std::memcpy(out + matrixOffset, region.mDistances.data(), region.mDistances.size());
+
+            matrixOffset += region.mDistances.size();
+
+            for (auto j = 0u; j < region.mSystems.size(); ++j)
+            {
+                systems.emplace_back(SystemEntry{region.mSystems[j], i, j});
+                regionSystemIds.emplace_back(region.mSystems[j]);
+            }
+        }
+
+        std::sort(std::begin(systems), std::end(systems), [](const auto &a, const auto &b) {
+            return a.mSystemId < b.mSystemId;
+        });
+
+        std::memcpy(out + systemsOffset, systems.data(), systems.size() * sizeof(SystemEntry));
+        std::memcpy(out + regionSystemIdsOffset, regionSystemIds.data(), regionSystemIds.size() * sizeof(quint32));
+
+        return result;
+    }
+
+    quint64 JumpDistanceMatrix::getFingerprint(const JumpMap &jumps)
+    {
+        // order independent, since hash map iteration order is unspecified
+        quint64 fingerprint = 0;
+        for (const auto &regionJumps : jumps)
+        {
+            for (const auto &jump : regionJumps.second)
+            {
+                std::size_t seed = 0;
+                boost::hash_combine(seed, regionJumps.first);
+                boost::hash_combine(seed, jump.first);
+                boost::hash_combine(seed, jump.second);
+
+                fingerprint += seed;
+            }
+        }
+
+        return fingerprint;
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <limits>
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+
+namespace Evernus
+{
+    // all-pairs shortest jump counts within each region, kept in a memory-mapped cache file
+    class JumpDistanceMatrix final
+    {
+    public:
+        using JumpMap = std::unordered_map<uint, std::unordered_multimap<uint, uint>>;
+
+        static const uint unreachable = std::numeric_limits<uint>::max();
+
+        JumpDistanceMatrix() = default;
+        JumpDistanceMatrix(const JumpDistanceMatrix &) = delete;
+        JumpDistanceMatrix(JumpDistanceMatrix &&) = delete;
+        ~JumpDistanceMatrix() = default;
+
+        // maps the cache file if it was built from the same jumps, otherwise computes the matrices and rewrites it
+        void load(const QString &filePath, const JumpMap &jumps);
+
+        uint getDistance(uint startSystem, uint endSystem) const noexcept;
+        // systems in the same region no further than maxJumps, including the start one
+        std::vector<uint> getSystemsInRange(uint startSystem, uint maxJumps) const;
+
+        JumpDistanceMatrix &operator =(const JumpDistanceMatrix &) = delete;
+        JumpDistanceMatrix &operator =(JumpDistanceMatrix &&) = delete;
+
+    private:
+        struct Header
+        {
+            char mMagic[4];
+            quint32 mVersion;
+            quint64 mFingerprint;
+            quint32 mRegionCount;
+            quint32 mSystemCount;
+        };
+
+        struct RegionEntry
+        {
+            quint64 mMatrixOffset;
+            quint32 mSystemCount;
+            // into the region system id table, ordered by local index
+            quint32 mFirstSystem;
+        };
+
+        struct SystemEntry
+        {
+            quint32 mSystemId;
+            quint32 mRegionIndex;
+            quint32 mLocalIndex;
+        };
+
+        QFile mFile;
+        QByteArray mBuffer;
+
+        const uchar *mData = nullptr;
+        const RegionEntry *mRegions = nullptr;
+        const SystemEntry *mSystems = nullptr;
+        const quint32 *mRegionSystemIds = nullptr;
+        quint32 mSystemCount = 0;
+
+        const SystemEntry *findSystem(uint systemId) const noexcept;
+
+        bool map(quint64 fingerprint);
+        bool setData(const uchar *data, qint64 size, quint64 fingerprint);
+
+        static QByteArray build(const JumpMap &jumps, quint64 fingerprint);
+        static quint64 getFingerprint(const JumpMap &jumps);
+    };
+}
@@ -58,6 +58,11 @@ namespace Evernus
             db.exec(QStringLiteral("PRAGMA synchronous = %1").arg(
                 settings.value(DbSettings::synchronousKey, DbSettings::synchronousDefault).toInt()
             ));
+
+            // with write-ahead log readers work on their own snapshot and don't
+            // have to wait for the write queue to commit large imports
+            const auto walMode = settings.value(DbSettings::walModeKey, DbSettings::walModeDefault).toBool();
+            db.exec(QStringLiteral("PRAGMA journal_mode = %1").arg((walMode) ? (QStringLiteral("WAL")) : (QStringLiteral("DELETE"))));
         }
 
         return db;
@@ -38,8 +38,10 @@
 #endif
 
 #include "WalletTransactionsWidget.h"
+#include "DatabaseStatisticsDialog.h"
 #include "CharacterManagerDialog.h"
 #include "NewCharacterController.h"
+#include "CacheStatisticsDialog.h"
 #include "MarketAnalysisWidget.h"
 #include "CitadelManagerDialog.h"
 #include "WalletJournalWidget.h"
@@ -252,6 +254,18 @@ namespace Evernus
             emit citadelsEdited();
     }
 
+    void MainWindow::showDatabaseStatistics()
+    {
+        DatabaseStatisticsDialog dlg{this};
+        dlg.exec();
+    }
+
+    void MainWindow::showCacheStatistics()
+    {
+        CacheStatisticsDialog dlg{this};
+        dlg.exec();
+    }
+
     void MainWindow::showAbout()
     {
         AboutDialog dlg{this};
@@ -628,6 +642,8 @@ namespace Evernus
         toolsMenu->addAction(tr("Custom &Fast Price Copy"), this, &MainWindow::showCustomFPC);
         toolsMenu->addSeparator();
         toolsMenu->addAction(tr("Copy HTTP link"), this, &MainWindow::copyHTTPLink);
+        toolsMenu->addAction(tr("Database statistics..."), this, &MainWindow::showDatabaseStatistics);
+        toolsMenu->addAction(tr("Cache statistics..."), this, &MainWindow::showCacheStatistics);
 #ifdef EVERNUS_DROPBOX_ENABLED
         toolsMenu->addSeparator();
         toolsMenu->addAction(QIcon{":/images/arrow_refresh.png"}, tr("Upload data to cloud..."), this, &MainWindow::performSync);
@@ -721,6 +737,7 @@ namespace Evernus
         });
         connect(this, &MainWindow::charactersChanged, statsTab, &StatisticsWidget::updateBalanceData);
         connect(this, &MainWindow::externalOrdersChanged, statsTab, &StatisticsWidget::updateBalanceData);
+        connect(this, &MainWindow::externalOrdersChangedForTypes, statsTab, &StatisticsWidget::updateBalanceData);
         connect(this, &MainWindow::characterAssetsChanged, statsTab, &StatisticsWidget::updateBalanceData);
         connect(this, &MainWindow::characterWalletJournalChanged, statsTab, &StatisticsWidget::updateBalanceData);
         connect(this, &MainWindow::characterWalletJournalChanged, statsTab, &StatisticsWidget::updateJournalData);
@@ -747,6 +764,7 @@ namespace Evernus
         connect(this, &MainWindow::characterAssetsChanged, assetsTab, &AssetsWidget::updateData);
         connect(this, &MainWindow::externalOrdersChanged, assetsTab, &AssetsWidget::updateData);
         connect(this, &MainWindow::externalOrdersChangedWithMarketOrders, assetsTab, &AssetsWidget::updateData);
+        connect(this, &MainWindow::externalOrdersChangedForTypes, assetsTab, &AssetsWidget::updateData);
         connect(this, &MainWindow::itemVolumeChanged, assetsTab, &AssetsWidget::updateData);
 
         auto orderTab = new MarketOrderWidget{charOrderProvider,
@@ -773,6 +791,7 @@ namespace Evernus
         connect(this, &MainWindow::characterMarketOrdersChanged, orderTab, &MarketOrderWidget::updateData);
         connect(this, &MainWindow::corpMarketOrdersChanged, orderTab, &MarketOrderWidget::updateData);
         connect(this, &MainWindow::externalOrdersChanged, orderTab, &MarketOrderWidget::updateData);
+        connect(this, &MainWindow::externalOrdersChangedForTypes, orderTab, &MarketOrderWidget::updateTypes);
         connect(this, &MainWindow::citadelsChanged, orderTab, &MarketOrderWidget::updateData);
         connect(this, &MainWindow::itemCostsChanged, orderTab, &MarketOrderWidget::updateData);
         connect(this, &MainWindow::charactersChanged, orderTab, &MarketOrderWidget::updateCharacters);
@@ -829,6 +848,7 @@ namespace Evernus
         connect(this, &MainWindow::corpAssetsChanged, corpAssetsTab, &AssetsWidget::updateData);
         connect(this, &MainWindow::externalOrdersChanged, corpAssetsTab, &AssetsWidget::updateData);
         connect(this, &MainWindow::externalOrdersChangedWithMarketOrders, corpAssetsTab, &AssetsWidget::updateData);
+        connect(this, &MainWindow::externalOrdersChangedForTypes, corpAssetsTab, &AssetsWidget::updateData);
         connect(this, &MainWindow::itemVolumeChanged, corpAssetsTab, &AssetsWidget::updateData);
 
         auto corpOrderTab = new MarketOrderWidget{corpOrderProvider,
@@ -854,6 +874,7 @@ namespace Evernus
         connect(corpOrderTab, &MarketOrderWidget::fpcExecutorChanged, &mFPCController, &FPCController::changeExecutor);
         connect(this, &MainWindow::corpMarketOrdersChanged, corpOrderTab, &MarketOrderWidget::updateData);
         connect(this, &MainWindow::externalOrdersChanged, corpOrderTab, &MarketOrderWidget::updateData);
+        connect(this, &MainWindow::externalOrdersChangedForTypes, corpOrderTab, &MarketOrderWidget::updateTypes);
         connect(this, &MainWindow::citadelsChanged, corpOrderTab, &MarketOrderWidget::updateData);
         connect(this, &MainWindow::itemCostsChanged, corpOrderTab, &MarketOrderWidget::updateData);
         connect(this, &MainWindow::charactersChanged, corpOrderTab, &MarketOrderWidget::updateCharacters);
@@ -926,6 +947,7 @@ namespace Evernus
         connect(this, &MainWindow::characterMarketOrdersChanged, mMarketBrowserTab, &MarketBrowserWidget::fillOrderItemNames);
         connect(this, &MainWindow::corpMarketOrdersChanged, mMarketBrowserTab, &MarketBrowserWidget::fillOrderItemNames);
         connect(this, &MainWindow::externalOrdersChanged, mMarketBrowserTab, &MarketBrowserWidget::updateData);
+        connect(this, &MainWindow::externalOrdersChangedForTypes, mMarketBrowserTab, &MarketBrowserWidget::updateData);
         connect(this, &MainWindow::itemVolumeChanged, mMarketBrowserTab, &MarketBrowserWidget::updateData);
         connect(this, &MainWindow::preferencesChanged, mMarketBrowserTab, &MarketBrowserWidget::preferencesChanged);
 
@@ -945,6 +967,7 @@ namespace Evernus
         connect(lmEveTab, &LMeveWidget::importPricesFromWeb, this, &MainWindow::importExternalOrdersFromWeb);
         connect(lmEveTab, &LMeveWidget::importPricesFromFile, this, &MainWindow::importExternalOrdersFromFile);
         connect(this, &MainWindow::externalOrdersChanged, lmEveTab, &LMeveWidget::updateData);
+        connect(this, &MainWindow::externalOrdersChangedForTypes, lmEveTab, &LMeveWidget::updateData);
         connect(this, &MainWindow::lMeveTasksChanged, lmEveTab, &LMeveWidget::updateData);
 
         auto marketAnalysisTab = new MarketAnalysisWidget{mEveDataProvider,
@@ -94,6 +94,7 @@ namespace Evernus
         void characterAssetsChanged();
         void externalOrdersChanged();
         void externalOrdersChangedWithMarketOrders();
+        void externalOrdersChangedForTypes(const TypeLocationPairs &typeRegions);
         void characterWalletJournalChanged();
         void characterWalletTransactionsChanged();
         void characterMarketOrdersChanged();
@@ -160,6 +161,8 @@ namespace Evernus
         void showMarginTool();
         void showCustomFPC();
         void showCitadelManager();
+        void showDatabaseStatistics();
+        void showCacheStatistics();
         void showAbout();
         void openHelp();
         void checkForUpdates();
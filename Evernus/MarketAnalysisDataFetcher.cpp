@@ -38,7 +38,7 @@ namespace Evernus
                                                          QObject *parent)
         : QObject{parent}
         , mDataProvider{dataProvider}
-        , mESIManager{mDataProvider, interfaceManager}
+        , mESIManager{mDataProvider, interfaceManager, ESIRequestPriority::ForegroundImport}
     {
         connect(&mESIManager, &ESIManager::error, this, &MarketAnalysisDataFetcher::genericError);
     }
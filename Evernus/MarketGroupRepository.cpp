@@ -60,7 +60,10 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return populate(query.record());
+        auto group = populate(query.record());
+        query.finish();
+
+        return group;
     }
 
     QStringList MarketGroupRepository::getColumns() const
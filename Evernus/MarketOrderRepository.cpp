@@ -182,6 +182,8 @@ namespace Evernus
             }
         }
 
+        query.finish();
+
         return data;
     }
 
@@ -403,6 +405,21 @@ namespace Evernus
         return result;
     }
 
+    MarketOrderRepository::OrderIdList MarketOrderRepository::fetchActiveIds() const
+    {
+        auto query = prepare(QStringLiteral("SELECT id FROM %1 WHERE state = ?").arg(getTableName()));
+        query.bindValue(0, static_cast<int>(MarketOrder::State::Active));
+
+        DatabaseUtils::execQuery(query);
+
+        OrderIdList result;
+
+        while (query.next())
+            result.insert(query.value(0).value<MarketOrder::IdType>());
+
+        return result;
+    }
+
     void MarketOrderRepository::archive(const std::vector<MarketOrder::IdType> &ids) const
     {
         const auto baseQuery = QStringLiteral("UPDATE %1 SET "
@@ -108,6 +108,7 @@ namespace Evernus
                                                 uint corporationId) const;
 
         TypeLocationPairs fetchActiveTypes() const;
+        OrderIdList fetchActiveIds() const;
 
         void archive(const std::vector<MarketOrder::IdType> &ids) const;
         void fulfill(const std::vector<MarketOrder::IdType> &ids) const;
@@ -315,6 +315,11 @@ namespace Evernus
         endResetModel();
     }
 
+    void MarketOrderTreeModel::refreshTypes(const TypeLocationPairs &typeRegions)
+    {
+        refreshTypes(typeRegions, mRootItem, QModelIndex{});
+    }
+
     QString MarketOrderTreeModel::getGroupName(EveType::IdType typeId) const
     {
         auto group = mDataProvider.getTypeMarketGroupParentName(typeId);
@@ -332,6 +337,27 @@ namespace Evernus
     {
     }
 
+    void MarketOrderTreeModel::refreshTypes(const TypeLocationPairs &typeRegions, const TreeItem &parentItem, const QModelIndex &parent)
+    {
+        const auto lastColumn = columnCount() - 1;
+
+        for (auto row = 0; row < parentItem.childCount(); ++row)
+        {
+            const auto item = parentItem.child(row);
+            const auto order = item->getOrder();
+
+            if (order == nullptr)
+            {
+                refreshTypes(typeRegions, *item, index(row, 0, parent));
+                continue;
+            }
+
+            const auto regionId = mDataProvider.getStationRegionId(order->getEffectiveStationId());
+            if (typeRegions.find(std::make_pair(order->getTypeId(), static_cast<quint64>(regionId))) != std::end(typeRegions))
+                emit dataChanged(index(row, 0, parent), index(row, lastColumn, parent));
+        }
+    }
+
     quintptr MarketOrderTreeModel::getGroupingId(const MarketOrder &order) const
     {
         switch (mGrouping) {
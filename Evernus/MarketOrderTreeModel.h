@@ -17,6 +17,7 @@
 #include <vector>
 #include <memory>
 
+#include "TypeLocationPairs.h"
 #include "MarketOrderModel.h"
 #include "MarketOrder.h"
 #include "Character.h"
@@ -52,6 +53,8 @@ namespace Evernus
         void setGrouping(Grouping grouping);
 
         void reset();
+        // repaints orders for given types in given regions, without reloading
+        void refreshTypes(const TypeLocationPairs &typeRegions);
 
     protected:
         class TreeItem
@@ -114,6 +117,8 @@ namespace Evernus
         virtual void handleAllCharacters();
         virtual void handleOrderRemoval(const MarketOrder &order) = 0;
 
+        void refreshTypes(const TypeLocationPairs &typeRegions, const TreeItem &parentItem, const QModelIndex &parent);
+
         quintptr getGroupingId(const MarketOrder &order) const;
         QString getGroupingData(const MarketOrder &order) const;
     };
@@ -293,6 +293,13 @@ namespace Evernus
         expandAll();
     }
 
+    void MarketOrderWidget::updateTypes(const TypeLocationPairs &typeRegions)
+    {
+        refreshImportTimer();
+        mSellModel.refreshTypes(typeRegions);
+        mBuyModel.refreshTypes(typeRegions);
+    }
+
     void MarketOrderWidget::updateCharacters()
     {
         mSellView->updateCharacters();
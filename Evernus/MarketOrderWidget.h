@@ -75,6 +75,7 @@ namespace Evernus
 
     public slots:
         void updateData();
+        void updateTypes(const TypeLocationPairs &typeRegions);
         void updateCharacters();
 
     private slots:
@@ -107,6 +107,13 @@ namespace Evernus
         mMaxRetriesEdit->setValue(
             settings.value(NetworkSettings::maxRetriesKey, NetworkSettings::maxRetriesDefault).toUInt());
 
+        mMaxConcurrentRequestsEdit = new QSpinBox{this};
+        miscGroupLayout->addRow(tr("Max. concurrent ESI requests:"), mMaxConcurrentRequestsEdit);
+        mMaxConcurrentRequestsEdit->setRange(1, 100);
+        mMaxConcurrentRequestsEdit->setToolTip(tr("Upper limit - fewer requests are sent when ESI error budget runs low."));
+        mMaxConcurrentRequestsEdit->setValue(
+            settings.value(NetworkSettings::maxConcurrentRequestsKey, NetworkSettings::maxConcurrentRequestsDefault).toUInt());
+
         mIgnoreSslErrors = new QCheckBox{tr("Ignore certificate errors"), this};
         miscGroupLayout->addRow(mIgnoreSslErrors);
         mIgnoreSslErrors->setChecked(
@@ -162,6 +169,7 @@ namespace Evernus
 
         settings.setValue(NetworkSettings::maxReplyTimeKey, mMaxReplyTimeEdit->value());
         settings.setValue(NetworkSettings::maxRetriesKey, mMaxRetriesEdit->value());
+        settings.setValue(NetworkSettings::maxConcurrentRequestsKey, mMaxConcurrentRequestsEdit->value());
         settings.setValue(NetworkSettings::ignoreSslErrorsKey, mIgnoreSslErrors->isChecked());
         settings.setValue(NetworkSettings::logESIRepliesKey, mLogESIReplies->isChecked());
         settings.setValue(NetworkSettings::useHTTP2Key, mUseHTTP2->isChecked());
@@ -53,6 +53,7 @@ namespace Evernus
 
         QSpinBox *mMaxReplyTimeEdit = nullptr;
         QSpinBox *mMaxRetriesEdit = nullptr;
+        QSpinBox *mMaxConcurrentRequestsEdit = nullptr;
         QCheckBox *mIgnoreSslErrors = nullptr;
         QCheckBox *mLogESIReplies = nullptr;
         QCheckBox *mUseHTTP2 = nullptr;
@@ -0,0 +1,155 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdexcept>
+#include <utility>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <list>
+
+#include <boost/throw_exception.hpp>
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QHash>
+
+#include <QtDebug>
+
+#include "PreparedStatementCache.h"
+
+namespace Evernus::PreparedStatementCache
+{
+    namespace
+    {
+        // some queries embed values in the sql text, so we need to keep the cache bounded
+        const auto maxStatementsPerConnection = 256;
+
+        struct ConnectionCache
+        {
+            using LruList = std::list<QString>;
+
+            struct Entry
+            {
+                QSqlQuery mQuery;
+                LruList::iterator mLruPos;
+                // expired when no handed out copy is alive
+                std::weak_ptr<void> mLease;
+            };
+
+            QHash<QString, Entry> mStatements;
+            LruList mLru;
+        };
+
+        std::mutex cacheMutex;
+        QHash<QString, ConnectionCache> caches;
+
+        std::atomic<quint64> hits{0}, misses{0}, evictions{0};
+    }
+
+    Query::Query(const QSqlQuery &query, std::shared_ptr<void> lease)
+        : QSqlQuery{query}
+        , mLease{std::move(lease)}
+    {
+    }
+
+    Query prepare(const QSqlDatabase &db, const QString &queryStr)
+    {
+        const auto connectionName = db.connectionName();
+
+        {
+            std::lock_guard<std::mutex> lock{cacheMutex};
+
+            auto &cache = caches[connectionName];
+
+            const auto entry = cache.mStatements.find(queryStr);
+            if (entry != std::end(cache.mStatements) && entry->mLease.expired())
+            {
+                cache.mLru.splice(std::begin(cache.mLru), cache.mLru, entry->mLruPos);
+                ++hits;
+
+                auto query = entry->mQuery;
+                query.finish();
+                query.setForwardOnly(false);
+
+                const auto lease = std::make_shared<char>();
+                entry->mLease = lease;
+
+                return Query{query, lease};
+            }
+        }
+
+        ++misses;
+
+        QSqlQuery query{db};
+        if (!query.prepare(queryStr))
+        {
+            const auto error = query.lastError().text();
+
+            qCritical() << error;
+            BOOST_THROW_EXCEPTION(std::runtime_error{error.toStdString()});
+        }
+
+        std::lock_guard<std::mutex> lock{cacheMutex};
+
+        // statements in use stay cached, so this one is only for the caller
+        std::shared_ptr<void> lease;
+
+        auto &cache = caches[connectionName];
+        if (!cache.mStatements.contains(queryStr))
+        {
+            lease = std::make_shared<char>();
+
+            cache.mLru.emplace_front(queryStr);
+            cache.mStatements.insert(queryStr, { query, std::begin(cache.mLru), lease });
+
+            while (cache.mStatements.size() > maxStatementsPerConnection)
+            {
+                cache.mStatements.remove(cache.mLru.back());
+                cache.mLru.pop_back();
+
+                ++evictions;
+            }
+        }
+
+        return Query{query, lease};
+    }
+
+    void clear(const QString &connectionName)
+    {
+        std::lock_guard<std::mutex> lock{cacheMutex};
+        caches.remove(connectionName);
+    }
+
+    void clearAll()
+    {
+        std::lock_guard<std::mutex> lock{cacheMutex};
+        caches.clear();
+    }
+
+    Stats getStats()
+    {
+        Stats stats;
+        stats.mHits = hits;
+        stats.mMisses = misses;
+        stats.mEvictions = evictions;
+
+        std::lock_guard<std::mutex> lock{cacheMutex};
+        for (const auto &cache : caches)
+            stats.mStatements += cache.mStatements.size();
+
+        return stats;
+    }
+}
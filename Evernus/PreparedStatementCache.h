@@ -0,0 +1,60 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+
+#include <QSqlQuery>
+
+class QSqlDatabase;
+class QString;
+
+namespace Evernus::PreparedStatementCache
+{
+    struct Stats
+    {
+        quint64 mHits = 0;
+        quint64 mMisses = 0;
+        quint64 mEvictions = 0;
+        quint64 mStatements = 0;
+    };
+
+    // keeps the cached statement marked as in use while any copy is alive
+    class Query final
+        : public QSqlQuery
+    {
+    public:
+        Query(const QSqlQuery &query, std::shared_ptr<void> lease);
+        Query(const Query &) = default;
+        Query(Query &&) = default;
+        ~Query() = default;
+
+        Query &operator =(const Query &) = default;
+        Query &operator =(Query &&) = default;
+
+    private:
+        std::shared_ptr<void> mLease;
+    };
+
+    // returns a prepared query for given connection and sql, reusing a previously prepared statement if possible
+    // the returned query is reset (including forward-only mode) and ready for rebinding
+    // while a statement is in use, e.g. by a reentrant call during iteration, the same sql gets a fresh uncached one
+    Query prepare(const QSqlDatabase &db, const QString &queryStr);
+
+    void clear(const QString &connectionName);
+    void clearAll();
+
+    Stats getStats();
+}
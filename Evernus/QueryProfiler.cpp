@@ -0,0 +1,305 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <mutex>
+
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <QJsonObject>
+#include <QStringList>
+#include <QJsonArray>
+#include <QSqlDriver>
+#include <QSqlResult>
+#include <QFileInfo>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QDir>
+
+#include <QtDebug>
+
+#include "PreparedStatementCache.h"
+
+#include "QueryProfiler.h"
+
+namespace Evernus::QueryProfiler
+{
+    namespace
+    {
+        // queries with values embedded in the sql text would grow this forever
+        const auto maxStatements = 4096;
+        // latest samples kept for percentiles
+        const auto maxSamples = 1024u;
+
+        struct Entry
+        {
+            quint64 mCount = 0;
+            quint64 mRows = 0;
+            Duration mTotalTime = Duration::zero();
+            Duration mMaxTime = Duration::zero();
+            std::vector<Duration> mSamples;
+            std::size_t mNextSample = 0;
+            QString mQueryPlan;
+            bool mPlanRequested = false;
+        };
+
+        std::atomic_bool enabled{false};
+        std::atomic<std::chrono::milliseconds::rep> slowQueryThreshold{200};
+
+        std::mutex statsMutex;
+        QHash<QString, Entry> stats;
+
+        std::mutex logMutex;
+
+        double toMilliseconds(Duration time)
+        {
+            return std::chrono::duration<double, std::milli>{time}.count();
+        }
+
+        double getPercentile(std::vector<Duration> samples, double percentile)
+        {
+            if (samples.empty())
+                return 0.;
+
+            const auto nth = std::next(std::begin(samples), static_cast<std::size_t>(percentile * (samples.size() - 1)));
+            std::nth_element(std::begin(samples), nth, std::end(samples));
+
+            return toMilliseconds(*nth);
+        }
+
+        QString explainQuery(const QSqlQuery &query)
+        {
+            const auto driver = query.driver();
+            if (driver == nullptr)
+                return QString{};
+
+            // use a new result on the same connection, so the original query and its bindings stay intact
+            QSqlQuery plan{driver->createResult()};
+            if (!plan.prepare(QStringLiteral("EXPLAIN QUERY PLAN ") + query.lastQuery()))
+            {
+                qWarning() << "Cannot prepare query plan:" << plan.lastError();
+                return QString{};
+            }
+
+            const auto boundValues = query.boundValues().size();
+            for (auto i = 0; i < boundValues; ++i)
+                plan.addBindValue(query.boundValue(i));
+
+            if (!plan.exec())
+            {
+                qWarning() << "Cannot get query plan:" << plan.lastError();
+                return QString{};
+            }
+
+            QStringList lines;
+            while (plan.next())
+                lines << plan.value(3).toString();
+
+            return lines.join(QStringLiteral("\n"));
+        }
+
+        void logSlowQuery(const QString &queryStr, Duration time, const QString &queryPlan)
+        {
+            qWarning() << "Slow SQL:" << toMilliseconds(time) << "ms" << queryStr;
+
+            std::lock_guard<std::mutex> lock{logMutex};
+
+            QFile file{getSlowQueryLogPath()};
+            QDir{}.mkpath(QFileInfo{file}.path());
+
+            if (!file.open(QIODevice::Append | QIODevice::Text))
+                return;
+
+            QTextStream stream{&file};
+            stream
+                << QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs)
+                << ' ' << toMilliseconds(time) << "ms " << queryStr << '\n';
+
+            if (!queryPlan.isEmpty())
+                stream << queryPlan << '\n';
+        }
+    }
+
+    void setEnabled(bool flag)
+    {
+        enabled = flag;
+    }
+
+    bool isEnabled() noexcept
+    {
+        return enabled;
+    }
+
+    void setSlowQueryThreshold(std::chrono::milliseconds threshold)
+    {
+        slowQueryThreshold = threshold.count();
+    }
+
+    void recordExecution(const QSqlQuery &query, Duration time)
+    {
+        if (!enabled)
+            return;
+
+        const auto queryStr = query.lastQuery();
+        const auto slow = time >= std::chrono::milliseconds{slowQueryThreshold};
+
+        auto capturePlan = false;
+
+        {
+            std::lock_guard<std::mutex> lock{statsMutex};
+
+            auto entry = stats.find(queryStr);
+            if (entry == std::end(stats))
+            {
+                if (stats.size() >= maxStatements)
+                    return;
+
+                entry = stats.insert(queryStr, Entry{});
+            }
+
+            ++entry->mCount;
+            entry->mTotalTime += time;
+            entry->mMaxTime = std::max(entry->mMaxTime, time);
+
+            if (!query.isSelect() && query.numRowsAffected() > 0)
+                entry->mRows += query.numRowsAffected();
+
+            if (entry->mSamples.size() < maxSamples)
+            {
+                entry->mSamples.emplace_back(time);
+            }
+            else
+            {
+                entry->mSamples[entry->mNextSample] = time;
+                entry->mNextSample = (entry->mNextSample + 1) % maxSamples;
+            }
+
+            if (slow && !entry->mPlanRequested)
+            {
+                entry->mPlanRequested = true;
+                capturePlan = true;
+            }
+        }
+
+        if (!slow)
+            return;
+
+        QString queryPlan;
+        if (capturePlan)
+        {
+            queryPlan = explainQuery(query);
+
+            std::lock_guard<std::mutex> lock{statsMutex};
+
+            const auto entry = stats.find(queryStr);
+            if (entry != std::end(stats))
+                entry->mQueryPlan = queryPlan;
+        }
+
+        logSlowQuery(queryStr, time, queryPlan);
+    }
+
+    void recordRows(const QString &queryStr, std::size_t rows)
+    {
+        if (!enabled)
+            return;
+
+        std::lock_guard<std::mutex> lock{statsMutex};
+
+        const auto entry = stats.find(queryStr);
+        if (entry != std::end(stats))
+            entry->mRows += rows;
+    }
+
+    std::vector<StatementStats> getStats()
+    {
+        std::vector<StatementStats> result;
+
+        std::lock_guard<std::mutex> lock{statsMutex};
+
+        result.reserve(stats.size());
+
+        for (auto it = std::begin(stats); it != std::end(stats); ++it)
+        {
+            const auto &entry = it.value();
+
+            StatementStats statement;
+            statement.mQuery = it.key();
+            statement.mQueryPlan = entry.mQueryPlan;
+            statement.mCount = entry.mCount;
+            statement.mRows = entry.mRows;
+            statement.mTotalTime = toMilliseconds(entry.mTotalTime);
+            statement.mMedianTime = getPercentile(entry.mSamples, 0.5);
+            statement.mP95Time = getPercentile(entry.mSamples, 0.95);
+            statement.mP99Time = getPercentile(entry.mSamples, 0.99);
+            statement.mMaxTime = toMilliseconds(entry.mMaxTime);
+
+            result.emplace_back(std::move(statement));
+        }
+
+        return result;
+    }
+
+    QByteArray exportJson()
+    {
+        QJsonArray statements;
+        for (const auto &statement : getStats())
+        {
+            statements.append(QJsonObject{
+                { QStringLiteral("query"), statement.mQuery },
+                { QStringLiteral("count"), static_cast<double>(statement.mCount) },
+                { QStringLiteral("rows"), static_cast<double>(statement.mRows) },
+                { QStringLiteral("totalMs"), statement.mTotalTime },
+                { QStringLiteral("medianMs"), statement.mMedianTime },
+                { QStringLiteral("p95Ms"), statement.mP95Time },
+                { QStringLiteral("p99Ms"), statement.mP99Time },
+                { QStringLiteral("maxMs"), statement.mMaxTime },
+                { QStringLiteral("queryPlan"), statement.mQueryPlan },
+            });
+        }
+
+        const auto cacheStats = PreparedStatementCache::getStats();
+
+        const QJsonObject root{
+            { QStringLiteral("generated"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate) },
+            { QStringLiteral("slowQueryThresholdMs"), static_cast<double>(slowQueryThreshold) },
+            { QStringLiteral("preparedStatementCache"), QJsonObject{
+                { QStringLiteral("hits"), static_cast<double>(cacheStats.mHits) },
+                { QStringLiteral("misses"), static_cast<double>(cacheStats.mMisses) },
+                { QStringLiteral("evictions"), static_cast<double>(cacheStats.mEvictions) },
+                { QStringLiteral("statements"), static_cast<double>(cacheStats.mStatements) },
+            } },
+            { QStringLiteral("statements"), statements },
+        };
+
+        return QJsonDocument{root}.toJson();
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock{statsMutex};
+        stats.clear();
+    }
+
+    QString getSlowQueryLogPath()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/log/slow_queries.log");
+    }
+}
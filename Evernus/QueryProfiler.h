@@ -0,0 +1,59 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <QString>
+
+class QSqlQuery;
+class QByteArray;
+
+namespace Evernus::QueryProfiler
+{
+    using Duration = std::chrono::steady_clock::duration;
+
+    struct StatementStats
+    {
+        QString mQuery;
+        QString mQueryPlan;
+        quint64 mCount = 0;
+        quint64 mRows = 0;
+        double mTotalTime = 0.;
+        double mMedianTime = 0.;
+        double mP95Time = 0.;
+        double mP99Time = 0.;
+        double mMaxTime = 0.;
+    };
+
+    void setEnabled(bool flag);
+    bool isEnabled() noexcept;
+
+    // statements slower than this get logged and have their query plan captured once
+    void setSlowQueryThreshold(std::chrono::milliseconds threshold);
+
+    void recordExecution(const QSqlQuery &query, Duration time);
+    // rows decoded from a select, reported by whoever iterated the result
+    void recordRows(const QString &queryStr, std::size_t rows);
+
+    // times are in milliseconds
+    std::vector<StatementStats> getStats();
+    QByteArray exportJson();
+
+    void reset();
+
+    QString getSlowQueryLogPath();
+}
@@ -19,6 +19,8 @@
 
 #include <QSqlDatabase>
 
+#include "PreparedStatementCache.h"
+
 namespace Evernus
 {
     class DatabaseConnectionProvider;
@@ -31,6 +33,9 @@ namespace Evernus
 
         typedef std::shared_ptr<T> EntityPtr;
         typedef std::vector<EntityPtr> EntityList;
+        // entities stored by value in one contiguous buffer owned by the result
+        typedef std::vector<T> ValueList;
+        typedef std::vector<int> ColumnOrdinals;
 
         explicit Repository(const DatabaseConnectionProvider &connectionProvider);
         virtual ~Repository() = default;
@@ -41,7 +46,7 @@ namespace Evernus
         virtual EntityPtr populate(const QSqlRecord &record) const = 0;
 
         QSqlQuery exec(const QString &query) const;
-        QSqlQuery prepare(const QString &queryStr) const;
+        PreparedStatementCache::Query prepare(const QString &queryStr) const;
         void store(T &entity) const;
 
         template<class U>
@@ -52,6 +57,13 @@ namespace Evernus
 
         EntityList fetchAll() const;
 
+        // streams all rows through visitor(const T &) without materializing the whole table
+        template<class Visitor>
+        void forEach(Visitor &&visitor) const;
+        // streams all rows in batches of value objects through visitor(const std::vector<T> &)
+        template<class Visitor>
+        void forEachChunk(std::size_t chunkSize, Visitor &&visitor) const;
+
         template<class Id>
         EntityPtr find(Id &&id) const;
 
@@ -62,6 +74,22 @@ namespace Evernus
     protected:
         const size_t maxSqliteBoundVariables = 999;
 
+        EntityList populateAll(QSqlQuery &query) const;
+        // execute a prepared query in forward-only mode and decode rows in place, without per-row allocations
+        ValueList fetchValues(QSqlQuery &query) const;
+
+        // repositories which can decode rows by column ordinal should override these to avoid
+        // per-row name lookups; ordinals are resolved once per query
+        virtual ColumnOrdinals resolveOrdinals(const QSqlRecord &record) const;
+        virtual EntityPtr populateRow(const QSqlQuery &query, const ColumnOrdinals &ordinals) const;
+        virtual void decodeRow(const QSqlQuery &query, const ColumnOrdinals &ordinals, T &entity) const;
+
+        // execute a prepared query in forward-only mode and stream the results, so only the current row is held in memory
+        template<class Visitor>
+        void streamRows(QSqlQuery &query, Visitor &&visitor) const;
+        template<class Visitor>
+        void streamChunks(QSqlQuery &query, std::size_t chunkSize, Visitor &&visitor) const;
+
     private:
         const DatabaseConnectionProvider &mConnectionProvider;
 
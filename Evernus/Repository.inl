@@ -13,6 +13,8 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdexcept>
+#include <utility>
+#include <chrono>
 
 #include <QSqlRecord>
 #include <QSqlQuery>
@@ -21,6 +23,7 @@
 #include <QtDebug>
 
 #include "DatabaseConnectionProvider.h"
+#include "QueryProfiler.h"
 #include "DatabaseUtils.h"
 
 namespace Evernus
@@ -38,9 +41,13 @@ namespace Evernus
 
         const auto db = getDatabase();
 
+        const auto start = std::chrono::steady_clock::now();
+
         auto result = db.exec(query);
         const auto error = db.lastError();
 
+        QueryProfiler::recordExecution(result, std::chrono::steady_clock::now() - start);
+
         if (error.isValid())
         {
             const auto errorText = error.text();
@@ -53,18 +60,9 @@ namespace Evernus
     }
 
     template<class T>
-    QSqlQuery Repository<T>::prepare(const QString &queryStr) const
+    PreparedStatementCache::Query Repository<T>::prepare(const QString &queryStr) const
     {
-        QSqlQuery query{getDatabase()};
-        if (!query.prepare(queryStr))
-        {
-            const auto error = query.lastError().text();
-
-            qCritical() << error;
-            throw std::runtime_error{error.toStdString()};
-        }
-
-        return query;
+        return PreparedStatementCache::prepare(getDatabase(), queryStr);
     }
 
     template<class T>
@@ -121,7 +119,7 @@ namespace Evernus
         auto db = getDatabase();
 
         if (wrapIntransaction)
-            db.transaction();
+            DatabaseUtils::beginTransaction(db);
 
         try
         {
@@ -151,6 +149,9 @@ namespace Evernus
 
                 DatabaseUtils::execQuery(query);
             }
+
+            if (wrapIntransaction)
+                DatabaseUtils::commitTransaction(db);
         }
         catch (...)
         {
@@ -159,9 +160,6 @@ namespace Evernus
 
             throw;
         }
-
-        if (wrapIntransaction)
-            db.commit();
     }
 
     template<class T>
@@ -176,17 +174,24 @@ namespace Evernus
     template<class T>
     typename Repository<T>::EntityList Repository<T>::fetchAll() const
     {
-        EntityList out;
-
         auto result = exec(QStringLiteral("SELECT * FROM %1").arg(getTableName()));
-        const auto size = result.size();
-        if (size != -1)
-            out.reserve(size);
+        return populateAll(result);
+    }
 
-        while (result.next())
-            out.emplace_back(populate(result.record()));
+    template<class T>
+    template<class Visitor>
+    void Repository<T>::forEach(Visitor &&visitor) const
+    {
+        auto query = prepare(QStringLiteral("SELECT * FROM %1").arg(getTableName()));
+        streamRows(query, std::forward<Visitor>(visitor));
+    }
 
-        return out;
+    template<class T>
+    template<class Visitor>
+    void Repository<T>::forEachChunk(std::size_t chunkSize, Visitor &&visitor) const
+    {
+        auto query = prepare(QStringLiteral("SELECT * FROM %1").arg(getTableName()));
+        streamChunks(query, chunkSize, std::forward<Visitor>(visitor));
     }
 
     template<class T>
@@ -200,7 +205,12 @@ namespace Evernus
         if (!query.next())
             throw NotFoundException{};
 
-        return populate(query.record());
+        auto entity = populateRow(query, resolveOrdinals(query.record()));
+
+        // cached statements stay active until reset, holding the read snapshot
+        query.finish();
+
+        return entity;
     }
 
     template<class T>
@@ -209,6 +219,144 @@ namespace Evernus
         return mConnectionProvider.getConnection();
     }
 
+    template<class T>
+    typename Repository<T>::EntityList Repository<T>::populateAll(QSqlQuery &query) const
+    {
+        EntityList out;
+
+        const auto size = query.size();
+        if (size > 0)
+            out.reserve(size);
+
+        if (query.next())
+        {
+            const auto ordinals = resolveOrdinals(query.record());
+
+            do
+            {
+                out.emplace_back(populateRow(query, ordinals));
+            } while (query.next());
+        }
+
+        QueryProfiler::recordRows(query.lastQuery(), out.size());
+
+        return out;
+    }
+
+    template<class T>
+    typename Repository<T>::ValueList Repository<T>::fetchValues(QSqlQuery &query) const
+    {
+        query.setForwardOnly(true);
+        DatabaseUtils::execQuery(query);
+
+        ValueList out;
+        if (!query.next())
+            return out;
+
+        const auto ordinals = resolveOrdinals(query.record());
+
+        do
+        {
+            out.emplace_back();
+            decodeRow(query, ordinals, out.back());
+        } while (query.next());
+
+        query.finish();
+
+        QueryProfiler::recordRows(query.lastQuery(), out.size());
+
+        return out;
+    }
+
+    template<class T>
+    typename Repository<T>::ColumnOrdinals Repository<T>::resolveOrdinals(const QSqlRecord &record) const
+    {
+        Q_UNUSED(record);
+        return {};
+    }
+
+    template<class T>
+    typename Repository<T>::EntityPtr Repository<T>::populateRow(const QSqlQuery &query, const ColumnOrdinals &ordinals) const
+    {
+        Q_UNUSED(ordinals);
+        return populate(query.record());
+    }
+
+    template<class T>
+    void Repository<T>::decodeRow(const QSqlQuery &query, const ColumnOrdinals &ordinals, T &entity) const
+    {
+        entity = *populateRow(query, ordinals);
+    }
+
+    template<class T>
+    template<class Visitor>
+    void Repository<T>::streamRows(QSqlQuery &query, Visitor &&visitor) const
+    {
+        query.setForwardOnly(true);
+        DatabaseUtils::execQuery(query);
+
+        if (!query.next())
+            return;
+
+        const auto ordinals = resolveOrdinals(query.record());
+
+        std::size_t rows = 0;
+
+        T entity;
+        do
+        {
+            decodeRow(query, ordinals, entity);
+            visitor(static_cast<const T &>(entity));
+
+            ++rows;
+        } while (query.next());
+
+        query.finish();
+
+        QueryProfiler::recordRows(query.lastQuery(), rows);
+    }
+
+    template<class T>
+    template<class Visitor>
+    void Repository<T>::streamChunks(QSqlQuery &query, std::size_t chunkSize, Visitor &&visitor) const
+    {
+        Q_ASSERT(chunkSize > 0);
+
+        query.setForwardOnly(true);
+        DatabaseUtils::execQuery(query);
+
+        if (!query.next())
+            return;
+
+        const auto ordinals = resolveOrdinals(query.record());
+
+        std::size_t rows = 0;
+
+        std::vector<T> chunk;
+        chunk.reserve(chunkSize);
+
+        do
+        {
+            chunk.emplace_back();
+            decodeRow(query, ordinals, chunk.back());
+
+            ++rows;
+
+            if (chunk.size() == chunkSize)
+            {
+                visitor(static_cast<const std::vector<T> &>(chunk));
+                chunk.clear();
+            }
+        } while (query.next());
+
+        query.finish();
+
+        QueryProfiler::recordRows(query.lastQuery(), rows);
+
+        if (!chunk.empty())
+            visitor(static_cast<const std::vector<T> &>(chunk));
+    }
+
     template<class T>
     void Repository<T>::insert(T &entity) const
     {
@@ -245,6 +393,7 @@ namespace Evernus
                 query.next();
 
                 entity.setId(query.value(0).template value<typename T::IdType>());
+                query.finish();
             }
         }
     }
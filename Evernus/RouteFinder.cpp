@@ -0,0 +1,233 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <queue>
+
+#include "RouteFinder.h"
+
+namespace Evernus
+{
+    const uint RouteFinder::unreachable;
+    const std::size_t RouteFinder::maxCachedTrees;
+    const uint RouteFinder::invalidIndex;
+
+    namespace
+    {
+        // rounded in game to 0.5
+        const auto highSecThreshold = 0.45;
+        // larger than any route, so avoided systems are minimized first and jumps second
+        const quint64 avoidedSystemCost = 1u << 20;
+    }
+
+    void RouteFinder::setGraph(const JumpList &jumps, const SecurityMap &security)
+    {
+        std::vector<uint> systemIds;
+        systemIds.reserve(jumps.size() * 2);
+
+        for (const auto &jump : jumps)
+        {
+            systemIds.emplace_back(jump.first);
+            systemIds.emplace_back(jump.second);
+        }
+
+        std::sort(std::begin(systemIds), std::end(systemIds));
+        systemIds.erase(std::unique(std::begin(systemIds), std::end(systemIds)), std::end(systemIds));
+
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        mSystemIds = std::move(systemIds);
+
+        // compressed adjacency lists
+        mNeighbourOffsets.assign(mSystemIds.size() + 1, 0);
+        for (const auto &jump : jumps)
+            ++mNeighbourOffsets[getIndex(jump.first) + 1];
+
+        std::partial_sum(std::begin(mNeighbourOffsets), std::end(mNeighbourOffsets), std::begin(mNeighbourOffsets));
+
+        auto next = mNeighbourOffsets;
+
+        mNeighbours.resize(jumps.size());
+        for (const auto &jump : jumps)
+            mNeighbours[next[getIndex(jump.first)]++] = getIndex(jump.second);
+
+        mHighSec.resize(mSystemIds.size());
+        for (auto i = 0u; i < mSystemIds.size(); ++i)
+        {
+            const auto it = security.find(mSystemIds[i]);
+            mHighSec[i] = it != std::end(security) && it->second >= highSecThreshold;
+        }
+
+        mTrees.clear();
+        mTreeIndex.clear();
+    }
+
+    uint RouteFinder::getDistance(uint startSystem, uint endSystem, RouteType type) const
+    {
+        if (startSystem == endSystem)
+            return 0;
+
+        return getDistances(startSystem, { endSystem }, type).front();
+    }
+
+    std::vector<uint> RouteFinder::getDistances(uint startSystem, const std::vector<uint> &endSystems, RouteType type) const
+    {
+        std::vector<uint> result(endSystems.size(), unreachable);
+
+        const auto startIndex = getIndex(startSystem);
+        if (startIndex == invalidIndex)
+            return result;
+
+        const auto tree = getTree(startIndex, type);
+        for (auto i = 0u; i < endSystems.size(); ++i)
+        {
+            const auto endIndex = getIndex(endSystems[i]);
+            if (endIndex != invalidIndex)
+                result[i] = tree->mJumps[endIndex];
+        }
+
+        return result;
+    }
+
+    std::vector<uint> RouteFinder::getRoute(uint startSystem, uint endSystem, RouteType type) const
+    {
+        std::vector<uint> route;
+
+        const auto startIndex = getIndex(startSystem);
+        const auto endIndex = getIndex(endSystem);
+
+        if (startIndex == invalidIndex || endIndex == invalidIndex)
+            return route;
+
+        const auto tree = getTree(startIndex, type);
+        if (tree->mJumps[endIndex] == unreachable)
+            return route;
+
+        route.reserve(tree->mJumps[endIndex] + 1);
+
+        for (auto current = endIndex; current != invalidIndex; current = tree->mPredecessors[current])
+            route.emplace_back(mSystemIds[current]);
+
+        std::reverse(std::begin(route), std::end(route));
+        return route;
+    }
+
+    std::size_t RouteFinder::TreeKeyHash::operator ()(const TreeKey &key) const noexcept
+    {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, key.first);
+        boost::hash_combine(seed, static_cast<int>(key.second));
+
+        return seed;
+    }
+
+    uint RouteFinder::getIndex(uint systemId) const noexcept
+    {
+        const auto it = std::lower_bound(std::begin(mSystemIds), std::end(mSystemIds), systemId);
+        return (it != std::end(mSystemIds) && *it == systemId) ? (static_cast<uint>(std::distance(std::begin(mSystemIds), it))) : (invalidIndex);
+    }
+
+    RouteFinder::TreePtr RouteFinder::getTree(uint startIndex, RouteType type) const
+    {
+        const auto key = std::make_pair(startIndex, type);
+
+        {
+            std::lock_guard<std::mutex> lock{mCacheMutex};
+
+            const auto it = mTreeIndex.find(key);
+            if (it != std::end(mTreeIndex))
+            {
+                mTrees.splice(std::begin(mTrees), mTrees, it->second);
+                return it->second->second;
+            }
+        }
+
+        // computed outside the lock - racing threads will only do redundant work
+        auto tree = std::make_shared<const PathTree>(computeTree(startIndex, type));
+
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        if (mTreeIndex.find(key) == std::end(mTreeIndex))
+        {
+            mTrees.emplace_front(key, tree);
+            mTreeIndex.emplace(key, std::begin(mTrees));
+
+            if (mTrees.size() > maxCachedTrees)
+            {
+                mTreeIndex.erase(mTrees.back().first);
+                mTrees.pop_back();
+            }
+        }
+
+        return tree;
+    }
+
+    RouteFinder::PathTree RouteFinder::computeTree(uint startIndex, RouteType type) const
+    {
+        const auto systemCount = mSystemIds.size();
+
+        PathTree tree;
+        tree.mJumps.assign(systemCount, unreachable);
+        tree.mPredecessors.assign(systemCount, invalidIndex);
+
+        const auto getCost = [=](uint index) -> quint64 {
+            switch (type) {
+            case RouteType::Safer:
+                return (mHighSec[index]) ? (1) : (avoidedSystemCost);
+            case RouteType::LessSecure:
+                return (mHighSec[index]) ? (avoidedSystemCost) : (1);
+            default:
+                return 1;
+            }
+        };
+
+        using Candidate = std::pair<quint64, uint>;
+
+        std::vector<quint64> costs(systemCount, std::numeric_limits<quint64>::max());
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+
+        costs[startIndex] = 0;
+        tree.mJumps[startIndex] = 0;
+        candidates.emplace(0, startIndex);
+
+        while (!candidates.empty())
+        {
+            const auto current = candidates.top();
+            candidates.pop();
+
+            const auto index = current.second;
+            if (current.first > costs[index])
+                continue;
+
+            for (auto i = mNeighbourOffsets[index]; i < mNeighbourOffsets[index + 1]; ++i)
+            {
+                const auto neighbour = mNeighbours[i];
+                const auto cost = current.first + getCost(neighbour);
+
+                if (cost < costs[neighbour])
+                {
+                    costs[neighbour] = cost;
+                    tree.mJumps[neighbour] = tree.mJumps[index] + 1;
+                    tree.mPredecessors[neighbour] = index;
+
+                    candidates.emplace(cost, neighbour);
+                }
+            }
+        }
+
+        return tree;
+    }
+}
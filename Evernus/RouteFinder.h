@@ -0,0 +1,89 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <memory>
+#include <limits>
+#include <vector>
+#include <mutex>
+#include <list>
+
+#include <QtGlobal>
+
+#include <boost/functional/hash.hpp>
+
+#include "RouteType.h"
+
+namespace Evernus
+{
+    // shortest paths over the whole universe jump graph
+    class RouteFinder final
+    {
+    public:
+        using JumpList = std::vector<std::pair<uint, uint>>;
+        using SecurityMap = std::unordered_map<uint, double>;
+
+        static const uint unreachable = std::numeric_limits<uint>::max();
+        static const std::size_t maxCachedTrees = 64;
+
+        RouteFinder() = default;
+        RouteFinder(const RouteFinder &) = delete;
+        RouteFinder(RouteFinder &&) = delete;
+        ~RouteFinder() = default;
+
+        void setGraph(const JumpList &jumps, const SecurityMap &security);
+
+        uint getDistance(uint startSystem, uint endSystem, RouteType type) const;
+        std::vector<uint> getDistances(uint startSystem, const std::vector<uint> &endSystems, RouteType type) const;
+        std::vector<uint> getRoute(uint startSystem, uint endSystem, RouteType type) const;
+
+        RouteFinder &operator =(const RouteFinder &) = delete;
+        RouteFinder &operator =(RouteFinder &&) = delete;
+
+    private:
+        struct PathTree
+        {
+            std::vector<uint> mJumps;
+            std::vector<uint> mPredecessors;
+        };
+
+        using TreePtr = std::shared_ptr<const PathTree>;
+        using TreeKey = std::pair<uint, RouteType>;
+        using TreeList = std::list<std::pair<TreeKey, TreePtr>>;
+
+        struct TreeKeyHash
+        {
+            std::size_t operator ()(const TreeKey &key) const noexcept;
+        };
+
+        static const uint invalidIndex = std::numeric_limits<uint>::max();
+
+        std::vector<uint> mSystemIds;
+        std::vector<uint> mNeighbourOffsets;
+        std::vector<uint> mNeighbours;
+        std::vector<bool> mHighSec;
+
+        mutable std::mutex mCacheMutex;
+        mutable TreeList mTrees;
+        mutable std::unordered_map<TreeKey, TreeList::iterator, TreeKeyHash> mTreeIndex;
+
+        uint getIndex(uint systemId) const noexcept;
+
+        TreePtr getTree(uint startIndex, RouteType type) const;
+        PathTree computeTree(uint startIndex, RouteType type) const;
+    };
+}
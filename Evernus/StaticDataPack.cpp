@@ -0,0 +1,687 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <unordered_map>
+#include <unordered_set>
+#include <type_traits>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include <QSqlDatabase>
+#include <QDateTime>
+#include <QSqlQuery>
+#include <QSettings>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QVariant>
+#include <QHash>
+
+#include <QtDebug>
+
+#include "EveDatabaseConnectionProvider.h"
+#include "UpdaterSettings.h"
+#include "DatabaseUtils.h"
+
+#include "StaticDataPack.h"
+
+namespace Evernus
+{
+    namespace
+    {
+        const char magic[4] = { 'E', 'S', 'D', 'P' };
+        const quint32 version = 2;
+
+        const auto typeSection = 0;
+        const auto marketGroupSection = 1;
+        const auto regionSection = 2;
+        const auto constellationSection = 3;
+        const auto solarSystemSection = 4;
+        const auto stationSection = 5;
+        const auto stringSection = 6;
+        const auto stringDataSection = 7;
+        const auto manufacturingSection = 8;
+        const auto materialSection = 9;
+        const auto skillSection = 10;
+        const auto blueprintSection = 11;
+
+        // string 0 is always the empty one
+        class StringTable final
+        {
+        public:
+            StringTable()
+            {
+                mEntries.emplace_back();
+            }
+
+            quint32 intern(const QString &string)
+            {
+                if (string.isEmpty())
+                    return 0;
+
+                const auto it = mIndexes.find(string);
+                if (it != std::end(mIndexes))
+                    return it.value();
+
+                const auto utf8 = string.toUtf8();
+                const auto index = static_cast<quint32>(mEntries.size());
+
+                mEntries.emplace_back();
+                mEntries.back().first = static_cast<quint32>(mData.size());
+                mEntries.back().second = static_cast<quint32>(utf8.size());
+
+                mData.append(utf8);
+                mIndexes.insert(string, index);
+
+                return index;
+            }
+
+            const std::vector<std::pair<quint32, quint32>> &getEntries() const noexcept
+            {
+                return mEntries;
+            }
+
+            const QByteArray &getData() const noexcept
+            {
+                return mData;
+            }
+
+        private:
+            QHash<QString, quint32> mIndexes;
+            std::vector<std::pair<quint32, quint32>> mEntries;
+            QByteArray mData;
+        };
+
+        struct ManufacturingGraph
+        {
+            std::vector<StaticDataPack::ManufacturingEntry> mProducts;
+            std::vector<StaticDataPack::MaterialEntry> mMaterials;
+            std::vector<quint32> mSkills;
+            std::vector<StaticDataPack::BlueprintEntry> mBlueprints;
+        };
+
+        QSqlQuery execQuery(const QSqlDatabase &db, const QString &sql)
+        {
+            QSqlQuery query{db};
+            query.prepare(sql);
+
+            DatabaseUtils::execQuery(query);
+            return query;
+        }
+
+        ManufacturingGraph readManufacturingGraph(const QSqlDatabase &db)
+        {
+            auto activityId = 1u; // fallback id at the time of writing
+
+            auto query = execQuery(db, QStringLiteral("SELECT activityID FROM ramActivities WHERE activityName = 'Manufacturing'"));
+            if (query.next())
+                activityId = query.value(0).toUInt();
+
+            std::unordered_map<quint32, std::vector<StaticDataPack::MaterialEntry>> blueprintMaterials;
+
+            query = execQuery(db, QStringLiteral("SELECT typeID, materialTypeID, quantity FROM industryActivityMaterials WHERE activityID = %1").arg(activityId));
+            while (query.next())
+            {
+                blueprintMaterials[query.value(0).toUInt()].emplace_back(StaticDataPack::MaterialEntry{
+                    query.value(1).toUInt(),
+                    query.value(2).toUInt()
+                });
+            }
+
+            std::unordered_map<quint32, std::vector<quint32>> blueprintSkills;
+
+            query = execQuery(db, QStringLiteral("SELECT typeID, skillID FROM industryActivitySkills WHERE activityID = %1").arg(activityId));
+            while (query.next())
+                blueprintSkills[query.value(0).toUInt()].emplace_back(query.value(1).toUInt());
+
+            struct Product
+            {
+                quint32 mProductId;
+                quint32 mBlueprintId;
+                quint32 mQuantity;
+                quint32 mTime;
+            };
+
+            std::vector<Product> products;
+
+            query = execQuery(db, QStringLiteral(R"(
+SELECT p.productTypeID, p.typeID, p.quantity, a.time FROM industryActivityProducts p
+    INNER JOIN industryActivity a
+        ON a.typeID = p.typeID AND a.activityID = p.activityID
+    WHERE p.activityID = %1
+)").arg(activityId));
+            while (query.next())
+            {
+                products.emplace_back(Product{
+                    query.value(0).toUInt(),
+                    query.value(1).toUInt(),
+                    query.value(2).toUInt(),
+                    query.value(3).toUInt()
+                });
+            }
+
+            std::sort(std::begin(products), std::end(products), [](const auto &a, const auto &b) {
+                return std::make_pair(a.mProductId, a.mBlueprintId) < std::make_pair(b.mProductId, b.mBlueprintId);
+            });
+
+            ManufacturingGraph graph;
+
+            for (const auto &product : products)
+                graph.mBlueprints.emplace_back(StaticDataPack::BlueprintEntry{product.mBlueprintId, product.mProductId});
+
+            // first product wins for blueprints with many
+            std::stable_sort(std::begin(graph.mBlueprints), std::end(graph.mBlueprints), [](const auto &a, const auto &b) {
+                return a.mId < b.mId;
+            });
+            graph.mBlueprints.erase(std::unique(std::begin(graph.mBlueprints), std::end(graph.mBlueprints), [](const auto &a, const auto &b) {
+                return a.mId == b.mId;
+            }), std::end(graph.mBlueprints));
+
+            for (auto product = std::begin(products); product != std::end(products);)
+            {
+                StaticDataPack::ManufacturingEntry entry{};
+                entry.mId = product->mProductId;
+                entry.mFirstMaterial = static_cast<quint32>(graph.mMaterials.size());
+                entry.mFirstSkill = static_cast<quint32>(graph.mSkills.size());
+
+                std::unordered_set<quint32> usedMaterials, usedSkills;
+
+                for (; product != std::end(products) && product->mProductId == entry.mId; ++product)
+                {
+                    // blueprints without materials or skills can't be used
+                    const auto materials = blueprintMaterials.find(product->mBlueprintId);
+                    const auto skills = blueprintSkills.find(product->mBlueprintId);
+                    if (materials == std::end(blueprintMaterials) || skills == std::end(blueprintSkills))
+                        continue;
+
+                    if (entry.mQuantity == 0)
+                    {
+                        entry.mQuantity = product->mQuantity;
+                        entry.mTime = product->mTime;
+                    }
+
+                    for (const auto &material : materials->second)
+                    {
+                        if (usedMaterials.emplace(material.mTypeId).second)
+                            graph.mMaterials.emplace_back(material);
+                    }
+
+                    for (const auto skill : skills->second)
+                    {
+                        if (usedSkills.emplace(skill).second)
+                            graph.mSkills.emplace_back(skill);
+                    }
+                }
+
+                entry.mMaterialCount = static_cast<quint32>(graph.mMaterials.size()) - entry.mFirstMaterial;
+                entry.mSkillCount = static_cast<quint32>(graph.mSkills.size()) - entry.mFirstSkill;
+
+                graph.mProducts.emplace_back(entry);
+            }
+
+            return graph;
+        }
+
+        template<class Entry>
+        void sortById(std::vector<Entry> &entries)
+        {
+            std::sort(std::begin(entries), std::end(entries), [](const auto &a, const auto &b) {
+                return a.mId < b.mId;
+            });
+        }
+
+        quint64 alignSection(quint64 offset)
+        {
+            return (offset + 7) & ~quint64{7};
+        }
+    }
+
+    void StaticDataPack::load(const QString &filePath, const QSqlDatabase &db)
+    {
+        const auto fingerprint = getFingerprint();
+
+        mFile.setFileName(filePath);
+        if (map(fingerprint))
+            return;
+
+        qDebug() << "Compiling static data pack.";
+
+        QByteArray data;
+
+        try
+        {
+            data = build(db, fingerprint);
+        }
+        catch (const std::exception &e)
+        {
+            // stay unloaded - lookups fall back to sql
+            qWarning() << "Cannot compile static data pack:" << e.what();
+            return;
+        }
+
+        if (writeFile(filePath, data))
+        {
+            if (map(fingerprint))
+                return;
+        }
+        else
+        {
+            qWarning() << "Cannot write static data pack:" << filePath;
+        }
+
+        mBuffer = data;
+        setData(reinterpret_cast<const uchar *>(mBuffer.constData()), mBuffer.size(), fingerprint);
+    }
+
+    bool StaticDataPack::isLoaded() const noexcept
+    {
+        return mTypes.mEntries != nullptr;
+    }
+
+    const StaticDataPack::TypeEntry *StaticDataPack::findType(uint typeId) const noexcept
+    {
+        return find(mTypes, typeId);
+    }
+
+    const StaticDataPack::MarketGroupEntry *StaticDataPack::findMarketGroup(uint marketGroupId) const noexcept
+    {
+        return find(mMarketGroups, marketGroupId);
+    }
+
+    const StaticDataPack::RegionEntry *StaticDataPack::findRegion(uint regionId) const noexcept
+    {
+        return find(mRegions, regionId);
+    }
+
+    const StaticDataPack::ConstellationEntry *StaticDataPack::findConstellation(uint constellationId) const noexcept
+    {
+        return find(mConstellations, constellationId);
+    }
+
+    const StaticDataPack::SolarSystemEntry *StaticDataPack::findSolarSystem(uint solarSystemId) const noexcept
+    {
+        return find(mSolarSystems, solarSystemId);
+    }
+
+    const StaticDataPack::StationEntry *StaticDataPack::findStation(quint64 stationId) const noexcept
+    {
+        // offices are offset from their stations
+        if (stationId >= 66000000 && stationId <= 66014933)
+            stationId -= 6000001;
+
+        return find(mStations, stationId);
+    }
+
+    const StaticDataPack::ManufacturingEntry *StaticDataPack::findManufacturing(uint productId) const noexcept
+    {
+        return find(mManufacturing, productId);
+    }
+
+    const StaticDataPack::BlueprintEntry *StaticDataPack::findBlueprint(uint blueprintId) const noexcept
+    {
+        return find(mBlueprints, blueprintId);
+    }
+
+    const StaticDataPack::MaterialEntry *StaticDataPack::getMaterials(const ManufacturingEntry &entry) const noexcept
+    {
+        return mMaterials.mEntries + entry.mFirstMaterial;
+    }
+
+    const quint32 *StaticDataPack::getSkills(const ManufacturingEntry &entry) const noexcept
+    {
+        return mSkills.mEntries + entry.mFirstSkill;
+    }
+
+    QString StaticDataPack::getString(quint32 index) const
+    {
+        if (index >= mStrings.mCount)
+            return QString{};
+
+        const auto &entry = mStrings.mEntries[index];
+        return QString::fromUtf8(mStringData.mEntries + entry.mOffset, static_cast<int>(entry.mSize));
+    }
+
+    QString StaticDataPack::getLocationName(quint64 id) const
+    {
+        const auto station = findStation(id);
+        if (station != nullptr)
+            return getString(station->mName);
+
+        const auto solarSystem = find(mSolarSystems, id);
+        if (solarSystem != nullptr)
+            return getString(solarSystem->mName);
+
+        const auto constellation = find(mConstellations, id);
+        if (constellation != nullptr)
+            return getString(constellation->mName);
+
+        const auto region = find(mRegions, id);
+        return (region != nullptr) ? (getString(region->mName)) : (QString{});
+    }
+
+    bool StaticDataPack::write(const QString &filePath, const QSqlDatabase &db)
+    {
+        try
+        {
+            return writeFile(filePath, build(db, getFingerprint()));
+        }
+        catch (const std::exception &e)
+        {
+            qWarning() << "Cannot compile static data pack:" << e.what();
+            return false;
+        }
+    }
+
+    bool StaticDataPack::writeFile(const QString &filePath, const QByteArray &data)
+    {
+        QSaveFile file{filePath};
+        return file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit();
+    }
+
+    bool StaticDataPack::map(quint64 fingerprint)
+    {
+        if (!mFile.open(QIODevice::ReadOnly))
+            return false;
+
+        const auto size = mFile.size();
+        const auto data = mFile.map(0, size);
+
+        if (data != nullptr && setData(data, size, fingerprint))
+            return true;
+
+        mFile.close();
+        return false;
+    }
+
+    bool StaticDataPack::setData(const uchar *data, qint64 size, quint64 fingerprint)
+    {
+        mTypes = {};
+        mMarketGroups = {};
+        mRegions = {};
+        mConstellations = {};
+        mSolarSystems = {};
+        mStations = {};
+        mStrings = {};
+        mStringData = {};
+        mManufacturing = {};
+        mMaterials = {};
+        mSkills = {};
+        mBlueprints = {};
+
+        if (size < static_cast<qint64>(sizeof(Header)))
+            return false;
+
+        Header header;
+        std::memcpy(&header, data, sizeof(header));
+
+        if (std::memcmp(header.mMagic, magic, sizeof(magic)) != 0 || header.mVersion != version || header.mFingerprint != fingerprint)
+            return false;
+
+        const auto getTable = [&](auto &table, auto index) {
+            using Entry = std::remove_const_t<std::remove_pointer_t<decltype(table.mEntries)>>;
+
+            const auto &section = header.mSections[index];
+            if (section.mOffset + static_cast<quint64>(section.mCount) * sizeof(Entry) > static_cast<quint64>(size))
+                return false;
+
+            table.mEntries = reinterpret_cast<const Entry *>(data + section.mOffset);
+            table.mCount = section.mCount;
+
+            return true;
+        };
+
+        Table<TypeEntry> types;
+        Table<MarketGroupEntry> marketGroups;
+        Table<RegionEntry> regions;
+        Table<ConstellationEntry> constellations;
+        Table<SolarSystemEntry> solarSystems;
+        Table<StationEntry> stations;
+        Table<StringEntry> strings;
+        Table<char> stringData;
+        Table<ManufacturingEntry> manufacturing;
+        Table<MaterialEntry> materials;
+        Table<quint32> skills;
+        Table<BlueprintEntry> blueprints;
+
+        if (!getTable(types, typeSection) ||
+            !getTable(marketGroups, marketGroupSection) ||
+            !getTable(regions, regionSection) ||
+            !getTable(constellations, constellationSection) ||
+            !getTable(solarSystems, solarSystemSection) ||
+            !getTable(stations, stationSection) ||
+            !getTable(strings, stringSection) ||
+            !getTable(stringData, stringDataSection) ||
+            !getTable(manufacturing, manufacturingSection) ||
+            !getTable(materials, materialSection) ||
+            !getTable(skills, skillSection) ||
+            !getTable(blueprints, blueprintSection))
+        {
+            return false;
+        }
+
+        for (auto i = 0u; i < strings.mCount; ++i)
+        {
+            const auto &entry = strings.mEntries[i];
+            if (static_cast<quint64>(entry.mOffset) + entry.mSize > stringData.mCount)
+                return false;
+        }
+
+        for (auto i = 0u; i < manufacturing.mCount; ++i)
+        {
+            const auto &entry = manufacturing.mEntries[i];
+            if (static_cast<quint64>(entry.mFirstMaterial) + entry.mMaterialCount > materials.mCount ||
+                static_cast<quint64>(entry.mFirstSkill) + entry.mSkillCount > skills.mCount)
+            {
+                return false;
+            }
+        }
+
+        mStrings = strings;
+        mStringData = stringData;
+        mMarketGroups = marketGroups;
+        mRegions = regions;
+        mConstellations = constellations;
+        mSolarSystems = solarSystems;
+        mStations = stations;
+        mManufacturing = manufacturing;
+        mMaterials = materials;
+        mSkills = skills;
+        mBlueprints = blueprints;
+        mTypes = types;
+
+        return true;
+    }
+
+    template<class Entry>
+    const Entry *StaticDataPack::find(const Table<Entry> &table, quint64 id) noexcept
+    {
+        const auto end = table.mEntries + table.mCount;
+        const auto it = std::lower_bound(table.mEntries, end, id, [](const auto &entry, auto id) {
+            return entry.mId < id;
+        });
+
+        return (it != end && it->mId == id) ? (it) : (nullptr);
+    }
+
+    QByteArray StaticDataPack::build(const QSqlDatabase &db, quint64 fingerprint)
+    {
+        StringTable strings;
+
+        std::vector<TypeEntry> types;
+
+        auto query = execQuery(db, QStringLiteral(R"(
+SELECT t.typeID, t.groupID, t.marketGroupID, t.typeName, g.metaGroupName, t.volume FROM invTypes t
+LEFT JOIN invMetaTypes m ON m.typeID = t.typeID
+LEFT JOIN invMetaGroups g ON g.metaGroupID = m.metaGroupID
+)"));
+        while (query.next())
+        {
+            types.emplace_back(TypeEntry{
+                query.value(0).toUInt(),
+                query.value(1).toUInt(),
+                query.value(2).toUInt(),
+                strings.intern(query.value(3).toString()),
+                strings.intern(query.value(4).toString()),
+                0,
+                query.value(5).toDouble()
+            });
+        }
+
+        std::vector<MarketGroupEntry> marketGroups;
+
+        query = execQuery(db, QStringLiteral("SELECT marketGroupID, parentGroupID, marketGroupName FROM invMarketGroups"));
+        while (query.next())
+        {
+            marketGroups.emplace_back(MarketGroupEntry{
+                query.value(0).toUInt(),
+                query.value(1).toUInt(),
+                strings.intern(query.value(2).toString()),
+                0
+            });
+        }
+
+        std::vector<RegionEntry> regions;
+
+        query = execQuery(db, QStringLiteral("SELECT regionID, regionName FROM mapRegions"));
+        while (query.next())
+            regions.emplace_back(RegionEntry{query.value(0).toUInt(), strings.intern(query.value(1).toString())});
+
+        std::vector<ConstellationEntry> constellations;
+
+        query = execQuery(db, QStringLiteral("SELECT constellationID, regionID, constellationName FROM mapConstellations"));
+        while (query.next())
+        {
+            constellations.emplace_back(ConstellationEntry{
+                query.value(0).toUInt(),
+                query.value(1).toUInt(),
+                strings.intern(query.value(2).toString()),
+                0
+            });
+        }
+
+        std::vector<SolarSystemEntry> solarSystems;
+
+        query = execQuery(db, QStringLiteral("SELECT solarSystemID, constellationID, regionID, solarSystemName, security FROM mapSolarSystems"));
+        while (query.next())
+        {
+            solarSystems.emplace_back(SolarSystemEntry{
+                query.value(0).toUInt(),
+                query.value(1).toUInt(),
+                query.value(2).toUInt(),
+                strings.intern(query.value(3).toString()),
+                query.value(4).toDouble()
+            });
+        }
+
+        std::vector<StationEntry> stations;
+
+        query = execQuery(db, QStringLiteral("SELECT stationID, solarSystemID, regionID, stationName FROM staStations"));
+        while (query.next())
+        {
+            stations.emplace_back(StationEntry{
+                query.value(0).toUInt(),
+                query.value(1).toUInt(),
+                query.value(2).toUInt(),
+                strings.intern(query.value(3).toString())
+            });
+        }
+
+        const auto manufacturing = readManufacturingGraph(db);
+
+        sortById(types);
+        sortById(marketGroups);
+        sortById(regions);
+        sortById(constellations);
+        sortById(solarSystems);
+        sortById(stations);
+
+        std::vector<StringEntry> stringEntries;
+        stringEntries.reserve(strings.getEntries().size());
+
+        for (const auto &entry : strings.getEntries())
+            stringEntries.emplace_back(StringEntry{entry.first, entry.second});
+
+        const auto &stringData = strings.getData();
+
+        Header header{};
+        std::memcpy(header.mMagic, magic, sizeof(magic));
+        header.mVersion = version;
+        header.mFingerprint = fingerprint;
+
+        auto offset = alignSection(sizeof(Header));
+        const auto addSection = [&](auto index, quint32 count, std::size_t entrySize) {
+            header.mSections[index].mOffset = offset;
+            header.mSections[index].mCount = count;
+
+            offset = alignSection(offset + count * entrySize);
+        };
+
+        addSection(typeSection, static_cast<quint32>(types.size()), sizeof(TypeEntry));
+        addSection(marketGroupSection, static_cast<quint32>(marketGroups.size()), sizeof(MarketGroupEntry));
+        addSection(regionSection, static_cast<quint32>(regions.size()), sizeof(RegionEntry));
+        addSection(constellationSection, static_cast<quint32>(constellations.size()), sizeof(ConstellationEntry));
+        addSection(solarSystemSection, static_cast<quint32>(solarSystems.size()), sizeof(SolarSystemEntry));
+        addSection(stationSection, static_cast<quint32>(stations.size()), sizeof(StationEntry));
+        addSection(stringSection, static_cast<quint32>(stringEntries.size()), sizeof(StringEntry));
+        addSection(stringDataSection, static_cast<quint32>(stringData.size()), 1);
+        addSection(manufacturingSection, static_cast<quint32>(manufacturing.mProducts.size()), sizeof(ManufacturingEntry));
+        addSection(materialSection, static_cast<quint32>(manufacturing.mMaterials.size()), sizeof(MaterialEntry));
+        addSection(skillSection, static_cast<quint32>(manufacturing.mSkills.size()), sizeof(quint32));
+        addSection(blueprintSection, static_cast<quint32>(manufacturing.mBlueprints.size()), sizeof(BlueprintEntry));
+
+        QByteArray result{static_cast<int>(offset), '\0'};
+        const auto out = reinterpret_cast<uchar *>(result.data());
+
+        std::memcpy(out, &header, sizeof(header));
+
+        const auto writeSection = [&](auto index, const void *entries, std::size_t size) {
+            if (size > 0)
+                std::memcpy(out + header.mSections[index].mOffset, entries, size);
+        };
+
+        writeSection(typeSection, types.data(), types.size() * sizeof(TypeEntry));
+        writeSection(marketGroupSection, marketGroups.data(), marketGroups.size() * sizeof(MarketGroupEntry));
+        writeSection(regionSection, regions.data(), regions.size() * sizeof(RegionEntry));
+        writeSection(constellationSection, constellations.data(), constellations.size() * sizeof(ConstellationEntry));
+        writeSection(solarSystemSection, solarSystems.data(), solarSystems.size() * sizeof(SolarSystemEntry));
+        writeSection(stationSection, stations.data(), stations.size() * sizeof(StationEntry));
+        writeSection(stringSection, stringEntries.data(), stringEntries.size() * sizeof(StringEntry));
+        writeSection(stringDataSection, stringData.constData(), static_cast<std::size_t>(stringData.size()));
+        writeSection(manufacturingSection, manufacturing.mProducts.data(), manufacturing.mProducts.size() * sizeof(ManufacturingEntry));
+        writeSection(materialSection, manufacturing.mMaterials.data(), manufacturing.mMaterials.size() * sizeof(MaterialEntry));
+        writeSection(skillSection, manufacturing.mSkills.data(), manufacturing.mSkills.size() * sizeof(quint32));
+        writeSection(blueprintSection, manufacturing.mBlueprints.data(), manufacturing.mBlueprints.size() * sizeof(BlueprintEntry));
+
+        qDebug() << "Static data pack:" << types.size() << "types," << stations.size() << "stations," << manufacturing.mProducts.size() << "products," << stringEntries.size() << "strings.";
+
+        return result;
+    }
+
+    quint64 StaticDataPack::getFingerprint()
+    {
+        // changes whenever a different SDE gets installed
+        QSettings settings;
+        const QFileInfo dbInfo{EveDatabaseConnectionProvider::getDatabasePath()};
+
+        std::size_t seed = 0;
+        boost::hash_combine(seed, settings.value(UpdaterSettings::sdeVersionKey).toString().toStdString());
+        boost::hash_combine(seed, dbInfo.size());
+        boost::hash_combine(seed, dbInfo.lastModified().toMSecsSinceEpoch());
+
+        return seed;
+    }
+}
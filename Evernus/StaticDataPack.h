@@ -0,0 +1,198 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+
+class QSqlDatabase;
+
+namespace Evernus
+{
+    // static data compiled from the SDE into flat sorted tables, kept in a memory-mapped cache file
+    class StaticDataPack final
+    {
+    public:
+        struct TypeEntry
+        {
+            quint32 mId;
+            quint32 mGroupId;
+            // 0 - no market group
+            quint32 mMarketGroupId;
+            quint32 mName;
+            quint32 mMetaGroupName;
+            quint32 mReserved;
+            double mVolume;
+        };
+
+        struct MarketGroupEntry
+        {
+            quint32 mId;
+            // 0 - top level group
+            quint32 mParentId;
+            quint32 mName;
+            quint32 mReserved;
+        };
+
+        struct RegionEntry
+        {
+            quint32 mId;
+            quint32 mName;
+        };
+
+        struct ConstellationEntry
+        {
+            quint32 mId;
+            quint32 mRegionId;
+            quint32 mName;
+            quint32 mReserved;
+        };
+
+        struct SolarSystemEntry
+        {
+            quint32 mId;
+            quint32 mConstellationId;
+            quint32 mRegionId;
+            quint32 mName;
+            double mSecurity;
+        };
+
+        struct StationEntry
+        {
+            quint32 mId;
+            quint32 mSolarSystemId;
+            quint32 mRegionId;
+            quint32 mName;
+        };
+
+        // keyed by product type
+        struct ManufacturingEntry
+        {
+            quint32 mId;
+            quint32 mQuantity;
+            quint32 mTime;
+            quint32 mFirstMaterial;
+            quint32 mMaterialCount;
+            quint32 mFirstSkill;
+            quint32 mSkillCount;
+            quint32 mReserved;
+        };
+
+        struct MaterialEntry
+        {
+            quint32 mTypeId;
+            quint32 mQuantity;
+        };
+
+        struct BlueprintEntry
+        {
+            quint32 mId;
+            quint32 mProductId;
+        };
+
+        StaticDataPack() = default;
+        StaticDataPack(const StaticDataPack &) = delete;
+        StaticDataPack(StaticDataPack &&) = delete;
+        ~StaticDataPack() = default;
+
+        // maps the cache file if it was built from the installed SDE, otherwise compiles it from db and rewrites it
+        void load(const QString &filePath, const QSqlDatabase &db);
+        bool isLoaded() const noexcept;
+
+        // all return nullptr for unknown ids or when nothing is loaded
+        const TypeEntry *findType(uint typeId) const noexcept;
+        const MarketGroupEntry *findMarketGroup(uint marketGroupId) const noexcept;
+        const RegionEntry *findRegion(uint regionId) const noexcept;
+        const ConstellationEntry *findConstellation(uint constellationId) const noexcept;
+        const SolarSystemEntry *findSolarSystem(uint solarSystemId) const noexcept;
+        // also resolves office ids
+        const StationEntry *findStation(quint64 stationId) const noexcept;
+        const ManufacturingEntry *findManufacturing(uint productId) const noexcept;
+        const BlueprintEntry *findBlueprint(uint blueprintId) const noexcept;
+
+        // ranges described by given entry
+        const MaterialEntry *getMaterials(const ManufacturingEntry &entry) const noexcept;
+        const quint32 *getSkills(const ManufacturingEntry &entry) const noexcept;
+
+        QString getString(quint32 index) const;
+        // name of a packed station, solar system, constellation or region; empty if unknown
+        QString getLocationName(quint64 id) const;
+
+        StaticDataPack &operator =(const StaticDataPack &) = delete;
+        StaticDataPack &operator =(StaticDataPack &&) = delete;
+
+        // compiles the installed SDE into given file, e.g. after an update
+        static bool write(const QString &filePath, const QSqlDatabase &db);
+
+    private:
+        static const auto sectionCount = 12;
+
+        struct Section
+        {
+            quint64 mOffset;
+            quint32 mCount;
+            quint32 mReserved;
+        };
+
+        struct Header
+        {
+            char mMagic[4];
+            quint32 mVersion;
+            quint64 mFingerprint;
+            Section mSections[sectionCount];
+        };
+
+        struct StringEntry
+        {
+            quint32 mOffset;
+            quint32 mSize;
+        };
+
+        template<class Entry>
+        struct Table
+        {
+            const Entry *mEntries = nullptr;
+            quint32 mCount = 0;
+        };
+
+        QFile mFile;
+        QByteArray mBuffer;
+
+        Table<TypeEntry> mTypes;
+        Table<MarketGroupEntry> mMarketGroups;
+        Table<RegionEntry> mRegions;
+        Table<ConstellationEntry> mConstellations;
+        Table<SolarSystemEntry> mSolarSystems;
+        Table<StationEntry> mStations;
+        Table<StringEntry> mStrings;
+        Table<char> mStringData;
+        Table<ManufacturingEntry> mManufacturing;
+        Table<MaterialEntry> mMaterials;
+        Table<quint32> mSkills;
+        Table<BlueprintEntry> mBlueprints;
+
+        bool map(quint64 fingerprint);
+        bool setData(const uchar *data, qint64 size, quint64 fingerprint);
+
+        template<class Entry>
+        static const Entry *find(const Table<Entry> &table, quint64 id) noexcept;
+
+        // throws when any query fails
+        static QByteArray build(const QSqlDatabase &db, quint64 fingerprint);
+        static bool writeFile(const QString &filePath, const QByteArray &data);
+        static quint64 getFingerprint();
+    };
+}
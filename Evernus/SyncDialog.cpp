@@ -18,6 +18,7 @@
 #include <QJsonDocument>
 #include <QApplication>
 #include <QProgressBar>
+#include <QSqlDatabase>
 #include <QJsonObject>
 #include <QMessageBox>
 #include <QVBoxLayout>
@@ -37,6 +38,7 @@
 #include <QFont>
 #include <QUrl>
 
+#include "MainDatabaseConnectionProvider.h"
 #include "DatabaseUtils.h"
 #include "SyncSettings.h"
 #include "ReplyTimeout.h"
@@ -461,6 +463,8 @@ namespace Evernus
             return;
         }
 
+        DatabaseUtils::checkpointDatabase(MainDatabaseConnectionProvider{}.getConnection());
+
         QFile localMainDb{getMainDbPath()};
         if (!localMainDb.open(QIODevice::ReadOnly))
         {
@@ -152,6 +152,7 @@ namespace Evernus
         mData.clear();
 
         QSqlQuery query{mCharacterRepository.getDatabase()};
+        query.setForwardOnly(true);
 
         if (combineCharacters && combineCorp)
         {
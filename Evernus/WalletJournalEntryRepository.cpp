@@ -115,7 +115,11 @@ namespace Evernus
         DatabaseUtils::execQuery(query);
 
         query.next();
-        return query.value(0).value<WalletJournalEntry::IdType>();
+
+        const auto id = query.value(0).value<WalletJournalEntry::IdType>();
+        query.finish();
+
+        return id;
     }
 
     void WalletJournalEntryRepository::setIgnored(WalletJournalEntry::IdType id, bool ignored) const
@@ -15,10 +15,57 @@
 #include <QSqlRecord>
 #include <QSqlQuery>
 
+#include "ColumnSet.h"
+
 #include "WalletTransactionRepository.h"
 
 namespace Evernus
 {
+    namespace
+    {
+        const auto columns = makeColumnSet<WalletTransaction>(
+            makeIdColumn<WalletTransaction>("id"),
+            makeColumn("character_id",
+                       [](const WalletTransaction &transaction) { return transaction.getCharacterId(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setCharacterId(value.value<Character::IdType>()); }),
+            makeColumn("timestamp",
+                       [](const WalletTransaction &transaction) { return transaction.getTimestamp(); },
+                       [](WalletTransaction &transaction, const QVariant &value) {
+                           auto timestamp = value.toDateTime();
+                           timestamp.setTimeSpec(Qt::UTC);
+
+                           transaction.setTimestamp(timestamp);
+                       }),
+            makeColumn("quantity",
+                       [](const WalletTransaction &transaction) { return transaction.getQuantity(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setQuantity(value.toUInt()); }),
+            makeColumn("type_id",
+                       [](const WalletTransaction &transaction) { return transaction.getTypeId(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setTypeId(value.value<EveType::IdType>()); }),
+            makeColumn("price",
+                       [](const WalletTransaction &transaction) { return transaction.getPrice(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setPrice(value.toDouble()); }),
+            makeColumn("client_id",
+                       [](const WalletTransaction &transaction) { return transaction.getClientId(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setClientId(value.toULongLong()); }),
+            makeColumn("location_id",
+                       [](const WalletTransaction &transaction) { return transaction.getLocationId(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setLocationId(value.toULongLong()); }),
+            makeColumn("type",
+                       [](const WalletTransaction &transaction) { return static_cast<int>(transaction.getType()); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setType(static_cast<WalletTransaction::Type>(value.toInt())); }),
+            makeColumn("journal_id",
+                       [](const WalletTransaction &transaction) { return transaction.getJournalId(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setJournalId(value.value<WalletJournalEntry::IdType>()); }),
+            makeColumn("corporation_id",
+                       [](const WalletTransaction &transaction) { return transaction.getCorporationId(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setCorporationId(value.toULongLong()); }),
+            makeColumn("ignored",
+                       [](const WalletTransaction &transaction) { return transaction.isIgnored(); },
+                       [](WalletTransaction &transaction, const QVariant &value) { transaction.setIgnored(value.toBool()); })
+        );
+    }
+
     WalletTransactionRepository::WalletTransactionRepository(bool corp, const DatabaseConnectionProvider &connectionProvider)
         : Repository{connectionProvider}
         , mCorp{corp}
@@ -37,21 +84,8 @@ namespace Evernus
 
     WalletTransactionRepository::EntityPtr WalletTransactionRepository::populate(const QSqlRecord &record) const
     {
-        auto timestamp = record.value(QStringLiteral("timestamp")).toDateTime();
-        timestamp.setTimeSpec(Qt::UTC);
-
-        auto walletTransaction = std::make_shared<WalletTransaction>(record.value(QStringLiteral("id")).value<WalletTransaction::IdType>());
-        walletTransaction->setCharacterId(record.value(QStringLiteral("character_id")).value<Character::IdType>());
-        walletTransaction->setTimestamp(timestamp);
-        walletTransaction->setQuantity(record.value(QStringLiteral("quantity")).toUInt());
-        walletTransaction->setTypeId(record.value(QStringLiteral("type_id")).value<EveType::IdType>());
-        walletTransaction->setPrice(record.value(QStringLiteral("price")).toDouble());
-        walletTransaction->setClientId(record.value(QStringLiteral("client_id")).toULongLong());
-        walletTransaction->setLocationId(record.value(QStringLiteral("location_id")).toULongLong());
-        walletTransaction->setType(static_cast<WalletTransaction::Type>(record.value(QStringLiteral("type")).toInt()));
-        walletTransaction->setJournalId(record.value(QStringLiteral("journal_id")).value<WalletJournalEntry::IdType>());
-        walletTransaction->setCorporationId(record.value(QStringLiteral("corporation_id")).toULongLong());
-        walletTransaction->setIgnored(record.value(QStringLiteral("ignored")).toBool());
+        auto walletTransaction = std::make_shared<WalletTransaction>();
+        columns.decode(record, columns.resolveOrdinals(record), *walletTransaction);
         walletTransaction->setNew(false);
 
         return walletTransaction;
@@ -105,7 +139,11 @@ namespace Evernus
         DatabaseUtils::execQuery(query);
 
         query.next();
-        return query.value(0).value<WalletTransaction::IdType>();
+
+        const auto id = query.value(0).value<WalletTransaction::IdType>();
+        query.finish();
+
+        return id;
     }
 
     void WalletTransactionRepository::setIgnored(WalletTransaction::IdType id, bool ignored) const
@@ -136,37 +174,10 @@ namespace Evernus
                    EntryType type,
                    EveType::IdType typeId) const
     {
-        QString queryStr;
-        if (type == EntryType::All)
-            queryStr = "SELECT * FROM %1 WHERE timestamp BETWEEN ? AND ?";
-        else
-            queryStr = "SELECT * FROM %1 WHERE timestamp BETWEEN ? AND ? AND type = ?";
-
-        if (typeId != EveType::invalidId)
-            queryStr += " AND type_id = ?";
-
-        auto query = prepare(queryStr.arg(getTableName()));
-        query.addBindValue(from);
-        query.addBindValue(till);
-
-        if (type != EntryType::All)
-            query.addBindValue(static_cast<int>((type == EntryType::Buy) ? (WalletTransaction::Type::Buy) : (WalletTransaction::Type::Sell)));
-
-        if (typeId != EveType::invalidId)
-            query.addBindValue(typeId);
-
+        auto query = prepareInRange(from, till, type, typeId);
         DatabaseUtils::execQuery(query);
 
-        const auto size = query.size();
-
-        EntityList result;
-        if (size > 0)
-            result.reserve(size);
-
-        while (query.next())
-            result.emplace_back(populate(query.record()));
-
-        return result;
+        return populateAll(query);
     }
 
     WalletTransactionRepository::EntityList WalletTransactionRepository
@@ -189,6 +200,38 @@ namespace Evernus
         return fetchForColumnInRange(corporationId, from, till, type, typeId, QStringLiteral("corporation_id"));
     }
 
+    void WalletTransactionRepository::forEachInRange(const QDateTime &from,
+                                                     const QDateTime &till,
+                                                     EntryType type,
+                                                     const Visitor &visitor,
+                                                     EveType::IdType typeId) const
+    {
+        auto query = prepareInRange(from, till, type, typeId);
+        streamRows(query, visitor);
+    }
+
+    void WalletTransactionRepository::forEachForCharacterInRange(Character::IdType characterId,
+                                                                 const QDateTime &from,
+                                                                 const QDateTime &till,
+                                                                 EntryType type,
+                                                                 const Visitor &visitor,
+                                                                 EveType::IdType typeId) const
+    {
+        auto query = prepareForColumnInRange(characterId, from, till, type, typeId, QStringLiteral("character_id"));
+        streamRows(query, visitor);
+    }
+
+    void WalletTransactionRepository::forEachForCorporationInRange(quint64 corporationId,
+                                                                   const QDateTime &from,
+                                                                   const QDateTime &till,
+                                                                   EntryType type,
+                                                                   const Visitor &visitor,
+                                                                   EveType::IdType typeId) const
+    {
+        auto query = prepareForColumnInRange(corporationId, from, till, type, typeId, QStringLiteral("corporation_id"));
+        streamRows(query, visitor);
+    }
+
     WalletTransactionRepository::EntityList WalletTransactionRepository::fetchForTypeId(EveType::IdType typeId) const
     {
         auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type_id = ?").arg(getTableName()));
@@ -196,16 +239,7 @@ namespace Evernus
 
         DatabaseUtils::execQuery(query);
 
-        const auto size = query.size();
-
-        EntityList result;
-        if (size > 0)
-            result.reserve(size);
-
-        while (query.next())
-            result.emplace_back(populate(query.record()));
-
-        return result;
+        return populateAll(query);
     }
 
     WalletTransactionRepository::EntityList WalletTransactionRepository
@@ -217,70 +251,68 @@ namespace Evernus
 
         DatabaseUtils::execQuery(query);
 
-        const auto size = query.size();
+        return populateAll(query);
+    }
 
-        EntityList result;
-        if (size > 0)
-            result.reserve(size);
+    WalletTransactionRepository::ColumnOrdinals WalletTransactionRepository::resolveOrdinals(const QSqlRecord &record) const
+    {
+        return columns.resolveOrdinals(record);
+    }
 
-        while (query.next())
-            result.emplace_back(populate(query.record()));
+    WalletTransactionRepository::EntityPtr WalletTransactionRepository::populateRow(const QSqlQuery &query, const ColumnOrdinals &ordinals) const
+    {
+        auto walletTransaction = std::make_shared<WalletTransaction>();
+        decodeRow(query, ordinals, *walletTransaction);
+
+        return walletTransaction;
+    }
 
-        return result;
+    void WalletTransactionRepository::decodeRow(const QSqlQuery &query, const ColumnOrdinals &ordinals, WalletTransaction &entity) const
+    {
+        columns.decode(query, ordinals, entity);
+        entity.setNew(false);
     }
 
     QStringList WalletTransactionRepository::getColumns() const
     {
-        return {
-            QStringLiteral("id"),
-            QStringLiteral("character_id"),
-            QStringLiteral("timestamp"),
-            QStringLiteral("quantity"),
-            QStringLiteral("type_id"),
-            QStringLiteral("price"),
-            QStringLiteral("client_id"),
-            QStringLiteral("location_id"),
-            QStringLiteral("type"),
-            QStringLiteral("journal_id"),
-            QStringLiteral("corporation_id"),
-            QStringLiteral("ignored"),
-        };
+        return columns.getNames();
     }
 
     void WalletTransactionRepository::bindValues(const WalletTransaction &entity, QSqlQuery &query) const
     {
-        if (entity.getId() != WalletTransaction::invalidId)
-            query.bindValue(":id", entity.getId());
-
-        query.bindValue(QStringLiteral(":character_id"), entity.getCharacterId());
-        query.bindValue(QStringLiteral(":timestamp"), entity.getTimestamp());
-        query.bindValue(QStringLiteral(":quantity"), entity.getQuantity());
-        query.bindValue(QStringLiteral(":type_id"), entity.getTypeId());
-        query.bindValue(QStringLiteral(":price"), entity.getPrice());
-        query.bindValue(QStringLiteral(":client_id"), entity.getClientId());
-        query.bindValue(QStringLiteral(":location_id"), entity.getLocationId());
-        query.bindValue(QStringLiteral(":type"), static_cast<int>(entity.getType()));
-        query.bindValue(QStringLiteral(":journal_id"), entity.getJournalId());
-        query.bindValue(QStringLiteral(":corporation_id"), entity.getCorporationId());
-        query.bindValue(QStringLiteral(":ignored"), entity.isIgnored());
+        columns.bindValues(entity, query);
     }
 
     void WalletTransactionRepository::bindPositionalValues(const WalletTransaction &entity, QSqlQuery &query) const
     {
-        if (entity.getId() != WalletTransaction::invalidId)
-            query.addBindValue(entity.getId());
-
-        query.addBindValue(entity.getCharacterId());
-        query.addBindValue(entity.getTimestamp());
-        query.addBindValue(entity.getQuantity());
-        query.addBindValue(entity.getTypeId());
-        query.addBindValue(entity.getPrice());
-        query.addBindValue(entity.getClientId());
-        query.addBindValue(entity.getLocationId());
-        query.addBindValue(static_cast<int>(entity.getType()));
-        query.addBindValue(entity.getJournalId());
-        query.addBindValue(entity.getCorporationId());
-        query.addBindValue(entity.isIgnored());
+        columns.bindPositionalValues(entity, query);
+    }
+
+    PreparedStatementCache::Query WalletTransactionRepository::prepareInRange(const QDateTime &from,
+                                                                              const QDateTime &till,
+                                                                              EntryType type,
+                                                                              EveType::IdType typeId) const
+    {
+        QString queryStr;
+        if (type == EntryType::All)
+            queryStr = "SELECT * FROM %1 WHERE timestamp BETWEEN ? AND ?";
+        else
+            queryStr = "SELECT * FROM %1 WHERE timestamp BETWEEN ? AND ? AND type = ?";
+
+        if (typeId != EveType::invalidId)
+            queryStr += " AND type_id = ?";
+
+        auto query = prepare(queryStr.arg(getTableName()));
+        query.addBindValue(from);
+        query.addBindValue(till);
+
+        if (type != EntryType::All)
+            query.addBindValue(static_cast<int>((type == EntryType::Buy) ? (WalletTransaction::Type::Buy) : (WalletTransaction::Type::Sell)));
+
+        if (typeId != EveType::invalidId)
+            query.addBindValue(typeId);
+
+        return query;
     }
 
     template<class T>
@@ -290,6 +322,20 @@ namespace Evernus
                                                                                                EntryType type,
                                                                                                EveType::IdType typeId,
                                                                                                const QString &column) const
+    {
+        auto query = prepareForColumnInRange(id, from, till, type, typeId, column);
+        DatabaseUtils::execQuery(query);
+
+        return populateAll(query);
+    }
+
+    template<class T>
+    PreparedStatementCache::Query WalletTransactionRepository::prepareForColumnInRange(T id,
+                                                                                       const QDateTime &from,
+                                                                                       const QDateTime &till,
+                                                                                       EntryType type,
+                                                                                       EveType::IdType typeId,
+                                                                                       const QString &column) const
     {
         QString queryStr;
         if (type == EntryType::All)
@@ -311,17 +357,6 @@ namespace Evernus
         if (typeId != EveType::invalidId)
             query.addBindValue(typeId);
 
-        DatabaseUtils::execQuery(query);
-
-        const auto size = query.size();
-
-        EntityList result;
-        if (size > 0)
-            result.reserve(size);
-
-        while (query.next())
-            result.emplace_back(populate(query.record()));
-
-        return result;
+        return query;
     }
 }
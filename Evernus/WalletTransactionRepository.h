@@ -14,6 +14,8 @@
  */
 #pragma once
 
+#include <functional>
+
 #include "WalletTransaction.h"
 #include "Repository.h"
 
@@ -30,6 +32,8 @@ namespace Evernus
             Sell
         };
 
+        using Visitor = std::function<void (const WalletTransaction &)>;
+
         WalletTransactionRepository(bool corp, const DatabaseConnectionProvider &connectionProvider);
         virtual ~WalletTransactionRepository() = default;
 
@@ -62,9 +66,33 @@ namespace Evernus
                                               EntryType type,
                                               EveType::IdType typeId = EveType::invalidId) const;
 
+        void forEachInRange(const QDateTime &from,
+                            const QDateTime &till,
+                            EntryType type,
+                            const Visitor &visitor,
+                            EveType::IdType typeId = EveType::invalidId) const;
+
+        void forEachForCharacterInRange(Character::IdType characterId,
+                                        const QDateTime &from,
+                                        const QDateTime &till,
+                                        EntryType type,
+                                        const Visitor &visitor,
+                                        EveType::IdType typeId = EveType::invalidId) const;
+        void forEachForCorporationInRange(quint64 corporationId,
+                                          const QDateTime &from,
+                                          const QDateTime &till,
+                                          EntryType type,
+                                          const Visitor &visitor,
+                                          EveType::IdType typeId = EveType::invalidId) const;
+
         EntityList fetchForTypeId(EveType::IdType typeId) const;
         EntityList fetchForTypeIdAndCharacter(EveType::IdType typeId, Character::IdType characterId) const;
 
+    protected:
+        virtual ColumnOrdinals resolveOrdinals(const QSqlRecord &record) const override;
+        virtual EntityPtr populateRow(const QSqlQuery &query, const ColumnOrdinals &ordinals) const override;
+        virtual void decodeRow(const QSqlQuery &query, const ColumnOrdinals &ordinals, WalletTransaction &entity) const override;
+
     private:
         bool mCorp = false;
 
@@ -72,6 +100,11 @@ namespace Evernus
         virtual void bindValues(const WalletTransaction &entity, QSqlQuery &query) const override;
         virtual void bindPositionalValues(const WalletTransaction &entity, QSqlQuery &query) const override;
 
+        PreparedStatementCache::Query prepareInRange(const QDateTime &from,
+                                                     const QDateTime &till,
+                                                     EntryType type,
+                                                     EveType::IdType typeId) const;
+
         template<class T>
         EntityList fetchForColumnInRange(T id,
                                          const QDateTime &from,
@@ -79,5 +112,12 @@ namespace Evernus
                                          EntryType type,
                                          EveType::IdType typeId,
                                          const QString &column) const;
+        template<class T>
+        PreparedStatementCache::Query prepareForColumnInRange(T id,
+                                                              const QDateTime &from,
+                                                              const QDateTime &till,
+                                                              EntryType type,
+                                                              EveType::IdType typeId,
+                                                              const QString &column) const;
     };
 }
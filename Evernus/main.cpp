@@ -21,6 +21,7 @@
 #include <QCommandLineParser>
 #include <QDesktopServices>
 #include <QStandardPaths>
+#include <QHostAddress>
 #include <QApplication>
 #include <QStyleFactory>
 #include <QLocalSocket>
@@ -49,10 +50,12 @@
 #include "MarketAnalysisDataFetcher.h"
 #include "ContractFilterProxyModel.h"
 #include "ChainableFileLogger.h"
+#include "ESIInterfaceManager.h"
 #include "ExternalOrderModel.h"
 #include "EvernusApplication.h"
 #include "CommandLineOptions.h"
 #include "EveDatabaseUpdater.h"
+#include "ESIReplayService.h"
 #include "UpdaterSettings.h"
 #include "ImportSettings.h"
 #include "BezierCurve.h"
@@ -62,6 +65,9 @@
 #include "Version.h"
 #include "Defines.h"
 #include "Citadel.h"
+#include "ESIUrls.h"
+
+#include "qxthttpsessionmanager.h"
 
 #if EVERNUS_CREATE_DUMPS
 #   include <iostream>
@@ -198,6 +204,15 @@ int main(int argc, char *argv[])
             { Evernus::CommandLineOptions::maxLogFileSizeArg, QCoreApplication::translate("main", "Max. log file size"), QStringLiteral("size"), QStringLiteral("%1").arg(10 * 1014 * 1024) },
             { Evernus::CommandLineOptions::maxLogFilesArg, QCoreApplication::translate("main", "Max. log files"), QStringLiteral("n"), QStringLiteral("3") },
             { Evernus::CommandLineOptions::forceSDEUpdateArg, QCoreApplication::translate("main", "Force Eve database update") },
+            { Evernus::CommandLineOptions::esiUrlArg, QCoreApplication::translate("main", "ESI base url"), QStringLiteral("url") },
+            { Evernus::CommandLineOptions::esiRecordArg, QCoreApplication::translate("main", "Record public ESI replies as fixtures"), QStringLiteral("dir") },
+            { Evernus::CommandLineOptions::esiReplayArg, QCoreApplication::translate("main", "Serve ESI from recorded fixtures on a local server"), QStringLiteral("dir") },
+            { Evernus::CommandLineOptions::esiReplayPortArg, QCoreApplication::translate("main", "ESI replay server port"), QStringLiteral("port"), QStringLiteral("8471") },
+            { Evernus::CommandLineOptions::esiReplayLatencyArg, QCoreApplication::translate("main", "ESI replay latency"), QStringLiteral("ms"), QStringLiteral("0") },
+            { Evernus::CommandLineOptions::esiReplayMaxPagesArg, QCoreApplication::translate("main", "Max. pages served by ESI replay"), QStringLiteral("n"), QStringLiteral("0") },
+            { Evernus::CommandLineOptions::esiReplayServerErrorRateArg, QCoreApplication::translate("main", "Fraction of ESI replay requests failing with 5xx"), QStringLiteral("rate"), QStringLiteral("0") },
+            { Evernus::CommandLineOptions::esiReplayErrorLimitRateArg, QCoreApplication::translate("main", "Fraction of ESI replay requests failing with 420"), QStringLiteral("rate"), QStringLiteral("0") },
+            { Evernus::CommandLineOptions::esiReplayErrorLimitArg, QCoreApplication::translate("main", "ESI replay error limit"), QStringLiteral("n"), QStringLiteral("100") },
         });
 
         // NOTE: don't use process here or it will exit on additional args in OSX
@@ -208,6 +223,12 @@ int main(int argc, char *argv[])
         if (parser.isSet(QStringLiteral("help")))
             parser.showHelp();
 
+        const auto esiReplayPort = parser.value(Evernus::CommandLineOptions::esiReplayPortArg).toUShort();
+        if (parser.isSet(Evernus::CommandLineOptions::esiReplayArg))
+            Evernus::ESIUrls::setESIUrl(QStringLiteral("http://127.0.0.1:%1").arg(esiReplayPort));
+        else if (parser.isSet(Evernus::CommandLineOptions::esiUrlArg))
+            Evernus::ESIUrls::setESIUrl(parser.value(Evernus::CommandLineOptions::esiUrlArg));
+
         Evernus::ChainableFileLogger::initialize(parser.value(Evernus::CommandLineOptions::maxLogFileSizeArg).toULongLong(),
                                                  parser.value(Evernus::CommandLineOptions::maxLogFilesArg).toUInt());
 
@@ -302,6 +323,33 @@ int main(int argc, char *argv[])
                                         parser.value(Evernus::CommandLineOptions::forceVersionArg),
                                         parser.isSet(Evernus::CommandLineOptions::noUpdateArg)};
 
+        if (parser.isSet(Evernus::CommandLineOptions::esiRecordArg))
+            app.getESIInterfaceManager().recordFixtures(parser.value(Evernus::CommandLineOptions::esiRecordArg));
+
+        QxtHttpSessionManager esiReplaySessionManager;
+        if (parser.isSet(Evernus::CommandLineOptions::esiReplayArg))
+        {
+            Evernus::ESIReplayService::Options options;
+            options.mLatency = std::chrono::milliseconds{parser.value(Evernus::CommandLineOptions::esiReplayLatencyArg).toInt()};
+            options.mMaxPages = parser.value(Evernus::CommandLineOptions::esiReplayMaxPagesArg).toUInt();
+            options.mServerErrorRate = parser.value(Evernus::CommandLineOptions::esiReplayServerErrorRateArg).toDouble();
+            options.mErrorLimitRate = parser.value(Evernus::CommandLineOptions::esiReplayErrorLimitRateArg).toDouble();
+            options.mErrorLimit = parser.value(Evernus::CommandLineOptions::esiReplayErrorLimitArg).toUInt();
+
+            const auto replayService = new Evernus::ESIReplayService{parser.value(Evernus::CommandLineOptions::esiReplayArg),
+                                                                     options,
+                                                                     &esiReplaySessionManager,
+                                                                     &esiReplaySessionManager};
+
+            esiReplaySessionManager.setListenInterface(QHostAddress::LocalHost);
+            esiReplaySessionManager.setPort(esiReplayPort);
+            esiReplaySessionManager.setStaticContentService(replayService);
+            esiReplaySessionManager.setConnector(QxtHttpSessionManager::HttpServer);
+
+            if (!esiReplaySessionManager.start())
+                qCritical() << "Cannot start ESI replay server on port" << esiReplayPort;
+        }
+
 #if EVERNUS_CREATE_DUMPS
         // hopefully we'll reach this point
         Evernus::DumpUploader uploader{dumpPath};
@@ -468,6 +516,8 @@ int main(int argc, char *argv[])
                              &mainWnd, &Evernus::MainWindow::externalOrdersChanged);
             QObject::connect(&app, &Evernus::EvernusApplication::externalOrdersChangedWithMarketOrders,
                              &mainWnd, &Evernus::MainWindow::externalOrdersChangedWithMarketOrders);
+            QObject::connect(&app, &Evernus::EvernusApplication::externalOrdersChangedForTypes,
+                             &mainWnd, &Evernus::MainWindow::externalOrdersChangedForTypes);
             QObject::connect(&app, &Evernus::EvernusApplication::characterWalletJournalChanged,
                              &mainWnd, &Evernus::MainWindow::characterWalletJournalChanged);
             QObject::connect(&app, &Evernus::EvernusApplication::characterWalletTransactionsChanged,
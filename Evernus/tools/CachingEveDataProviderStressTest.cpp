@@ -0,0 +1,408 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QtDebug>
+#include <QFile>
+
+#include "DatabaseConnectionProvider.h"
+#include "CachingEveDataProvider.h"
+#include "EveDataManagerProvider.h"
+#include "MarketOrderRepository.h"
+#include "DatabaseUtils.h"
+
+// hammers the lazily filled CachingEveDataProvider caches from many threads at once
+// run it under ThreadSanitizer to catch unguarded ones
+
+namespace Evernus
+{
+    namespace
+    {
+        const uint regionCount = 5;
+        const uint constellationsPerRegion = 10;
+        const uint systemsPerConstellation = 10;
+        const uint stationsPerSystem = 2;
+        const uint systemsPerRegion = constellationsPerRegion * systemsPerConstellation;
+        const uint systemCount = regionCount * systemsPerRegion;
+
+        const uint firstRegionId = 10000001;
+        const uint firstConstellationId = 20000001;
+        const uint firstSystemId = 30000001;
+        const quint64 firstStationId = 60000001;
+        const quint64 firstCitadelId = 1000000000001;
+
+        const uint veldsparGroupId = 462;
+        const EveType::IdType veldsparId = 1230;
+        const EveType::IdType tritaniumId = 34;
+        const EveType::IdType blueprintId = 681;
+
+        const double securityStatus = 0.9;
+        const double tritaniumVolume = 0.01;
+        const double firstSellPrice = 100.;
+        const double firstBuyPrice = 50.;
+
+        // one connection per thread, like the real providers
+        class TestConnectionProvider final
+            : public DatabaseConnectionProvider
+        {
+        public:
+            explicit TestConnectionProvider(QString path)
+                : mPath{std::move(path)}
+            {
+            }
+
+            virtual ~TestConnectionProvider() = default;
+
+            virtual QSqlDatabase getConnection() const override
+            {
+                std::ostringstream tid;
+                tid << std::this_thread::get_id();
+
+                const auto connName = QStringLiteral("stress-%1").arg(QString::fromStdString(tid.str()));
+
+                auto db = QSqlDatabase::database(connName, false);
+                if (!db.isValid())
+                {
+                    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+                    db.setConnectOptions(QStringLiteral("QSQLITE_BUSY_TIMEOUT=10000000"));
+                    db.setDatabaseName(mPath);
+
+                    if (!db.open())
+                        throw std::runtime_error{"Error opening DB!"};
+                }
+
+                return db;
+            }
+
+        private:
+            QString mPath;
+        };
+
+        class NullDataManagerProvider final
+            : public EveDataManagerProvider
+        {
+        public:
+            NullDataManagerProvider() = default;
+            virtual ~NullDataManagerProvider() = default;
+
+            virtual const ESIManager &getESIManager() const override
+            {
+                // only generic names go to ESI, and they aren't used here
+                throw std::logic_error{"No ESI in the stress test!"};
+            }
+        };
+
+        void exec(const QSqlDatabase &db, const QString &sql)
+        {
+            QSqlQuery query{db};
+            query.prepare(sql);
+
+            DatabaseUtils::execQuery(query);
+        }
+
+        void createStaticData(QSqlDatabase db, const CitadelRepository &citadelRepo)
+        {
+            exec(db, QStringLiteral("CREATE TABLE ramActivities (activityID INTEGER PRIMARY KEY, activityName TEXT)"));
+            exec(db, QStringLiteral("CREATE TABLE mapRegions (regionID INTEGER PRIMARY KEY, regionName TEXT)"));
+            exec(db, QStringLiteral("CREATE TABLE mapConstellations (constellationID INTEGER PRIMARY KEY, constellationName TEXT, regionID INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE mapSolarSystems (solarSystemID INTEGER PRIMARY KEY, solarSystemName TEXT, constellationID INTEGER, regionID INTEGER, security REAL)"));
+            exec(db, QStringLiteral("CREATE TABLE mapSolarSystemJumps (fromRegionID INTEGER, fromSolarSystemID INTEGER, toSolarSystemID INTEGER, toRegionID INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE staStations (stationID INTEGER PRIMARY KEY, stationName TEXT, solarSystemID INTEGER, regionID INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE mapDenormalize (itemID INTEGER PRIMARY KEY, itemName TEXT, solarSystemID INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE invGroups (groupID INTEGER PRIMARY KEY, groupName TEXT)"));
+            exec(db, QStringLiteral("CREATE TABLE invTypes (typeID INTEGER PRIMARY KEY, typeName TEXT, groupID INTEGER, portionSize INTEGER, published INTEGER, marketGroupID INTEGER, volume REAL)"));
+            exec(db, QStringLiteral("CREATE TABLE invMetaTypes (typeID INTEGER PRIMARY KEY, metaGroupID INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE invMetaGroups (metaGroupID INTEGER PRIMARY KEY, metaGroupName TEXT)"));
+            exec(db, QStringLiteral("CREATE TABLE invMarketGroups (marketGroupID INTEGER PRIMARY KEY, parentGroupID INTEGER, marketGroupName TEXT)"));
+            exec(db, QStringLiteral("CREATE TABLE invTypeMaterials (typeID INTEGER, materialTypeID INTEGER, quantity INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE industryActivity (typeID INTEGER, activityID INTEGER, time INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE industryActivityMaterials (typeID INTEGER, activityID INTEGER, materialTypeID INTEGER, quantity INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE industryActivityProducts (typeID INTEGER, activityID INTEGER, productTypeID INTEGER, quantity INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE industryActivitySkills (typeID INTEGER, activityID INTEGER, skillID INTEGER, level INTEGER)"));
+
+            citadelRepo.create();
+
+            db.transaction();
+
+            exec(db, QStringLiteral("INSERT INTO ramActivities VALUES (1, 'Manufacturing')"));
+            exec(db, QStringLiteral("INSERT INTO invGroups VALUES (%1, 'Veldspar')").arg(veldsparGroupId));
+            exec(db, QStringLiteral("INSERT INTO invTypes VALUES (%1, 'Veldspar', %2, 100, 1, 518, 0.1)").arg(veldsparId).arg(veldsparGroupId));
+            exec(db, QStringLiteral("INSERT INTO invTypes VALUES (%1, 'Tritanium', 18, 1, 1, 1857, %2)").arg(tritaniumId).arg(tritaniumVolume));
+            exec(db, QStringLiteral("INSERT INTO invMetaGroups VALUES (1, 'Tech I')"));
+            exec(db, QStringLiteral("INSERT INTO invMetaTypes VALUES (%1, 1)").arg(tritaniumId));
+            exec(db, QStringLiteral("INSERT INTO invMarketGroups VALUES (54, NULL, 'Ore')"));
+            exec(db, QStringLiteral("INSERT INTO invMarketGroups VALUES (518, 54, 'Veldspar')"));
+            exec(db, QStringLiteral("INSERT INTO invMarketGroups VALUES (1857, NULL, 'Minerals')"));
+            exec(db, QStringLiteral("INSERT INTO invTypeMaterials VALUES (%1, %2, 415)").arg(veldsparId).arg(tritaniumId));
+            exec(db, QStringLiteral("INSERT INTO industryActivity VALUES (%1, 1, 600)").arg(blueprintId));
+            exec(db, QStringLiteral("INSERT INTO industryActivityMaterials VALUES (%1, 1, %2, 10)").arg(blueprintId).arg(veldsparId));
+            exec(db, QStringLiteral("INSERT INTO industryActivityProducts VALUES (%1, 1, %2, 1)").arg(blueprintId).arg(tritaniumId));
+            exec(db, QStringLiteral("INSERT INTO industryActivitySkills VALUES (%1, 1, 3380, 1)").arg(blueprintId));
+
+            for (auto region = 0u; region < regionCount; ++region)
+            {
+                const auto regionId = firstRegionId + region;
+                exec(db, QStringLiteral("INSERT INTO mapRegions VALUES (%1, 'Region %1')").arg(regionId));
+
+                for (auto constellation = 0u; constellation < constellationsPerRegion; ++constellation)
+                {
+                    const auto constellationId = firstConstellationId + region * constellationsPerRegion + constellation;
+                    exec(db, QStringLiteral("INSERT INTO mapConstellations VALUES (%1, 'Constellation %1', %2)").arg(constellationId).arg(regionId));
+
+                    for (auto system = 0u; system < systemsPerConstellation; ++system)
+                    {
+                        const auto index = (region * constellationsPerRegion + constellation) * systemsPerConstellation + system;
+                        const auto systemId = firstSystemId + index;
+
+                        exec(db, QStringLiteral("INSERT INTO mapSolarSystems VALUES (%1, 'System %1', %2, %3, %4)")
+                            .arg(systemId).arg(constellationId).arg(regionId).arg(securityStatus));
+
+                        // all systems form a single line, crossing into the next region at its ends
+                        if (index + 1 < systemCount)
+                        {
+                            const auto nextRegionId = firstRegionId + (index + 1) / systemsPerRegion;
+
+                            exec(db, QStringLiteral("INSERT INTO mapSolarSystemJumps VALUES (%1, %2, %3, %4)")
+                                .arg(regionId).arg(systemId).arg(systemId + 1).arg(nextRegionId));
+                            exec(db, QStringLiteral("INSERT INTO mapSolarSystemJumps VALUES (%1, %2, %3, %4)")
+                                .arg(nextRegionId).arg(systemId + 1).arg(systemId).arg(regionId));
+                        }
+
+                        for (auto station = 0u; station < stationsPerSystem; ++station)
+                        {
+                            exec(db, QStringLiteral("INSERT INTO staStations VALUES (%1, 'Station %1', %2, %3)")
+                                .arg(firstStationId + index * stationsPerSystem + station).arg(systemId).arg(regionId));
+                        }
+
+                        Citadel citadel{firstCitadelId + index};
+                        citadel.setName(QStringLiteral("Citadel %1").arg(citadel.getId()));
+                        citadel.setSolarSystemId(systemId);
+                        citadel.setRegionId(regionId);
+                        citadel.setFirstSeen(QDateTime::currentDateTimeUtc());
+                        citadel.setLastSeen(QDateTime::currentDateTimeUtc());
+
+                        citadelRepo.store(citadel);
+                    }
+                }
+            }
+
+            db.commit();
+        }
+
+        // one sell and one station range buy order in the first station of every system, prices growing along the line
+        void createOrders(QSqlDatabase db, const ExternalOrderRepository &externalOrderRepo)
+        {
+            exec(db, QStringLiteral("CREATE TABLE market_orders (id INTEGER PRIMARY KEY, state INTEGER)"));
+            exec(db, QStringLiteral("CREATE TABLE corp_market_orders (id INTEGER PRIMARY KEY, state INTEGER)"));
+
+            externalOrderRepo.create();
+
+            const auto now = QDateTime::currentDateTimeUtc();
+
+            std::vector<ExternalOrder> orders;
+            for (auto index = 0u; index < systemCount; ++index)
+            {
+                for (const auto type : { ExternalOrder::Type::Sell, ExternalOrder::Type::Buy })
+                {
+                    ExternalOrder order{orders.size() + 1};
+                    order.setType(type);
+                    order.setTypeId(tritaniumId);
+                    order.setStationId(firstStationId + index * stationsPerSystem);
+                    order.setSolarSystemId(firstSystemId + index);
+                    order.setRegionId(firstRegionId + index / systemsPerRegion);
+                    order.setRange(ExternalOrder::rangeStation);
+                    order.setUpdateTime(now);
+                    order.setPrice(((type == ExternalOrder::Type::Sell) ? (firstSellPrice) : (firstBuyPrice)) + index);
+                    order.setVolumeEntered(1000);
+                    order.setVolumeRemaining(1000);
+                    order.setIssued(now);
+                    order.setDuration(90);
+
+                    orders.emplace_back(std::move(order));
+                }
+            }
+
+            externalOrderRepo.batchStore(orders, true);
+        }
+
+        uint getJumps(uint fromIndex, uint toIndex) noexcept
+        {
+            return (fromIndex > toIndex) ? (fromIndex - toIndex) : (toIndex - fromIndex);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    using namespace Evernus;
+
+    QCoreApplication app{argc, argv};
+    QCoreApplication::setApplicationName(QStringLiteral("EvernusStressTest"));
+    QStandardPaths::setTestModeEnabled(true);
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        qCritical() << "Cannot create temporary directory.";
+        return EXIT_FAILURE;
+    }
+
+    TestConnectionProvider connectionProvider{dir.filePath(QStringLiteral("stress.db"))};
+    NullDataManagerProvider dataManagerProvider;
+
+    const EveTypeRepository eveTypeRepo{connectionProvider};
+    const MetaGroupRepository metaGroupRepo{connectionProvider};
+    const ExternalOrderRepository externalOrderRepo{connectionProvider};
+    const MarketOrderRepository marketOrderRepo{false, connectionProvider};
+    const MarketOrderRepository corpMarketOrderRepo{true, connectionProvider};
+    const MarketGroupRepository marketGroupRepo{connectionProvider};
+    const CitadelRepository citadelRepo{connectionProvider};
+
+    createStaticData(connectionProvider.getConnection(), citadelRepo);
+    createOrders(connectionProvider.getConnection(), externalOrderRepo);
+
+    // the pack fingerprint doesn't cover the test db, so don't pick up one from a previous run
+    const auto staticDataPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+                                QStringLiteral("/data/") +
+                                CachingEveDataProvider::staticDataCacheFileName;
+    QFile::remove(staticDataPath);
+
+    CachingEveDataProvider dataProvider{eveTypeRepo,
+                                        metaGroupRepo,
+                                        externalOrderRepo,
+                                        marketOrderRepo,
+                                        corpMarketOrderRepo,
+                                        marketGroupRepo,
+                                        citadelRepo,
+                                        dataManagerProvider,
+                                        connectionProvider};
+
+    dataProvider.precacheStaticData();
+    dataProvider.precacheJumpMap();
+
+    // the pack is only written when it compiled without errors
+    if (!QFile::exists(staticDataPath))
+    {
+        qCritical() << "Static data pack was not built.";
+        return EXIT_FAILURE;
+    }
+
+    const auto threadCount = std::max(8u, std::thread::hardware_concurrency());
+    const auto iterations = 2000u;
+
+    std::atomic_uint failures{0};
+
+    const auto check = [&](bool condition, const char *what) {
+        if (Q_UNLIKELY(!condition))
+        {
+            qCritical() << "Check failed:" << what;
+            ++failures;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (auto thread = 0u; thread < threadCount; ++thread)
+    {
+        workers.emplace_back([&, thread] {
+            try
+            {
+                for (auto i = 0u; i < iterations; ++i)
+                {
+                    // threads walk the data in different orders, so they race on filling the same entries
+                    const auto index = (i * (thread + 1) * 7919u) % systemCount;
+                    const auto constellation = index / systemsPerConstellation;
+                    const auto region = constellation / constellationsPerRegion;
+
+                    const auto regionId = firstRegionId + region;
+                    const auto systemId = firstSystemId + index;
+                    const auto stationId = firstStationId + index * stationsPerSystem;
+
+                    const auto regionIndex = region * systemsPerRegion + (index * 31 + thread) % systemsPerRegion;
+                    const auto otherRegionIndex = (index + systemsPerRegion) % systemCount;
+                    const auto routeIndex = (index * 13 + thread) % systemCount;
+
+                    check(dataProvider.getRegions().size() == regionCount, "regions");
+                    check(dataProvider.getConstellations(regionId).size() == constellationsPerRegion, "region constellations");
+                    check(dataProvider.getSolarSystemsForConstellation(firstConstellationId + constellation).size() == systemsPerConstellation, "constellation systems");
+                    check(dataProvider.getSolarSystemsForRegion(regionId).size() == constellationsPerRegion * systemsPerConstellation, "region systems");
+                    check(dataProvider.getStations(systemId).size() == stationsPerSystem + 1, "stations");
+
+                    check(dataProvider.getStationSolarSystemId(firstStationId + index * stationsPerSystem) == systemId, "station system");
+                    check(dataProvider.getStationSolarSystemId(firstCitadelId + index) == systemId, "citadel system");
+                    check(dataProvider.getCitadelsForRegion(regionId).size() == constellationsPerRegion * systemsPerConstellation, "region citadels");
+
+                    check(dataProvider.getGroupId(QStringLiteral("Veldspar")) == veldsparGroupId, "group id");
+                    check(dataProvider.getOreReprocessingInfo().size() == 1, "ore reprocessing");
+                    check(dataProvider.getTypeManufacturingInfo(tritaniumId).mMaterials.size() == 1, "manufacturing");
+                    check(dataProvider.getAllTradeableTypeNames().size() == 2, "tradeable types");
+                    check(dataProvider.getTypeMetaGroupName(tritaniumId) == QStringLiteral("Tech I"), "meta group");
+                    check(qFuzzyCompare(dataProvider.getTypeVolume(tritaniumId), tritaniumVolume), "type volume");
+                    check(qFuzzyCompare(dataProvider.getSolarSystemSecurityStatus(systemId), securityStatus), "security status");
+
+                    check(dataProvider.getDistance(systemId, firstSystemId + regionIndex) == getJumps(index, regionIndex), "region distance");
+                    check(dataProvider.getDistance(systemId, firstSystemId + otherRegionIndex) == JumpDistanceMatrix::unreachable, "cross region distance");
+                    check(dataProvider.getRouteLength(systemId, firstSystemId + routeIndex) == getJumps(index, routeIndex), "route length");
+                    check(dataProvider.getRoute(systemId, firstSystemId + routeIndex, RouteType::Safer).size() == getJumps(index, routeIndex) + 1, "route");
+
+                    check(dataProvider.getTypeStationSellPrice(tritaniumId, stationId)->getPrice() == firstSellPrice + index, "station sell price");
+                    check(dataProvider.getTypeRegionSellPrice(tritaniumId, regionId)->getPrice() == firstSellPrice + region * systemsPerRegion, "region sell price");
+                    check(dataProvider.getTypeBuyPrice(tritaniumId, stationId)->getPrice() == firstBuyPrice + index, "buy price");
+
+                    // prices must stay the same while the book is reloaded underneath
+                    if (thread == 0 && i % 250 == 0)
+                        dataProvider.reloadOrderBook();
+                    else if (thread == 1 && i % 250 == 125)
+                        dataProvider.clearExternalOrderCaches();
+
+                    if (i % 100 == thread % 100)
+                    {
+                        check(dataProvider.getConstellations().size() == regionCount * constellationsPerRegion, "all constellations");
+                        check(dataProvider.getSolarSystems().size() == systemCount, "all systems");
+                        check(dataProvider.getCitadels().size() == systemCount, "all citadels");
+                        check(dataProvider.getTypeReprocessingInfo({ veldsparId }).size() == 1, "type reprocessing");
+                    }
+                }
+            }
+            catch (const std::exception &e)
+            {
+                qCritical() << "Worker failed:" << e.what();
+                ++failures;
+            }
+        });
+    }
+
+    for (auto &worker : workers)
+        worker.join();
+
+    if (failures > 0)
+    {
+        qCritical() << failures << "failures.";
+        return EXIT_FAILURE;
+    }
+
+    qInfo() << "Done:" << threadCount << "threads," << iterations << "iterations each.";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,318 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <atomic>
+#include <vector>
+
+#include <QRegularExpression>
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QSqlDatabase>
+#include <QtConcurrent>
+#include <QJsonArray>
+#include <QSqlQuery>
+#include <QtDebug>
+#include <QUrl>
+
+#include "DatabaseConnectionProvider.h"
+#include "CachingEveDataProvider.h"
+#include "EveDataManagerProvider.h"
+#include "ExternalOrderJsonParser.h"
+#include "MarketOrderRepository.h"
+#include "ESIFixtureStore.h"
+#include "DatabaseUtils.h"
+#include "ESIManager.h"
+
+// compares ExternalOrderJsonParser with decoding a QJsonDocument, on a market order page recorded as an ESI fixture
+// usage: ExternalOrderJsonParserBenchmark <fixture dir> <page url> [runs]
+// e.g. ExternalOrderJsonParserBenchmark fixtures "https://esi.evetech.net/v1/markets/10000002/orders/?page=1"
+
+namespace Evernus
+{
+    namespace
+    {
+        const auto chunkSize = 16 * 1024;
+
+        // orders in ESI pages come with their solar systems, so the data provider only needs to exist
+        class BenchmarkConnectionProvider final
+            : public DatabaseConnectionProvider
+        {
+        public:
+            explicit BenchmarkConnectionProvider(QString path)
+                : mPath{std::move(path)}
+            {
+            }
+
+            virtual ~BenchmarkConnectionProvider() = default;
+
+            virtual QSqlDatabase getConnection() const override
+            {
+                const auto connName = QStringLiteral("benchmark");
+
+                auto db = QSqlDatabase::database(connName, false);
+                if (!db.isValid())
+                {
+                    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+                    db.setDatabaseName(mPath);
+
+                    if (!db.open())
+                        throw std::runtime_error{"Error opening DB!"};
+                }
+
+                return db;
+            }
+
+        private:
+            QString mPath;
+        };
+
+        class NullDataManagerProvider final
+            : public EveDataManagerProvider
+        {
+        public:
+            NullDataManagerProvider() = default;
+            virtual ~NullDataManagerProvider() = default;
+
+            virtual const ESIManager &getESIManager() const override
+            {
+                throw std::logic_error{"No ESI in the benchmark!"};
+            }
+        };
+
+        template<class Func>
+        qint64 measure(uint runs, std::vector<ExternalOrder> &orders, Func &&func)
+        {
+            std::vector<qint64> times;
+            for (auto run = 0u; run < runs; ++run)
+            {
+                QElapsedTimer timer;
+                timer.start();
+
+                orders = func();
+
+                times.emplace_back(timer.nsecsElapsed());
+            }
+
+            std::sort(std::begin(times), std::end(times));
+            return times[times.size() / 2];
+        }
+
+        // empty if both decoded the same orders, in the same order
+        QString findMismatch(const std::vector<ExternalOrder> &expected, const std::vector<ExternalOrder> &actual)
+        {
+            if (expected.size() != actual.size())
+                return QStringLiteral("order count %1 != %2").arg(actual.size()).arg(expected.size());
+
+            for (auto i = 0u; i < expected.size(); ++i)
+            {
+                const auto &a = actual[i];
+                const auto &e = expected[i];
+
+                const auto field = [&]() -> const char * {
+                    if (a.getId() != e.getId())
+                        return "id";
+                    if (a.getType() != e.getType())
+                        return "type";
+                    if (a.getTypeId() != e.getTypeId())
+                        return "typeId";
+                    if (a.getStationId() != e.getStationId())
+                        return "stationId";
+                    if (a.getSolarSystemId() != e.getSolarSystemId())
+                        return "solarSystemId";
+                    if (a.getRange() != e.getRange())
+                        return "range";
+                    if (a.getPrice() != e.getPrice())
+                        return "price";
+                    if (a.getVolumeEntered() != e.getVolumeEntered())
+                        return "volumeEntered";
+                    if (a.getVolumeRemaining() != e.getVolumeRemaining())
+                        return "volumeRemaining";
+                    if (a.getMinVolume() != e.getMinVolume())
+                        return "minVolume";
+                    if (a.getIssued() != e.getIssued())
+                        return "issued";
+                    if (a.getDuration() != e.getDuration())
+                        return "duration";
+
+                    return nullptr;
+                }();
+
+                if (field != nullptr)
+                    return QStringLiteral("order %1 (id %2) differs in %3").arg(i).arg(e.getId()).arg(QLatin1String{field});
+            }
+
+            return QString{};
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    using namespace Evernus;
+
+    QCoreApplication app{argc, argv};
+    QCoreApplication::setApplicationName(QStringLiteral("EvernusBenchmark"));
+    QStandardPaths::setTestModeEnabled(true);
+
+    const auto arguments = app.arguments();
+    if (arguments.size() < 3)
+    {
+        qCritical() << "Usage: ExternalOrderJsonParserBenchmark <fixture dir> <page url> [runs]";
+        return EXIT_FAILURE;
+    }
+
+    const QUrl url{arguments[2]};
+    const auto runs = (arguments.size() > 3) ? (arguments[3].toUInt()) : (20u);
+
+    const auto regionMatch = QRegularExpression{QStringLiteral("/markets/(\\d+)/orders/")}.match(url.path());
+    if (!regionMatch.hasMatch() || runs == 0)
+    {
+        qCritical() << "Not a market order page url:" << url;
+        return EXIT_FAILURE;
+    }
+
+    const auto regionId = regionMatch.captured(1).toUInt();
+
+    ESIFixtureStore::Fixture fixture;
+    if (!ESIFixtureStore{arguments[1]}.find(url, fixture))
+    {
+        qCritical() << "No fixture recorded for:" << url;
+        return EXIT_FAILURE;
+    }
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        qCritical() << "Cannot create temporary directory.";
+        return EXIT_FAILURE;
+    }
+
+    BenchmarkConnectionProvider connectionProvider{dir.filePath(QStringLiteral("benchmark.db"))};
+    NullDataManagerProvider dataManagerProvider;
+
+    QSqlQuery query{connectionProvider.getConnection()};
+    query.prepare(QStringLiteral("CREATE TABLE ramActivities (activityID INTEGER PRIMARY KEY, activityName TEXT)"));
+
+    DatabaseUtils::execQuery(query);
+
+    const EveTypeRepository eveTypeRepo{connectionProvider};
+    const MetaGroupRepository metaGroupRepo{connectionProvider};
+    const ExternalOrderRepository externalOrderRepo{connectionProvider};
+    const MarketOrderRepository marketOrderRepo{false, connectionProvider};
+    const MarketOrderRepository corpMarketOrderRepo{true, connectionProvider};
+    const MarketGroupRepository marketGroupRepo{connectionProvider};
+    const CitadelRepository citadelRepo{connectionProvider};
+
+    const CachingEveDataProvider dataProvider{eveTypeRepo,
+                                              metaGroupRepo,
+                                              externalOrderRepo,
+                                              marketOrderRepo,
+                                              corpMarketOrderRepo,
+                                              marketGroupRepo,
+                                              citadelRepo,
+                                              dataManagerProvider,
+                                              connectionProvider};
+
+    const auto &data = fixture.mData;
+    const auto updateTime = QDateTime::currentDateTimeUtc();
+
+    qInfo() << "Page:" << url << data.size() << "bytes";
+
+    std::vector<ExternalOrder> documentOrders, parallelDocumentOrders, parserOrders, chunkedParserOrders;
+
+    const auto document = measure(runs, documentOrders, [&] {
+        const auto items = QJsonDocument::fromJson(data).array();
+
+        std::vector<ExternalOrder> orders;
+        orders.reserve(items.size());
+
+        for (const auto &item : items)
+            orders.emplace_back(ESIManager::getExternalOrderFromJson(item.toObject(), regionId, updateTime, dataProvider));
+
+        return orders;
+    });
+
+    // what ESIManager did for whole pages
+    const auto parallelDocument = measure(runs, parallelDocumentOrders, [&] {
+        const auto items = QJsonDocument::fromJson(data).array();
+
+        std::vector<ExternalOrder> orders(items.size());
+        std::atomic_size_t nextIndex{0};
+
+        QtConcurrent::blockingMap(items, [&](const auto &item) {
+            orders[nextIndex++] = ESIManager::getExternalOrderFromJson(item.toObject(), regionId, updateTime, dataProvider);
+        });
+
+        return orders;
+    });
+
+    const auto parser = measure(runs, parserOrders, [&] {
+        ExternalOrderJsonParser decoder{dataProvider, regionId, updateTime};
+        decoder.feed(data);
+
+        const auto error = decoder.finish();
+        if (!error.isEmpty())
+            throw std::runtime_error{error.toStdString()};
+
+        return decoder.takeOrders();
+    });
+
+    // as it arrives from the network
+    const auto chunkedParser = measure(runs, chunkedParserOrders, [&] {
+        ExternalOrderJsonParser decoder{dataProvider, regionId, updateTime};
+        for (auto offset = 0; offset < data.size(); offset += chunkSize)
+            decoder.feed(data.mid(offset, chunkSize));
+
+        const auto error = decoder.finish();
+        if (!error.isEmpty())
+            throw std::runtime_error{error.toStdString()};
+
+        return decoder.takeOrders();
+    });
+
+    // blockingMap doesn't keep the order, so only the count can be compared
+    if (documentOrders.size() != parallelDocumentOrders.size())
+    {
+        qCritical() << "Order counts differ:" << documentOrders.size() << parallelDocumentOrders.size();
+        return EXIT_FAILURE;
+    }
+
+    const auto parserMismatch = findMismatch(documentOrders, parserOrders);
+    if (!parserMismatch.isEmpty())
+    {
+        qCritical() << "ExternalOrderJsonParser:" << parserMismatch;
+        return EXIT_FAILURE;
+    }
+
+    const auto chunkedParserMismatch = findMismatch(documentOrders, chunkedParserOrders);
+    if (!chunkedParserMismatch.isEmpty())
+    {
+        qCritical() << "Chunked ExternalOrderJsonParser:" << chunkedParserMismatch;
+        return EXIT_FAILURE;
+    }
+
+    qInfo() << "Orders:" << documentOrders.size() << "runs:" << runs;
+    qInfo() << "QJsonDocument:" << document / 1000 << "us";
+    qInfo() << "QJsonDocument + blockingMap:" << parallelDocument / 1000 << "us";
+    qInfo() << "ExternalOrderJsonParser:" << parser / 1000 << "us";
+    qInfo() << "ExternalOrderJsonParser," << chunkSize / 1024 << "KiB chunks:" << chunkedParser / 1000 << "us";
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QSqlQuery>
+#include <QtDebug>
+
+#include "DatabaseConnectionProvider.h"
+#include "ExternalOrderRepository.h"
+#include "TypeLocationPairs.h"
+#include "DatabaseUtils.h"
+
+// compares ExternalOrderRepository::removeObsolete() with the OR-chained deletes it replaced
+// usage: ExternalOrderRepositoryBenchmark [rows] [runs]
+
+namespace Evernus
+{
+    namespace
+    {
+        const uint regionCount = 5;
+        const uint ordersPerPair = 10;
+        // every n-th type/region pair is removed, like after importing a part of the market
+        const uint removedPairStep = 10;
+
+        class BenchmarkConnectionProvider final
+            : public DatabaseConnectionProvider
+        {
+        public:
+            explicit BenchmarkConnectionProvider(QString path)
+                : mPath{std::move(path)}
+            {
+            }
+
+            virtual ~BenchmarkConnectionProvider() = default;
+
+            virtual QSqlDatabase getConnection() const override
+            {
+                const auto connName = QStringLiteral("benchmark");
+
+                auto db = QSqlDatabase::database(connName, false);
+                if (!db.isValid())
+                {
+                    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+                    db.setDatabaseName(mPath);
+
+                    if (!db.open())
+                        throw std::runtime_error{"Error opening DB!"};
+
+                    db.exec(QStringLiteral("PRAGMA synchronous = 0"));
+                }
+
+                return db;
+            }
+
+        private:
+            QString mPath;
+        };
+
+        void exec(const QSqlDatabase &db, const QString &sql)
+        {
+            QSqlQuery query{db};
+            query.prepare(sql);
+
+            DatabaseUtils::execQuery(query);
+        }
+
+        uint count(const QSqlDatabase &db, const QString &table)
+        {
+            QSqlQuery query{db};
+            query.prepare(QStringLiteral("SELECT COUNT(*) FROM %1").arg(table));
+
+            DatabaseUtils::execQuery(query);
+            return (query.next()) ? (query.value(0).toUInt()) : (0u);
+        }
+
+        // removeObsolete() as it was: batches of OR-ed (type_id, region_id) terms, each a separate index probe
+        void removeObsoleteWithOrChains(QSqlDatabase db, const QString &table, const TypeLocationPairs &set)
+        {
+            db.transaction();
+
+            const auto baseQuery = QStringLiteral("DELETE FROM %1 WHERE %2").arg(table);
+            const auto baseWhere = QStringLiteral("(type_id = ? AND region_id = ?)");
+
+            const auto batchSize = 300;
+            const auto batches = set.size() / batchSize;
+
+            auto it = std::begin(set);
+
+            QStringList batchWhere;
+            for (auto i = 0; i < batchSize; ++i)
+                batchWhere << baseWhere;
+
+            const auto batchQuery = baseQuery.arg(batchWhere.join(QStringLiteral(" OR ")));
+
+            for (auto i = 0u; i < batches; ++i)
+            {
+                QSqlQuery query{db};
+                query.prepare(batchQuery);
+
+                for (auto j = 0; j < batchSize; ++j)
+                {
+                    query.addBindValue(it->first);
+                    query.addBindValue(it->second);
+
+                    ++it;
+                }
+
+                DatabaseUtils::execQuery(query);
+            }
+
+            const auto reminder = set.size() % batchSize;
+            if (reminder > 0)
+            {
+                QStringList reminderWhere;
+                for (auto i = 0u; i < reminder; ++i)
+                    reminderWhere << baseWhere;
+
+                QSqlQuery query{db};
+                query.prepare(baseQuery.arg(reminderWhere.join(QStringLiteral(" OR "))));
+
+                for (auto i = 0u; i < reminder; ++i)
+                {
+                    query.addBindValue(it->first);
+                    query.addBindValue(it->second);
+
+                    ++it;
+                }
+
+                DatabaseUtils::execQuery(query);
+            }
+
+            db.commit();
+        }
+
+        template<class Func>
+        qint64 measure(const QSqlDatabase &db, const QString &table, uint expectedRows, Func &&func)
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            func();
+
+            const auto elapsed = timer.elapsed();
+
+            if (count(db, table) != expectedRows)
+                throw std::runtime_error{"Unexpected number of rows left!"};
+
+            // put the removed rows back for the next run
+            exec(db, QStringLiteral("INSERT INTO %1 SELECT * FROM removed_orders").arg(table));
+
+            return elapsed;
+        }
+
+        qint64 median(std::vector<qint64> times)
+        {
+            std::sort(std::begin(times), std::end(times));
+            return times[times.size() / 2];
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    using namespace Evernus;
+
+    QCoreApplication app{argc, argv};
+
+    const auto arguments = app.arguments();
+    const auto rows = (arguments.size() > 1) ? (arguments[1].toUInt()) : (1000000u);
+    const auto runs = (arguments.size() > 2) ? (arguments[2].toUInt()) : (5u);
+
+    if (rows < ordersPerPair * regionCount || runs == 0)
+    {
+        qCritical() << "Usage: ExternalOrderRepositoryBenchmark [rows] [runs]";
+        return EXIT_FAILURE;
+    }
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        qCritical() << "Cannot create temporary directory.";
+        return EXIT_FAILURE;
+    }
+
+    BenchmarkConnectionProvider connectionProvider{dir.filePath(QStringLiteral("benchmark.db"))};
+    const ExternalOrderRepository repo{connectionProvider};
+
+    const auto db = connectionProvider.getConnection();
+    const auto table = repo.getTableName();
+
+    repo.create();
+
+    qInfo() << "Filling" << rows << "rows...";
+
+    // consecutive rows share a type/region pair; pairs spread over regions, then types
+    exec(db, QStringLiteral(R"(
+WITH RECURSIVE n(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM n WHERE i + 1 < %2)
+INSERT INTO %1 SELECT
+    i + 1, i % 2, (i / %3) / %4 + 1, 60003760, 30000142, 10000001 + (i / %3) % %4, 0,
+    datetime('now'), 100.0, 10, 10, 1, datetime('now'), 90
+FROM n
+    )").arg(table).arg(rows).arg(ordersPerPair).arg(regionCount));
+
+    TypeLocationPairs obsolete;
+
+    const auto pairs = (rows + ordersPerPair - 1) / ordersPerPair;
+    for (auto pair = 0u; pair < pairs; pair += removedPairStep)
+        obsolete.emplace(pair / regionCount + 1, 10000001 + pair % regionCount);
+
+    exec(db, QStringLiteral("CREATE TABLE removed_orders AS SELECT * FROM %1 WHERE ((id - 1) / %2) % %3 = 0")
+        .arg(table).arg(ordersPerPair).arg(removedPairStep));
+
+    const auto expectedRows = rows - count(db, QStringLiteral("removed_orders"));
+
+    qInfo() << "Removing" << obsolete.size() << "type/region pairs," << (rows - expectedRows) << "rows.";
+
+    std::vector<qint64> orChainTimes, tempTableTimes;
+    for (auto run = 0u; run < runs; ++run)
+    {
+        orChainTimes.emplace_back(measure(db, table, expectedRows, [&] {
+            removeObsoleteWithOrChains(db, table, obsolete);
+        }));
+        tempTableTimes.emplace_back(measure(db, table, expectedRows, [&] {
+            repo.removeObsolete(obsolete);
+        }));
+    }
+
+    qInfo() << "OR chains (old):" << median(orChainTimes) << "ms";
+    qInfo() << "Temp table (new):" << median(tempTableTimes) << "ms";
+
+    return EXIT_SUCCESS;
+}